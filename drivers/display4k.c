@@ -4,12 +4,132 @@
 #include "fonts.h"
 
 // Consistent framebuffer declaration
-'extern' uint32_t *framebuffer;
+extern uint32_t *framebuffer;
+
+static const clip_rect_t screen_clip = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+// Clip window applied by the unclipped public drawing calls
+static clip_rect_t active_clip = { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT };
+
+// Cohen-Sutherland outcodes
+#define OUT_LEFT   0x1
+#define OUT_RIGHT  0x2
+#define OUT_TOP    0x4
+#define OUT_BOTTOM 0x8
+
+static inline int iabs(int v) {
+    return v < 0 ? -v : v;
+}
+
+// Integer square root (floor), used for circle and corner extents
+static int isqrt(int n) {
+    if (n <= 0) return 0;
+
+    int root = 0;
+    int bit = 1 << 30;
+    while (bit > n) bit >>= 2;
+
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Fill the horizontal span [x0, x1) on row y, clipped to the window
+static void fill_span(const clip_rect_t *clip, int x0, int x1, int y, uint32_t color) {
+    if (y < clip->y0 || y >= clip->y1) return;
+    if (x0 < clip->x0) x0 = clip->x0;
+    if (x1 > clip->x1) x1 = clip->x1;
+    if (x0 >= x1) return;
+
+    memset32(&framebuffer[y * SCREEN_WIDTH + x0], color, x1 - x0);
+}
+
+// Fill the vertical run [y0, y1) on column x, clipped to the window
+static void fill_column(const clip_rect_t *clip, int x, int y0, int y1, uint32_t color) {
+    if (x < clip->x0 || x >= clip->x1) return;
+    if (y0 < clip->y0) y0 = clip->y0;
+    if (y1 > clip->y1) y1 = clip->y1;
+
+    uint32_t *dst = &framebuffer[y0 * SCREEN_WIDTH + x];
+    for (int y = y0; y < y1; y++) {
+        *dst = color;
+        dst += SCREEN_WIDTH;
+    }
+}
+
+static int compute_outcode(const clip_rect_t *clip, int x, int y) {
+    int code = 0;
+    if (x < clip->x0) code |= OUT_LEFT;
+    else if (x >= clip->x1) code |= OUT_RIGHT;
+    if (y < clip->y0) code |= OUT_TOP;
+    else if (y >= clip->y1) code |= OUT_BOTTOM;
+    return code;
+}
+
+// Cohen-Sutherland line clipping; returns 0 when the line is fully outside
+static int clip_line(const clip_rect_t *clip, int *x1, int *y1, int *x2, int *y2) {
+    int code1 = compute_outcode(clip, *x1, *y1);
+    int code2 = compute_outcode(clip, *x2, *y2);
+
+    while (1) {
+        if (!(code1 | code2)) return 1;   // Both endpoints inside
+        if (code1 & code2) return 0;      // Both on the same outside side
+
+        int code = code1 ? code1 : code2;
+        int64_t dx = *x2 - *x1;
+        int64_t dy = *y2 - *y1;
+        int x, y;
+
+        if (code & OUT_BOTTOM) {
+            y = clip->y1 - 1;
+            x = *x1 + (int)(dx * (y - *y1) / dy);
+        } else if (code & OUT_TOP) {
+            y = clip->y0;
+            x = *x1 + (int)(dx * (y - *y1) / dy);
+        } else if (code & OUT_RIGHT) {
+            x = clip->x1 - 1;
+            y = *y1 + (int)(dy * (x - *x1) / dx);
+        } else {
+            x = clip->x0;
+            y = *y1 + (int)(dy * (x - *x1) / dx);
+        }
+
+        if (code == code1) {
+            *x1 = x; *y1 = y;
+            code1 = compute_outcode(clip, x, y);
+        } else {
+            *x2 = x; *y2 = y;
+            code2 = compute_outcode(clip, x, y);
+        }
+    }
+}
+
+// Pre-expanded glyph rows: one 8-word write mask per possible font row byte
+static uint32_t glyph_row_masks[256][FONT_GLYPH_WIDTH];
+static int glyph_atlas_ready = 0;
+
+// Build the row mask table used by the text blitter
+static void init_glyph_atlas(void) {
+    for (int bits = 0; bits < 256; bits++) {
+        for (int col = 0; col < FONT_GLYPH_WIDTH; col++) {
+            glyph_row_masks[bits][col] = (bits & (0x80 >> col)) ? 0xFFFFFFFF : 0;
+        }
+    }
+    glyph_atlas_ready = 1;
+}
 
 // Initialize display system
 void init_display4k() {
     // In real implementation, this would initialize display hardware
     // For now, assume framebuffer is allocated elsewhere
+    init_glyph_atlas();
     if (framebuffer) {
         clear_screen(0x000000); // Clear to black
     }
@@ -20,6 +140,34 @@ void set_framebuffer(uint32_t *fb) {
     framebuffer = fb;
 }
 
+// Restrict subsequent drawing to a rectangle (intersected with the screen)
+void set_clip_rect(int x, int y, int width, int height) {
+    clip_rect_t clip = { x, y, x + width, y + height };
+    intersect_clip_rect(&clip, &screen_clip);
+    active_clip = clip;
+}
+
+// Restore drawing to the full screen
+void reset_clip_rect(void) {
+    active_clip = screen_clip;
+}
+
+// Current clip window for drawing code outside this driver
+const clip_rect_t *get_clip_rect(void) {
+    return &active_clip;
+}
+
+// Intersect dst with src in place; returns 0 when the result is empty
+int intersect_clip_rect(clip_rect_t *dst, const clip_rect_t *src) {
+    if (dst->x0 < src->x0) dst->x0 = src->x0;
+    if (dst->y0 < src->y0) dst->y0 = src->y0;
+    if (dst->x1 > src->x1) dst->x1 = src->x1;
+    if (dst->y1 > src->y1) dst->y1 = src->y1;
+    if (dst->x1 < dst->x0) dst->x1 = dst->x0;
+    if (dst->y1 < dst->y0) dst->y1 = dst->y0;
+    return dst->x0 < dst->x1 && dst->y0 < dst->y1;
+}
+
 // Check if pixel coordinates are valid
 int is_pixel_valid(int x, int y) {
     return (x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT);
@@ -27,7 +175,8 @@ int is_pixel_valid(int x, int y) {
 
 // Draw single pixel with bounds checking
 void draw_pixel(int x, int y, uint32_t color) {
-    if (framebuffer && is_pixel_valid(x, y)) {
+    if (framebuffer && x >= active_clip.x0 && x < active_clip.x1 &&
+        y >= active_clip.y0 && y < active_clip.y1) {
         framebuffer[y * SCREEN_WIDTH + x] = color;
     }
 }
@@ -37,42 +186,90 @@ void plot_pixel(int x, int y, uint32_t color) {
     draw_pixel(x, y, color);
 }
 
-// Draw character using bitmap font
+// Blend one glyph row into dst; branch-free so the loop vectorizes to masked stores
+static inline void blit_glyph_row(uint32_t *dst, const uint32_t *mask, uint32_t color,
+                                  int col0, int col1) {
+    for (int col = col0; col < col1; col++) {
+        dst[col] = (dst[col] & ~mask[col]) | (color & mask[col]);
+    }
+}
+
+// Draw character using the pre-expanded glyph atlas
 void draw_char(int x, int y, char ch, uint32_t color) {
-    if (!framebuffer || ch < 32 || ch > 127) {
+    draw_char_clipped(&active_clip, x, y, ch, color);
+}
+
+void draw_char_clipped(const clip_rect_t *clip, int x, int y, char ch, uint32_t color) {
+    unsigned char c = (unsigned char)ch;
+    if (!framebuffer || c < 32 || c > 127) {
         return; // Invalid character or no framebuffer
     }
     
-    unsigned char *glyph = font8x10[ch - 32];
+    // Reject glyphs entirely outside the clip window
+    if (x + FONT_GLYPH_WIDTH <= clip->x0 || x >= clip->x1 ||
+        y + FONT_GLYPH_HEIGHT <= clip->y0 || y >= clip->y1) {
+        return;
+    }
+    if (!glyph_atlas_ready) {
+        init_glyph_atlas();
+    }
+    
+    const unsigned char *glyph = font8x10[c - 32];
     
-    for (int row = 0; row < 10; row++) {
+    // Clip the glyph box once instead of testing every pixel
+    int col0 = x < clip->x0 ? clip->x0 - x : 0;
+    int col1 = x + FONT_GLYPH_WIDTH > clip->x1 ? clip->x1 - x : FONT_GLYPH_WIDTH;
+    int row0 = y < clip->y0 ? clip->y0 - y : 0;
+    int row1 = y + FONT_GLYPH_HEIGHT > clip->y1 ? clip->y1 - y : FONT_GLYPH_HEIGHT;
+    
+    uint32_t *dst = &framebuffer[(y + row0) * SCREEN_WIDTH + x];
+    for (int row = row0; row < row1; row++, dst += SCREEN_WIDTH) {
         unsigned char row_data = glyph[row];
-        for (int col = 0; col < 8; col++) {
-            if (row_data & (0x80 >> col)) {
-                draw_pixel(x + col, y + row, color);
-            }
+        if (!row_data) continue; // Blank rows are common below the baseline
+        
+        if (col0 == 0 && col1 == FONT_GLYPH_WIDTH) {
+            blit_glyph_row(dst, glyph_row_masks[row_data], color, 0, FONT_GLYPH_WIDTH);
+        } else {
+            blit_glyph_row(dst, glyph_row_masks[row_data], color, col0, col1);
         }
     }
 }
 
+// Raw 8x10 bitmap for a printable character, or NULL
+const unsigned char *get_font_glyph(char ch) {
+    unsigned char c = (unsigned char)ch;
+    if (c < 32 || c > 127) return NULL;
+    return font8x10[c - 32];
+}
+
 // Draw string with newline support
 void draw_string(int x, int y, const char *str, uint32_t color) {
+    draw_string_clipped(&active_clip, x, y, str, color);
+}
+
+void draw_string_clipped(const clip_rect_t *clip, int x, int y, const char *str, uint32_t color) {
     if (!str) return;
     
     int cursor_x = x;
     int cursor_y = y;
     
     while (*str) {
-        if (*str == '\n') {
-            cursor_y += 12;  // Move to next line
-            cursor_x = x;    // Reset to start of line
-        } else if (*str == '\r') {
+        unsigned char c = (unsigned char)*str;
+        if (c == '\n') {
+            cursor_y += FONT_LINE_HEIGHT;  // Move to next line
+            cursor_x = x;                  // Reset to start of line
+            if (cursor_y >= clip->y1) break; // Remaining lines are below the clip window
+        } else if (c == '\r') {
             cursor_x = x;    // Carriage return
-        } else if (*str == '\t') {
+        } else if (c == '\t') {
             cursor_x = ((cursor_x - x) / 32 + 1) * 32 + x; // Tab to next 32-pixel boundary
-        } else if (*str >= 32 && *str <= 127) {
-            draw_char(cursor_x, cursor_y, *str, color);
-            cursor_x += 9;   // Move to next character position
+        } else if (c >= 32 && c <= 127) {
+            // Only rasterize glyphs on visible rows and columns
+            if (cursor_y + FONT_GLYPH_HEIGHT > clip->y0 && cursor_x < clip->x1 &&
+                cursor_x + FONT_GLYPH_WIDTH > clip->x0) {
+                draw_char_clipped(clip, cursor_x, cursor_y, (char)c, color);
+            }
+            cursor_x += FONT_CHAR_ADVANCE;   // Move to next character position
         }
         str++;
     }
@@ -87,64 +284,298 @@ void clear_screen(uint32_t color) {
         memset(framebuffer, 0, SCREEN_WIDTH * SCREEN_HEIGHT * sizeof(uint32_t));
     } else {
         // Fill with specified color
-        uint32_t *fb = framebuffer;
-        for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
-            *fb++ = color;
-        }
+        memset32(framebuffer, color, SCREEN_WIDTH * SCREEN_HEIGHT);
     }
 }
 
 // Draw rectangle outline
 void draw_rect(int x, int y, int width, int height, uint32_t color) {
-    if (width <= 0 || height <= 0) return;
+    draw_rect_clipped(&active_clip, x, y, width, height, color);
+}
+
+void draw_rect_clipped(const clip_rect_t *clip, int x, int y, int width, int height, uint32_t color) {
+    if (!framebuffer || width <= 0 || height <= 0) return;
     
     // Top and bottom edges
-    for (int i = 0; i < width; i++) {
-        draw_pixel(x + i, y, color);                    // Top edge
-        draw_pixel(x + i, y + height - 1, color);       // Bottom edge
-    }
+    fill_span(clip, x, x + width, y, color);
+    fill_span(clip, x, x + width, y + height - 1, color);
     
-    // Left and right edges
-    for (int i = 0; i < height; i++) {
-        draw_pixel(x, y + i, color);                    // Left edge
-        draw_pixel(x + width - 1, y + i, color);        // Right edge
-    }
+    // Left and right edges (corners already covered by the spans)
+    fill_column(clip, x, y + 1, y + height - 1, color);
+    fill_column(clip, x + width - 1, y + 1, y + height - 1, color);
 }
 
 // Draw filled rectangle
 void draw_filled_rect(int x, int y, int width, int height, uint32_t color) {
-    if (width <= 0 || height <= 0) return;
+    draw_filled_rect_clipped(&active_clip, x, y, width, height, color);
+}
+
+void draw_filled_rect_clipped(const clip_rect_t *clip, int x, int y, int width, int height, uint32_t color) {
+    if (!framebuffer || width <= 0 || height <= 0) return;
+    
+    int y0 = y < clip->y0 ? clip->y0 : y;
+    int y1 = y + height > clip->y1 ? clip->y1 : y + height;
     
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            draw_pixel(x + j, y + i, color);
+    for (int row = y0; row < y1; row++) {
+        fill_span(clip, x, x + width, row, color);
+    }
+}
+
+// Copy a block of the framebuffer to (dst_x, dst_y), clipped to the active clip.
+// Rows are walked away from the overlap so no source row is overwritten early.
+void blit_rect(int src_x, int src_y, int width, int height, int dst_x, int dst_y) {
+    if (!framebuffer || width <= 0 || height <= 0) return;
+
+    int dx = dst_x - src_x;
+    int dy = dst_y - src_y;
+
+    // Destination must lie in the clip, source must lie on screen
+    clip_rect_t dst = { dst_x, dst_y, dst_x + width, dst_y + height };
+    clip_rect_t src_on_dst = { dx, dy, SCREEN_WIDTH + dx, SCREEN_HEIGHT + dy };
+    if (!intersect_clip_rect(&dst, &active_clip)) return;
+    if (!intersect_clip_rect(&dst, &src_on_dst)) return;
+
+    int count = dst.x1 - dst.x0;
+    if (dy > 0) {
+        for (int row = dst.y1 - 1; row >= dst.y0; row--) {
+            memmove32(&framebuffer[row * SCREEN_WIDTH + dst.x0],
+                      &framebuffer[(row - dy) * SCREEN_WIDTH + dst.x0 - dx], count);
         }
+    } else {
+        for (int row = dst.y0; row < dst.y1; row++) {
+            memmove32(&framebuffer[row * SCREEN_WIDTH + dst.x0],
+                      &framebuffer[(row - dy) * SCREEN_WIDTH + dst.x0 - dx], count);
+        }
+    }
+}
+
+// Move the contents of region by (dx, dy). Pixels shifted out are lost; the
+// strips left uncovered are returned in exposed[] for the caller to repaint.
+// Returns the number of exposed rects (0-2).
+int scroll_region(const clip_rect_t *region, int dx, int dy, clip_rect_t exposed[2]) {
+    clip_rect_t r = *region;
+    int count = 0;
+
+    if (!intersect_clip_rect(&r, &active_clip)) return 0;
+
+    int w = r.x1 - r.x0;
+    int h = r.y1 - r.y0;
+
+    // Scrolled entirely out: everything is exposed
+    if (iabs(dx) >= w || iabs(dy) >= h) {
+        exposed[0] = r;
+        return 1;
+    }
+
+    clip_rect_t saved = active_clip;
+    active_clip = r;
+    blit_rect(r.x0, r.y0, w, h, r.x0 + dx, r.y0 + dy);
+    active_clip = saved;
+
+    if (dy != 0) {
+        exposed[count] = r;
+        if (dy > 0) exposed[count].y1 = r.y0 + dy;
+        else exposed[count].y0 = r.y1 + dy;
+        count++;
+    }
+    if (dx != 0) {
+        exposed[count] = r;
+        if (dx > 0) exposed[count].x1 = r.x0 + dx;
+        else exposed[count].x0 = r.x1 + dx;
+        // Don't report the corner twice
+        if (dy > 0) exposed[count].y0 = r.y0 + dy;
+        else if (dy < 0) exposed[count].y1 = r.y1 + dy;
+        count++;
+    }
+    return count;
+}
+
+// Copy an opaque image already in framebuffer format (row stride = width)
+void draw_image(int x, int y, int width, int height, const uint32_t *pixels) {
+    draw_image_clipped(&active_clip, x, y, width, height, pixels);
+}
+
+void draw_image_clipped(const clip_rect_t *clip, int x, int y, int width, int height,
+                        const uint32_t *pixels) {
+    if (!framebuffer || !pixels || width <= 0 || height <= 0) return;
+
+    clip_rect_t r = { x, y, x + width, y + height };
+    if (!intersect_clip_rect(&r, clip)) return;
+
+    for (int row = r.y0; row < r.y1; row++) {
+        memmove32(&framebuffer[row * SCREEN_WIDTH + r.x0],
+                  &pixels[(row - y) * width + (r.x0 - x)], r.x1 - r.x0);
     }
 }
 
-// Draw line using Bresenham's algorithm
+// Copy a rect of an off-screen, screen-sized buffer (e.g. a cached wallpaper)
+void copy_from_buffer(const uint32_t *src, const clip_rect_t *rect) {
+    if (!framebuffer || !src) return;
+
+    clip_rect_t r = *rect;
+    if (!intersect_clip_rect(&r, &screen_clip)) return;
+
+    for (int row = r.y0; row < r.y1; row++) {
+        memmove32(&framebuffer[row * SCREEN_WIDTH + r.x0], &src[row * SCREEN_WIDTH + r.x0], r.x1 - r.x0);
+    }
+}
+
+// Draw line using Bresenham's algorithm, pre-clipped with Cohen-Sutherland
 void draw_line(int x1, int y1, int x2, int y2, uint32_t color) {
-    int dx = abs(x2 - x1);
-    int dy = abs(y2 - y1);
+    draw_line_clipped(&active_clip, x1, y1, x2, y2, color);
+}
+
+void draw_line_clipped(const clip_rect_t *clip, int x1, int y1, int x2, int y2, uint32_t color) {
+    if (!framebuffer) return;
+    if (!clip_line(clip, &x1, &y1, &x2, &y2)) return;
+    
+    // Axis-aligned lines become spans
+    if (y1 == y2) {
+        fill_span(clip, x1 < x2 ? x1 : x2, (x1 < x2 ? x2 : x1) + 1, y1, color);
+        return;
+    }
+    if (x1 == x2) {
+        fill_column(clip, x1, y1 < y2 ? y1 : y2, (y1 < y2 ? y2 : y1) + 1, color);
+        return;
+    }
+    
+    int dx = iabs(x2 - x1);
+    int dy = iabs(y2 - y1);
     int sx = (x1 < x2) ? 1 : -1;
-    int sy = (y1 < y2) ? 1 : -1;
+    int sy = (y1 < y2) ? SCREEN_WIDTH : -SCREEN_WIDTH;
     int err = dx - dy;
     
-    int x = x1, y = y1;
+    // Endpoints are inside the clip window, so every step stays on screen
+    uint32_t *dst = &framebuffer[y1 * SCREEN_WIDTH + x1];
+    int steps = dx > dy ? dx : dy;
     
-    while (1) {
-        draw_pixel(x, y, color);
-        
-        if (x == x2 && y == y2) break;
+    for (int i = 0; i <= steps; i++) {
+        *dst = color;
         
         int e2 = 2 * err;
         if (e2 > -dy) {
             err -= dy;
-            x += sx;
+            dst += sx;
         }
         if (e2 < dx) {
             err += dx;
-            y += sy;
+            dst += sy;
+        }
+    }
+}
+
+// Draw filled circle as horizontal spans (midpoint algorithm)
+void draw_circle(int cx, int cy, int radius, uint32_t color) {
+    draw_circle_clipped(&active_clip, cx, cy, radius, color);
+}
+
+void draw_circle_clipped(const clip_rect_t *clip, int cx, int cy, int radius, uint32_t color) {
+    if (!framebuffer || radius < 0) return;
+    
+    // Trivially reject circles entirely outside the clip window
+    if (cx + radius < clip->x0 || cx - radius >= clip->x1 ||
+        cy + radius < clip->y0 || cy - radius >= clip->y1) {
+        return;
+    }
+    
+    int x = radius;
+    int y = 0;
+    int d = 1 - radius;
+    
+    while (y <= x) {
+        fill_span(clip, cx - x, cx + x + 1, cy + y, color);
+        if (y != 0) {
+            fill_span(clip, cx - x, cx + x + 1, cy - y, color);
+        }
+        
+        if (d < 0) {
+            d += 2 * y + 3;
+        } else {
+            // Rows cy +/- x are final once x is about to shrink
+            if (x != y) {
+                fill_span(clip, cx - y, cx + y + 1, cy + x, color);
+                fill_span(clip, cx - y, cx + y + 1, cy - x, color);
+            }
+            d += 2 * (y - x) + 5;
+            x--;
+        }
+        y++;
+    }
+}
+
+// Draw circle border (single pixel width) using Bresenham's circle algorithm
+void draw_circle_border(int cx, int cy, int radius, uint32_t color) {
+    if (!framebuffer || radius < 0) return;
+    
+    // Reject circles outside the clip window; skip per-pixel checks when fully inside
+    const clip_rect_t *clip = &active_clip;
+    if (cx + radius < clip->x0 || cx - radius >= clip->x1 ||
+        cy + radius < clip->y0 || cy - radius >= clip->y1) {
+        return;
+    }
+    int inside = (cx - radius >= clip->x0 && cx + radius < clip->x1 &&
+                  cy - radius >= clip->y0 && cy + radius < clip->y1);
+    
+    int x = 0;
+    int y = radius;
+    int d = 3 - 2 * radius;
+    
+    while (y >= x) {
+        int px[8] = { cx + x, cx - x, cx + x, cx - x, cx + y, cx - y, cx + y, cx - y };
+        int py[8] = { cy + y, cy + y, cy - y, cy - y, cy + x, cy + x, cy - x, cy - x };
+        
+        for (int i = 0; i < 8; i++) {
+            if (inside || (px[i] >= clip->x0 && px[i] < clip->x1 &&
+                           py[i] >= clip->y0 && py[i] < clip->y1)) {
+                framebuffer[py[i] * SCREEN_WIDTH + px[i]] = color;
+            }
         }
+        
+        x++;
+        if (d > 0) {
+            y--;
+            d = d + 4 * (x - y) + 10;
+        } else {
+            d = d + 4 * x + 6;
+        }
+    }
+}
+
+// Draw filled rectangle with rounded corners as horizontal spans
+void draw_rounded_rect(int x, int y, int width, int height, int radius, uint32_t color) {
+    draw_rounded_rect_clipped(&active_clip, x, y, width, height, radius, color);
+}
+
+void draw_rounded_rect_clipped(const clip_rect_t *clip, int x, int y, int width, int height,
+                               int radius, uint32_t color) {
+    if (!framebuffer || width <= 0 || height <= 0) return;
+    
+    if (radius > width / 2) radius = width / 2;
+    if (radius > height / 2) radius = height / 2;
+    if (radius <= 0) {
+        draw_filled_rect_clipped(clip, x, y, width, height, color);
+        return;
+    }
+    
+    // Reject rectangles entirely outside the clip window
+    if (x + width <= clip->x0 || x >= clip->x1 || y + height <= clip->y0 || y >= clip->y1) {
+        return;
     }
-}
\ No newline at end of file
+    
+    // Corner rows: inset computed from the pixel-center distance to the arc
+    for (int i = 0; i < radius; i++) {
+        int dy2 = 2 * (radius - i) - 1;
+        int half = isqrt(4 * radius * radius - dy2 * dy2) / 2;
+        int inset = radius - half;
+        
+        fill_span(clip, x + inset, x + width - inset, y + i, color);
+        fill_span(clip, x + inset, x + width - inset, y + height - 1 - i, color);
+    }
+    
+    // Straight middle section
+    int y0 = y + radius < clip->y0 ? clip->y0 : y + radius;
+    int y1 = y + height - radius > clip->y1 ? clip->y1 : y + height - radius;
+    for (int row = y0; row < y1; row++) {
+        fill_span(clip, x, x + width, row, color);
+    }
+}
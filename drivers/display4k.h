@@ -6,9 +6,62 @@
 #define SCREEN_WIDTH 3840
 #define SCREEN_HEIGHT 2160
 
+// Bitmap font metrics (font8x10)
+#define FONT_GLYPH_WIDTH  8
+#define FONT_GLYPH_HEIGHT 10
+#define FONT_CHAR_ADVANCE 9
+#define FONT_LINE_HEIGHT  12
+
 // Consistent framebuffer declaration
 extern uint32_t *framebuffer;
 
+// Clip window (x1/y1 exclusive)
+typedef struct {
+    int x0, y0;
+    int x1, y1;
+} clip_rect_t;
+
+// Fill count 32-bit words with value (rep stosl on x86)
+static inline void memset32(uint32_t *dst, uint32_t value, int count) {
+    if (count <= 0) return;
+#if defined(__i386__) || defined(__x86_64__)
+    __asm__ volatile ("rep stosl"
+                      : "+D"(dst), "+c"(count)
+                      : "a"(value)
+                      : "memory");
+#else
+    while (count--) *dst++ = value;
+#endif
+}
+
+// Copy count 32-bit words; safe for overlapping ranges (rep movsl, backwards if needed)
+static inline void memmove32(uint32_t *dst, const uint32_t *src, int count) {
+    if (count <= 0 || dst == src) return;
+#if defined(__i386__) || defined(__x86_64__)
+    if (dst < src || dst >= src + count) {
+        __asm__ volatile ("rep movsl"
+                          : "+D"(dst), "+S"(src), "+c"(count)
+                          :
+                          : "memory");
+    } else {
+        dst += count - 1;
+        src += count - 1;
+        __asm__ volatile ("std\n\trep movsl\n\tcld"
+                          : "+D"(dst), "+S"(src), "+c"(count)
+                          :
+                          : "memory");
+    }
+#else
+    if (dst < src) {
+        while (count--) *dst++ = *src++;
+    } else {
+        dst += count;
+        src += count;
+        while (count--) *--dst = *--src;
+    }
+#endif
+}
+
 // Core display functions
 void init_display4k();
 void clear_screen(uint32_t color);
@@ -18,11 +71,41 @@ void plot_pixel(int x, int y, uint32_t color); // Alias for consistency
 // Text rendering functions
 void draw_char(int x, int y, char ch, uint32_t color);
 void draw_string(int x, int y, const char *str, uint32_t color);
+const unsigned char *get_font_glyph(char ch);
 
 // Shape drawing functions
 void draw_rect(int x, int y, int width, int height, uint32_t color);
 void draw_filled_rect(int x, int y, int width, int height, uint32_t color);
 void draw_line(int x1, int y1, int x2, int y2, uint32_t color);
+void draw_circle(int cx, int cy, int radius, uint32_t color);
+void draw_circle_border(int cx, int cy, int radius, uint32_t color);
+void draw_rounded_rect(int x, int y, int width, int height, int radius, uint32_t color);
+void draw_image(int x, int y, int width, int height, const uint32_t *pixels);
+
+// Clipped variants for callers that render into sub-regions (display lists, tiles)
+void draw_char_clipped(const clip_rect_t *clip, int x, int y, char ch, uint32_t color);
+void draw_string_clipped(const clip_rect_t *clip, int x, int y, const char *str, uint32_t color);
+void draw_rect_clipped(const clip_rect_t *clip, int x, int y, int width, int height, uint32_t color);
+void draw_filled_rect_clipped(const clip_rect_t *clip, int x, int y, int width, int height, uint32_t color);
+void draw_line_clipped(const clip_rect_t *clip, int x1, int y1, int x2, int y2, uint32_t color);
+void draw_circle_clipped(const clip_rect_t *clip, int cx, int cy, int radius, uint32_t color);
+void draw_rounded_rect_clipped(const clip_rect_t *clip, int x, int y, int width, int height,
+                               int radius, uint32_t color);
+void draw_image_clipped(const clip_rect_t *clip, int x, int y, int width, int height,
+                        const uint32_t *pixels);
+
+// Framebuffer-to-framebuffer copies; source and destination may overlap
+void blit_rect(int src_x, int src_y, int width, int height, int dst_x, int dst_y);
+int scroll_region(const clip_rect_t *region, int dx, int dy, clip_rect_t exposed[2]);
+
+// Copy rect from a screen-sized buffer in framebuffer format (same coordinates)
+void copy_from_buffer(const uint32_t *src, const clip_rect_t *rect);
+
+// Clip window for the unclipped drawing calls
+void set_clip_rect(int x, int y, int width, int height);
+void reset_clip_rect(void);
+const clip_rect_t *get_clip_rect(void);
+int intersect_clip_rect(clip_rect_t *dst, const clip_rect_t *src);
 
 // Utility functions
 int is_pixel_valid(int x, int y);
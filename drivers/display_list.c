@@ -0,0 +1,496 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "display_list.h"
+#include "font_render.h"
+#include "tile_raster.h"
+
+static const clip_rect_t empty_rect = { 0, 0, 0, 0 };
+
+static inline bool rect_empty(const clip_rect_t *r) {
+    return r->x0 >= r->x1 || r->y0 >= r->y1;
+}
+
+static void rect_union(clip_rect_t *dst, const clip_rect_t *src) {
+    if (rect_empty(src)) return;
+    if (rect_empty(dst)) {
+        *dst = *src;
+        return;
+    }
+    if (src->x0 < dst->x0) dst->x0 = src->x0;
+    if (src->y0 < dst->y0) dst->y0 = src->y0;
+    if (src->x1 > dst->x1) dst->x1 = src->x1;
+    if (src->y1 > dst->y1) dst->y1 = src->y1;
+}
+
+static inline bool rect_overlaps(const clip_rect_t *a, const clip_rect_t *b) {
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+static inline int rect_area(const clip_rect_t *r) {
+    return (r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+// Merge into a rect it overlaps or, once the set is full, into the rect
+// whose bounding box grows the least
+void dl_damage_add(dl_damage_t *d, const clip_rect_t *r) {
+    if (rect_empty(r)) return;
+
+    for (int i = 0; i < d->count; i++) {
+        if (rect_overlaps(&d->rects[i], r)) {
+            rect_union(&d->rects[i], r);
+            return;
+        }
+    }
+    if (d->count < DL_MAX_DAMAGE_RECTS) {
+        d->rects[d->count++] = *r;
+        return;
+    }
+
+    int best = 0;
+    int best_growth = 0;
+    for (int i = 0; i < d->count; i++) {
+        clip_rect_t merged = d->rects[i];
+        rect_union(&merged, r);
+        int growth = rect_area(&merged) - rect_area(&d->rects[i]);
+        if (i == 0 || growth < best_growth) {
+            best = i;
+            best_growth = growth;
+        }
+    }
+    rect_union(&d->rects[best], r);
+}
+
+static inline dl_frame_t *current_frame(display_list_t *dl) {
+    return &dl->frames[dl->current];
+}
+
+static inline const dl_frame_t *previous_frame(const display_list_t *dl) {
+    return &dl->frames[dl->current ^ 1];
+}
+
+// Append a command; bounds are filled in by the caller
+static dl_cmd_t *push_cmd(display_list_t *dl, dl_cmd_type_t type, uint32_t color) {
+    dl_frame_t *frame = current_frame(dl);
+    if (!dl->recording) return NULL;
+    if (frame->count >= DL_MAX_COMMANDS) {
+        dl->overflow = true;
+        return NULL;
+    }
+
+    dl_cmd_t *cmd = &frame->cmds[frame->count++];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = (uint8_t)type;
+    cmd->layer = dl->layer;
+    cmd->color = color;
+    return cmd;
+}
+
+static void set_box(dl_cmd_t *cmd, int x, int y, int width, int height) {
+    cmd->x = (int16_t)x;
+    cmd->y = (int16_t)y;
+    cmd->w = (int16_t)width;
+    cmd->h = (int16_t)height;
+    cmd->bounds.x0 = x;
+    cmd->bounds.y0 = y;
+    cmd->bounds.x1 = x + width;
+    cmd->bounds.y1 = y + height;
+}
+
+// Two commands draw identical pixels
+static bool cmd_equal(const dl_cmd_t *a, const char *a_text, const dl_cmd_t *b, const char *b_text) {
+    if (a->type != b->type || a->layer != b->layer || a->color != b->color ||
+        a->x != b->x || a->y != b->y || a->w != b->w || a->h != b->h ||
+        a->radius != b->radius || a->text_len != b->text_len || a->image != b->image) {
+        return false;
+    }
+    if (a->type == DL_CMD_TEXT) {
+        return memcmp(a_text + a->text_offset, b_text + b->text_offset, a->text_len) == 0;
+    }
+    return true;
+}
+
+// Stable insertion sort by (layer, type) so replay batches primitives of one kind
+static void sort_commands(dl_frame_t *frame) {
+    for (int i = 1; i < frame->count; i++) {
+        dl_cmd_t cmd = frame->cmds[i];
+        int key = (cmd.layer << 8) | cmd.type;
+        int j = i;
+        while (j > 0 && ((frame->cmds[j - 1].layer << 8) | frame->cmds[j - 1].type) > key) {
+            frame->cmds[j] = frame->cmds[j - 1];
+            j--;
+        }
+        frame->cmds[j] = cmd;
+    }
+}
+
+// Draw one command, clipped
+static void replay_cmd(const dl_frame_t *frame, const dl_cmd_t *cmd, const clip_rect_t *clip) {
+    switch (cmd->type) {
+        case DL_CMD_FILLED_RECT:
+            draw_filled_rect_clipped(clip, cmd->x, cmd->y, cmd->w, cmd->h, cmd->color);
+            break;
+        case DL_CMD_ROUNDED_RECT:
+            draw_rounded_rect_clipped(clip, cmd->x, cmd->y, cmd->w, cmd->h, cmd->radius, cmd->color);
+            break;
+        case DL_CMD_CIRCLE:
+            draw_circle_clipped(clip, cmd->x, cmd->y, cmd->radius, cmd->color);
+            break;
+        case DL_CMD_RECT:
+            draw_rect_clipped(clip, cmd->x, cmd->y, cmd->w, cmd->h, cmd->color);
+            break;
+        case DL_CMD_LINE:
+            draw_line_clipped(clip, cmd->x, cmd->y, cmd->w, cmd->h, cmd->color);
+            break;
+        case DL_CMD_IMAGE:
+            draw_image_clipped(clip, cmd->x, cmd->y, cmd->w, cmd->h, cmd->image);
+            break;
+        case DL_CMD_TEXT:
+            draw_string_clipped(clip, cmd->x, cmd->y, frame->text + cmd->text_offset, cmd->color);
+            break;
+    }
+}
+
+// Replay one frame into a clip window, skipping commands outside it
+static void replay_frame(const dl_frame_t *frame, const clip_rect_t *clip) {
+    for (int i = 0; i < frame->count; i++) {
+        const dl_cmd_t *cmd = &frame->cmds[i];
+        if (rect_overlaps(&cmd->bounds, clip)) {
+            replay_cmd(frame, cmd, clip);
+        }
+    }
+}
+
+void dl_init(display_list_t *dl, uint32_t background) {
+    memset(dl, 0, sizeof(*dl));
+    dl->background = background;
+    dl->bounds.x1 = SCREEN_WIDTH;
+    dl->bounds.y1 = SCREEN_HEIGHT;
+}
+
+void dl_set_bounds(display_list_t *dl, int x, int y, int width, int height) {
+    dl->bounds.x0 = x;
+    dl->bounds.y0 = y;
+    dl->bounds.x1 = x + width;
+    dl->bounds.y1 = y + height;
+}
+
+void dl_invalidate_region(display_list_t *dl, const dl_damage_t *damage) {
+    // Without a trusted screen the next submit repaints everything anyway
+    if (!dl->valid) return;
+
+    for (int i = 0; i < damage->count; i++) {
+        clip_rect_t r = damage->rects[i];
+        if (intersect_clip_rect(&r, &dl->bounds)) {
+            dl_damage_add(&dl->pending_damage, &r);
+        }
+    }
+}
+
+// Erase through a cached image (wallpaper) instead of a flat color.
+// Changing it invalidates the list, since every erased pixel would differ.
+void dl_set_background_image(display_list_t *dl, const uint32_t *pixels) {
+    if (dl->background_image != pixels) {
+        dl->background_image = pixels;
+        dl->valid = false;
+    }
+}
+
+void dl_erase(const display_list_t *dl, const clip_rect_t *clip) {
+    if (dl->background_image) {
+        copy_from_buffer(dl->background_image, clip);
+    } else {
+        draw_filled_rect_clipped(clip, clip->x0, clip->y0,
+                                 clip->x1 - clip->x0, clip->y1 - clip->y0, dl->background);
+    }
+}
+
+void dl_begin(display_list_t *dl) {
+    // A frame that was recorded but never submitted is not what is on screen
+    if (dl->pending) {
+        dl->valid = false;
+    }
+
+    // Record into the other buffer; the old one becomes "previous"
+    dl->current ^= 1;
+    dl_frame_t *frame = current_frame(dl);
+    frame->count = 0;
+    frame->text_used = 0;
+    dl->layer = 0;
+    dl->overflow = false;
+    dl->recording = true;
+}
+
+void dl_set_layer(display_list_t *dl, uint8_t layer) {
+    dl->layer = layer;
+}
+
+void dl_filled_rect(display_list_t *dl, int x, int y, int width, int height, uint32_t color) {
+    if (width <= 0 || height <= 0) return;
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_FILLED_RECT, color);
+    if (cmd) set_box(cmd, x, y, width, height);
+}
+
+void dl_rounded_rect(display_list_t *dl, int x, int y, int width, int height, int radius, uint32_t color) {
+    if (width <= 0 || height <= 0) return;
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_ROUNDED_RECT, color);
+    if (!cmd) return;
+    set_box(cmd, x, y, width, height);
+    cmd->radius = (int16_t)radius;
+}
+
+void dl_circle(display_list_t *dl, int cx, int cy, int radius, uint32_t color) {
+    if (radius < 0) return;
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_CIRCLE, color);
+    if (!cmd) return;
+    set_box(cmd, cx - radius, cy - radius, 2 * radius + 1, 2 * radius + 1);
+    cmd->x = (int16_t)cx;
+    cmd->y = (int16_t)cy;
+    cmd->w = cmd->h = 0;
+    cmd->radius = (int16_t)radius;
+}
+
+void dl_rect(display_list_t *dl, int x, int y, int width, int height, uint32_t color) {
+    if (width <= 0 || height <= 0) return;
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_RECT, color);
+    if (cmd) set_box(cmd, x, y, width, height);
+}
+
+void dl_line(display_list_t *dl, int x1, int y1, int x2, int y2, uint32_t color) {
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_LINE, color);
+    if (!cmd) return;
+    cmd->x = (int16_t)x1;
+    cmd->y = (int16_t)y1;
+    cmd->w = (int16_t)x2;
+    cmd->h = (int16_t)y2;
+    cmd->bounds.x0 = x1 < x2 ? x1 : x2;
+    cmd->bounds.y0 = y1 < y2 ? y1 : y2;
+    cmd->bounds.x1 = (x1 < x2 ? x2 : x1) + 1;
+    cmd->bounds.y1 = (y1 < y2 ? y2 : y1) + 1;
+}
+
+void dl_text(display_list_t *dl, int x, int y, const char *str, uint32_t color) {
+    if (!str || !*str) return;
+
+    dl_frame_t *frame = current_frame(dl);
+    size_t len = strlen(str);
+    if (frame->text_used + len + 1 > DL_TEXT_ARENA) {
+        dl->overflow = true;
+        return;
+    }
+
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_TEXT, color);
+    if (!cmd) return;
+
+    int width, height;
+    measure_string(str, 1, &width, &height);
+    set_box(cmd, x, y, width, height);
+    cmd->w = cmd->h = 0;
+    cmd->text_offset = frame->text_used;
+    cmd->text_len = (uint16_t)len;
+    memcpy(frame->text + frame->text_used, str, len + 1);
+    frame->text_used += (uint16_t)(len + 1);
+}
+
+// The pixels are referenced, not copied: they must stay valid until the
+// list is re-recorded, and `stamp` must change whenever they do
+void dl_image(display_list_t *dl, int x, int y, int width, int height,
+              const uint32_t *pixels, uint32_t stamp) {
+    if (!pixels || width <= 0 || height <= 0) return;
+    dl_cmd_t *cmd = push_cmd(dl, DL_CMD_IMAGE, stamp);
+    if (!cmd) return;
+    set_box(cmd, x, y, width, height);
+    cmd->image = pixels;
+}
+
+void dl_end(display_list_t *dl) {
+    dl->recording = false;
+    dl->pending = true;
+    sort_commands(current_frame(dl));
+}
+
+// Index of the first command in frame[from, from + DL_DIFF_LOOKAHEAD) equal to cmd, or -1
+static int find_equal(const dl_frame_t *frame, int from, const dl_cmd_t *cmd, const char *text) {
+    int end = from + DL_DIFF_LOOKAHEAD;
+    if (end > frame->count) end = frame->count;
+    for (int k = from; k < end; k++) {
+        if (cmd_equal(&frame->cmds[k], frame->text, cmd, text)) return k;
+    }
+    return -1;
+}
+
+// Damage = bounds of commands that appeared, vanished or changed since the last frame.
+// Walks both frames in paint order and resynchronizes after inserted or removed
+// commands, so a list that gained or lost a row only damages that row.
+static void compute_damage(const display_list_t *dl, dl_damage_t *damage) {
+    const dl_frame_t *cur = &dl->frames[dl->current];
+    const dl_frame_t *prev = previous_frame(dl);
+    int i = 0, j = 0;
+
+    while (i < cur->count && j < prev->count) {
+        if (cmd_equal(&cur->cmds[i], cur->text, &prev->cmds[j], prev->text)) {
+            i++;
+            j++;
+            continue;
+        }
+
+        int removed = find_equal(prev, j + 1, &cur->cmds[i], cur->text);
+        int inserted = find_equal(cur, i + 1, &prev->cmds[j], prev->text);
+
+        if (removed >= 0 && (inserted < 0 || removed - j <= inserted - i)) {
+            while (j < removed) dl_damage_add(damage, &prev->cmds[j++].bounds);
+        } else if (inserted >= 0) {
+            while (i < inserted) dl_damage_add(damage, &cur->cmds[i++].bounds);
+        } else {
+            dl_damage_add(damage, &cur->cmds[i++].bounds);
+            dl_damage_add(damage, &prev->cmds[j++].bounds);
+        }
+    }
+    while (i < cur->count) dl_damage_add(damage, &cur->cmds[i++].bounds);
+    while (j < prev->count) dl_damage_add(damage, &prev->cmds[j++].bounds);
+}
+
+// Erase one region to the background and replay the frame into it
+static void repaint_region(const display_list_t *dl, const dl_frame_t *frame, const clip_rect_t *r) {
+    // Large repaints are split into tiles and shared with the worker cores
+    if (rect_area(r) >= TILE_RASTER_MIN_AREA) {
+        tile_raster_render(dl, r);
+        return;
+    }
+
+    dl_erase(dl, r);
+    replay_frame(frame, r);
+}
+
+bool dl_submit(display_list_t *dl) {
+    const dl_frame_t *cur = &dl->frames[dl->current];
+    dl_damage_t damage;
+
+    // Already on screen
+    if (dl->valid && !dl->pending && dl->pending_damage.count == 0) {
+        return false;
+    }
+
+    damage.count = 0;
+    if (!dl->valid || dl->overflow) {
+        // Nothing trustworthy on screen: repaint everything both frames cover
+        for (int i = 0; i < cur->count; i++) dl_damage_add(&damage, &cur->cmds[i].bounds);
+        if (dl->valid) {
+            const dl_frame_t *prev = previous_frame(dl);
+            for (int i = 0; i < prev->count; i++) dl_damage_add(&damage, &prev->cmds[i].bounds);
+        }
+    } else {
+        compute_damage(dl, &damage);
+    }
+    for (int i = 0; i < dl->pending_damage.count; i++) {
+        dl_damage_add(&damage, &dl->pending_damage.rects[i]);
+    }
+    dl->pending_damage.count = 0;
+
+    dl->valid = true;
+    dl->pending = false;
+    dl->damage = empty_rect;
+
+    // Erase stale pixels, then replay everything that touches each damaged region
+    for (int i = 0; i < damage.count; i++) {
+        clip_rect_t r = damage.rects[i];
+        if (!intersect_clip_rect(&r, get_clip_rect())) continue;
+        repaint_region(dl, cur, &r);
+        rect_union(&dl->damage, &r);
+    }
+    return !rect_empty(&dl->damage);
+}
+
+void dl_invalidate(display_list_t *dl) {
+    dl->valid = false;
+}
+
+static inline bool rect_contains(const clip_rect_t *outer, const clip_rect_t *inner) {
+    return inner->x0 >= outer->x0 && inner->y0 >= outer->y0 &&
+           inner->x1 <= outer->x1 && inner->y1 <= outer->y1;
+}
+
+static void translate_cmd(dl_cmd_t *cmd, int dx, int dy) {
+    cmd->x += dx;
+    cmd->y += dy;
+    if (cmd->type == DL_CMD_LINE) {
+        cmd->w += dx;
+        cmd->h += dy;
+    }
+    cmd->bounds.x0 += dx;
+    cmd->bounds.x1 += dx;
+    cmd->bounds.y0 += dy;
+    cmd->bounds.y1 += dy;
+}
+
+void dl_scroll(display_list_t *dl, const clip_rect_t *region, int dx, int dy) {
+    if (dx == 0 && dy == 0) return;
+
+    // Nothing trustworthy on screen; the next submit repaints in full anyway
+    if (!dl->valid || dl->pending) return;
+
+    clip_rect_t r = *region;
+    if (!intersect_clip_rect(&r, get_clip_rect())) return;
+
+    // Outside the drawn content the region is plain background; moving it is wasted work
+    dl_frame_t *shown = current_frame(dl);
+    clip_rect_t content = empty_rect;
+    for (int i = 0; i < shown->count; i++) {
+        if (rect_overlaps(&shown->cmds[i].bounds, &r)) {
+            rect_union(&content, &shown->cmds[i].bounds);
+        }
+    }
+    if (!intersect_clip_rect(&r, &content)) return;
+
+    // Stale pixels already marked for repaint move with everything else
+    int pending = dl->pending_damage.count;
+    for (int i = 0; i < pending; i++) {
+        clip_rect_t moved = dl->pending_damage.rects[i];
+        if (!intersect_clip_rect(&moved, &r)) continue;
+        moved.x0 += dx;
+        moved.x1 += dx;
+        moved.y0 += dy;
+        moved.y1 += dy;
+        if (intersect_clip_rect(&moved, &r)) {
+            dl_damage_add(&dl->pending_damage, &moved);
+        }
+    }
+
+    clip_rect_t exposed[2];
+    int n = scroll_region(&r, dx, dy, exposed);
+    for (int i = 0; i < n; i++) {
+        dl_damage_add(&dl->pending_damage, &exposed[i]);
+    }
+
+    // Move the retained copy of the on-screen frame along with its pixels
+    for (int i = 0; i < shown->count; i++) {
+        dl_cmd_t *cmd = &shown->cmds[i];
+        if (!rect_overlaps(&cmd->bounds, &r)) continue;
+
+        if (rect_contains(&r, &cmd->bounds)) {
+            translate_cmd(cmd, dx, dy);
+            // Part of it slid out of the region and was not copied
+            if (!rect_contains(&r, &cmd->bounds)) {
+                dl_damage_add(&dl->pending_damage, &cmd->bounds);
+            }
+        } else {
+            // Straddles the region edge: its pixels are now split, repaint both places
+            clip_rect_t moved = cmd->bounds;
+            moved.x0 += dx;
+            moved.x1 += dx;
+            moved.y0 += dy;
+            moved.y1 += dy;
+            dl_damage_add(&dl->pending_damage, &cmd->bounds);
+            dl_damage_add(&dl->pending_damage, &moved);
+        }
+    }
+}
+
+void dl_replay(const display_list_t *dl, const clip_rect_t *clip) {
+    replay_frame(&dl->frames[dl->current], clip);
+}
+
+void dl_replay_command(const dl_frame_t *frame, int index, const clip_rect_t *clip) {
+    if (index < 0 || index >= frame->count) return;
+    replay_cmd(frame, &frame->cmds[index], clip);
+}
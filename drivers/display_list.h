@@ -0,0 +1,118 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display4k.h"
+
+// Per-widget capacity
+#define DL_MAX_COMMANDS   256
+#define DL_TEXT_ARENA     4096
+
+// Damage is tracked as a few rects so distant changes don't merge into one big box
+#define DL_MAX_DAMAGE_RECTS 4
+
+// How far the diff searches ahead to resynchronize after inserted/removed commands
+#define DL_DIFF_LOOKAHEAD 32
+
+// Recorded primitive types; replay batches by this order within a layer
+typedef enum {
+    DL_CMD_FILLED_RECT = 0,
+    DL_CMD_ROUNDED_RECT,
+    DL_CMD_CIRCLE,
+    DL_CMD_RECT,
+    DL_CMD_LINE,
+    DL_CMD_IMAGE,
+    DL_CMD_TEXT,
+    DL_CMD_TYPE_COUNT
+} dl_cmd_type_t;
+
+// One recorded draw command (x/y/w/h hold x1/y1/x2/y2 for lines)
+typedef struct {
+    uint8_t type;
+    uint8_t layer;
+    uint16_t text_len;
+    int16_t x, y, w, h;
+    int16_t radius;
+    uint16_t text_offset;
+    uint32_t color;             // For images: caller's stamp, changed whenever the pixels change
+    const uint32_t *image;      // Framebuffer-format pixels for DL_CMD_IMAGE
+    clip_rect_t bounds;         // Pixels the command may touch
+} dl_cmd_t;
+
+// One frame's worth of commands for a widget
+typedef struct {
+    dl_cmd_t cmds[DL_MAX_COMMANDS];
+    uint16_t count;
+    uint16_t text_used;
+    char text[DL_TEXT_ARENA];
+} dl_frame_t;
+
+// Set of regions to repaint
+typedef struct {
+    clip_rect_t rects[DL_MAX_DAMAGE_RECTS];
+    int count;
+} dl_damage_t;
+
+// Retained display list: the current and previous frame of one widget
+typedef struct {
+    dl_frame_t frames[2];
+    uint8_t current;            // Index of the frame being recorded / last recorded
+    uint8_t layer;              // Layer assigned to newly recorded commands
+    bool recording;
+    bool pending;               // Recorded frame not yet submitted
+    bool valid;                 // Previous frame is on screen
+    bool overflow;              // Recording ran out of space; forces a full repaint
+    uint32_t background;        // Color used to erase stale pixels
+    const uint32_t *background_image;   // Screen-sized pixels to erase with instead, or NULL
+    clip_rect_t bounds;         // Screen area the list owns; outside damage is ignored
+    clip_rect_t damage;         // Bounding box of what the last submit repainted
+    dl_damage_t pending_damage; // Repainted on the next submit besides the diff (scroll strips, overlays)
+} display_list_t;
+
+// Recording
+void dl_init(display_list_t *dl, uint32_t background);
+void dl_set_background_image(display_list_t *dl, const uint32_t *pixels);
+void dl_set_bounds(display_list_t *dl, int x, int y, int width, int height);
+void dl_begin(display_list_t *dl);
+void dl_set_layer(display_list_t *dl, uint8_t layer);
+void dl_filled_rect(display_list_t *dl, int x, int y, int width, int height, uint32_t color);
+void dl_rounded_rect(display_list_t *dl, int x, int y, int width, int height, int radius, uint32_t color);
+void dl_circle(display_list_t *dl, int cx, int cy, int radius, uint32_t color);
+void dl_rect(display_list_t *dl, int x, int y, int width, int height, uint32_t color);
+void dl_line(display_list_t *dl, int x1, int y1, int x2, int y2, uint32_t color);
+void dl_text(display_list_t *dl, int x, int y, const char *str, uint32_t color);
+void dl_image(display_list_t *dl, int x, int y, int width, int height,
+              const uint32_t *pixels, uint32_t stamp);
+void dl_end(display_list_t *dl);
+
+// Diff against the previous frame and repaint only the changed region.
+// The list owns its bounds: stale pixels are erased to the background,
+// so lists must not overlap each other. Returns true if anything was drawn.
+bool dl_submit(display_list_t *dl);
+
+// Move the on-screen pixels of `region` by (dx, dy) and shift the retained
+// frame to match, so the next submit only paints the exposed strip and
+// whatever actually changed. Call before dl_begin() for the new frame.
+void dl_scroll(display_list_t *dl, const clip_rect_t *region, int dx, int dy);
+
+// Forget the on-screen state so the next submit repaints everything
+void dl_invalidate(display_list_t *dl);
+
+// Mark screen regions stale (e.g. pixels an animation drew over) so the next
+// submit erases and replays them; regions are clipped to the list's bounds
+void dl_invalidate_region(display_list_t *dl, const dl_damage_t *damage);
+
+// Add a rect to a damage set, merging so it never exceeds DL_MAX_DAMAGE_RECTS
+void dl_damage_add(dl_damage_t *d, const clip_rect_t *r);
+
+// Replay the most recent frame into a clip window (no diffing)
+void dl_replay(const display_list_t *dl, const clip_rect_t *clip);
+
+// Erase a region to the list's background; used by the tile rasterizer
+void dl_erase(const display_list_t *dl, const clip_rect_t *clip);
+
+// Replay a single command of a frame; used by the tile rasterizer
+void dl_replay_command(const dl_frame_t *frame, int index, const clip_rect_t *clip);
+
+#endif // DISPLAY_LIST_H
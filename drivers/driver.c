@@ -2,9 +2,11 @@
 #include "display4k.h"
 #include "touch_input.h"
 #include "virtual_keyboard.h"
+#include "serial.h"
 
 void init_drivers() {
     init_display4k();
     init_touch_input();
     init_virtual_keyboard();
+    serial_init(SERIAL_COM1);
 }
@@ -0,0 +1,256 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "font_render.h"
+#include "display4k.h"
+
+// Largest cached glyph bitmap
+#define GLYPH_MAX_W (FONT_GLYPH_WIDTH * FONT_SIZE_MAX)
+#define GLYPH_MAX_H (FONT_GLYPH_HEIGHT * FONT_SIZE_MAX)
+
+// Master outline resolution used for antialiased sizes (4x via two Scale2x passes)
+#define MASTER_SCALE 4
+#define MASTER_W (FONT_GLYPH_WIDTH * MASTER_SCALE)
+#define MASTER_H (FONT_GLYPH_HEIGHT * MASTER_SCALE)
+
+// Supersampling grid per output pixel when resampling the master outline
+#define AA_SAMPLES 4
+
+// Cached glyph: 8-bit coverage at (codepoint, size)
+typedef struct {
+    uint8_t codepoint;
+    uint8_t size;
+    uint8_t valid;
+    uint8_t coverage[GLYPH_MAX_H][GLYPH_MAX_W];
+} glyph_cache_entry_t;
+
+static glyph_cache_entry_t glyph_cache[FONT_CACHE_SLOTS];
+static bool antialiasing = true;
+static uint32_t cache_hits = 0;
+static uint32_t cache_misses = 0;
+
+static inline int clamp_size(int size) {
+    if (size < FONT_SIZE_MIN) return FONT_SIZE_MIN;
+    if (size > FONT_SIZE_MAX) return FONT_SIZE_MAX;
+    return size;
+}
+
+static inline unsigned int cache_slot(uint8_t codepoint, uint8_t size) {
+    return ((unsigned int)codepoint * 31u + size * 7u) % FONT_CACHE_SLOTS;
+}
+
+// One Scale2x (EPX) pass: doubles a binary bitmap while smoothing diagonals
+static void scale2x(const uint8_t *src, int w, int h, uint8_t *dst) {
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint8_t p = src[y * w + x];
+            uint8_t a = y > 0     ? src[(y - 1) * w + x] : 0;
+            uint8_t b = x < w - 1 ? src[y * w + x + 1]   : 0;
+            uint8_t c = x > 0     ? src[y * w + x - 1]   : 0;
+            uint8_t d = y < h - 1 ? src[(y + 1) * w + x] : 0;
+
+            uint8_t e0 = p, e1 = p, e2 = p, e3 = p;
+            if (c == a && c != d && a != b) e0 = a;
+            if (a == b && a != c && b != d) e1 = b;
+            if (d == c && d != b && c != a) e2 = c;
+            if (b == d && b != a && d != c) e3 = d;
+
+            dst[(2 * y) * (2 * w) + 2 * x]         = e0;
+            dst[(2 * y) * (2 * w) + 2 * x + 1]     = e1;
+            dst[(2 * y + 1) * (2 * w) + 2 * x]     = e2;
+            dst[(2 * y + 1) * (2 * w) + 2 * x + 1] = e3;
+        }
+    }
+}
+
+// Rasterize a glyph into a cache entry at the requested size
+static void build_glyph(glyph_cache_entry_t *entry, uint8_t codepoint, int size) {
+    const unsigned char *bitmap = get_font_glyph((char)codepoint);
+    int w = FONT_GLYPH_WIDTH * size;
+    int h = FONT_GLYPH_HEIGHT * size;
+
+    memset(entry->coverage, 0, sizeof(entry->coverage));
+    entry->codepoint = codepoint;
+    entry->size = (uint8_t)size;
+    entry->valid = 1;
+    if (!bitmap) return;
+
+    // Plain integer scaling: size 1, or antialiasing disabled
+    if (size == 1 || !antialiasing) {
+        for (int y = 0; y < h; y++) {
+            unsigned char row = bitmap[y / size];
+            for (int x = 0; x < w; x++) {
+                entry->coverage[y][x] = (row & (0x80 >> (x / size))) ? 255 : 0;
+            }
+        }
+        return;
+    }
+
+    // Smooth the outline at 4x, then box-filter it down to the target size
+    static uint8_t base[FONT_GLYPH_HEIGHT * FONT_GLYPH_WIDTH];
+    static uint8_t mid[FONT_GLYPH_HEIGHT * 2 * FONT_GLYPH_WIDTH * 2];
+    static uint8_t master[MASTER_H * MASTER_W];
+
+    for (int y = 0; y < FONT_GLYPH_HEIGHT; y++) {
+        for (int x = 0; x < FONT_GLYPH_WIDTH; x++) {
+            base[y * FONT_GLYPH_WIDTH + x] = (bitmap[y] & (0x80 >> x)) ? 1 : 0;
+        }
+    }
+    scale2x(base, FONT_GLYPH_WIDTH, FONT_GLYPH_HEIGHT, mid);
+    scale2x(mid, FONT_GLYPH_WIDTH * 2, FONT_GLYPH_HEIGHT * 2, master);
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int hits = 0;
+            for (int sy = 0; sy < AA_SAMPLES; sy++) {
+                int my = ((y * AA_SAMPLES + sy) * MASTER_SCALE) / (size * AA_SAMPLES);
+                for (int sx = 0; sx < AA_SAMPLES; sx++) {
+                    int mx = ((x * AA_SAMPLES + sx) * MASTER_SCALE) / (size * AA_SAMPLES);
+                    hits += master[my * MASTER_W + mx];
+                }
+            }
+            entry->coverage[y][x] = (uint8_t)((hits * 255) / (AA_SAMPLES * AA_SAMPLES));
+        }
+    }
+}
+
+// Look up (codepoint, size), rasterizing on a miss
+static const glyph_cache_entry_t *lookup_glyph(uint8_t codepoint, int size) {
+    glyph_cache_entry_t *entry = &glyph_cache[cache_slot(codepoint, (uint8_t)size)];
+
+    if (entry->valid && entry->codepoint == codepoint && entry->size == size) {
+        cache_hits++;
+        return entry;
+    }
+
+    cache_misses++;
+    build_glyph(entry, codepoint, size);
+    return entry;
+}
+
+// Blend a channel-wise lerp between dst and color by coverage (0-255)
+static inline uint32_t blend_pixel(uint32_t dst, uint32_t color, uint32_t coverage) {
+    uint32_t inv = 255 - coverage;
+    uint32_t rb = ((color & 0xFF00FF) * coverage + (dst & 0xFF00FF) * inv) >> 8;
+    uint32_t g  = ((color & 0x00FF00) * coverage + (dst & 0x00FF00) * inv) >> 8;
+    return (rb & 0xFF00FF) | (g & 0x00FF00);
+}
+
+// Composite one cached glyph, clipped to the active clip window
+static void blit_glyph(const glyph_cache_entry_t *glyph, int x, int y, uint32_t color) {
+    const clip_rect_t *clip = get_clip_rect();
+    int w = FONT_GLYPH_WIDTH * glyph->size;
+    int h = FONT_GLYPH_HEIGHT * glyph->size;
+
+    if (x + w <= clip->x0 || x >= clip->x1 || y + h <= clip->y0 || y >= clip->y1) return;
+
+    int col0 = x < clip->x0 ? clip->x0 - x : 0;
+    int col1 = x + w > clip->x1 ? clip->x1 - x : w;
+    int row0 = y < clip->y0 ? clip->y0 - y : 0;
+    int row1 = y + h > clip->y1 ? clip->y1 - y : h;
+
+    for (int row = row0; row < row1; row++) {
+        uint32_t *dst = &framebuffer[(y + row) * SCREEN_WIDTH + x];
+        const uint8_t *cov = glyph->coverage[row];
+        for (int col = col0; col < col1; col++) {
+            uint8_t c = cov[col];
+            if (c == 255) {
+                dst[col] = color;
+            } else if (c) {
+                dst[col] = blend_pixel(dst[col], color, c);
+            }
+        }
+    }
+}
+
+// Initialize the scaled font renderer and clear the glyph cache
+void font_render_init(void) {
+    memset(glyph_cache, 0, sizeof(glyph_cache));
+    cache_hits = 0;
+    cache_misses = 0;
+}
+
+// Enable or disable grayscale antialiasing
+void font_set_antialiasing(bool enabled) {
+    if (antialiasing != enabled) {
+        antialiasing = enabled;
+        font_render_init();
+    }
+}
+
+// Draw text at an integer scale of the bitmap font
+void draw_text_scaled(int x, int y, const char *str, uint32_t color, int size) {
+    if (!str || !framebuffer) return;
+
+    size = clamp_size(size);
+    int advance = FONT_CHAR_ADVANCE * size;
+    int cursor_x = x;
+    int cursor_y = y;
+
+    while (*str) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '\n') {
+            cursor_y += FONT_LINE_HEIGHT * size;
+            cursor_x = x;
+        } else if (c == '\r') {
+            cursor_x = x;
+        } else if (c == '\t') {
+            int tab = 32 * size;
+            cursor_x = ((cursor_x - x) / tab + 1) * tab + x;
+        } else if (c >= 32 && c <= 127) {
+            if (c != ' ') {
+                blit_glyph(lookup_glyph(c, size), cursor_x, cursor_y, color);
+            }
+            cursor_x += advance;
+        }
+        str++;
+    }
+}
+
+// Draw text at FONT_SIZE_DEFAULT
+void draw_text(int x, int y, const char *str, uint32_t color) {
+    draw_text_scaled(x, y, str, color, FONT_SIZE_DEFAULT);
+}
+
+// Exact pixel extent of str, using the same cursor rules as the renderers
+void measure_string(const char *str, int size, int *width, int *height) {
+    int max_w = 0;
+    int lines = 0;
+
+    size = clamp_size(size);
+    if (str && *str) {
+        int cursor_x = 0;
+        int line_w = 0;
+        lines = 1;
+
+        for (; *str; str++) {
+            unsigned char c = (unsigned char)*str;
+            if (c == '\n') {
+                if (line_w > max_w) max_w = line_w;
+                cursor_x = 0;
+                line_w = 0;
+                lines++;
+            } else if (c == '\r') {
+                cursor_x = 0;
+            } else if (c == '\t') {
+                cursor_x = (cursor_x / 32 + 1) * 32;
+            } else if (c >= 32 && c <= 127) {
+                // Ink ends at the glyph edge, not at the next advance
+                if (cursor_x + FONT_GLYPH_WIDTH > line_w) line_w = cursor_x + FONT_GLYPH_WIDTH;
+                cursor_x += FONT_CHAR_ADVANCE;
+            }
+        }
+        if (line_w > max_w) max_w = line_w;
+    }
+
+    if (width) *width = max_w * size;
+    if (height) {
+        *height = lines ? ((lines - 1) * FONT_LINE_HEIGHT + FONT_GLYPH_HEIGHT) * size : 0;
+    }
+}
+
+// Cache statistics for tuning
+void font_cache_stats(uint32_t *hits, uint32_t *misses) {
+    if (hits) *hits = cache_hits;
+    if (misses) *misses = cache_misses;
+}
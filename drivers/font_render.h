@@ -0,0 +1,34 @@
+#ifndef FONT_RENDER_H
+#define FONT_RENDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Scaled font sizes are integer multiples of the 8x10 bitmap font
+#define FONT_SIZE_MIN     1
+#define FONT_SIZE_MAX     4
+#define FONT_SIZE_DEFAULT 3   // Readable body text at 3840x2160
+
+// Glyph cache capacity (entries keyed by codepoint and size)
+#define FONT_CACHE_SLOTS  128
+
+// Initialize the scaled font renderer and clear the glyph cache
+void font_render_init(void);
+
+// Enable or disable grayscale antialiasing (flushes the glyph cache)
+void font_set_antialiasing(bool enabled);
+
+// Draw text at an integer scale of the bitmap font
+void draw_text_scaled(int x, int y, const char *str, uint32_t color, int size);
+
+// Draw text at FONT_SIZE_DEFAULT
+void draw_text(int x, int y, const char *str, uint32_t color);
+
+// Exact pixel extent of str at the given size; either output may be NULL.
+// Size 1 matches draw_string() exactly.
+void measure_string(const char *str, int size, int *width, int *height);
+
+// Cache statistics for tuning
+void font_cache_stats(uint32_t *hits, uint32_t *misses);
+
+#endif // FONT_RENDER_H
@@ -293,6 +293,6 @@ unsigned char font8x10[96][10] = {
 
 // ASCII 127: DEL (often represented as a hollow box or special character)
 {0x7E, 0x42, 0x42, 0x42, 0x42, 0x42, 0x7E, 0x00, 0x00, 0x00},
+};
 
 #endif
-}
\ No newline at end of file
@@ -0,0 +1,133 @@
+// hit_grid.c - uniform-grid hit-testing for touch targets
+#include "hit_grid.h"
+
+// Size the cell table for the current shift
+static void set_cells(hit_grid_t *grid, int width, int height) {
+    int size = 1 << grid->cell_shift;
+    grid->cols = (width + size - 1) >> grid->cell_shift;
+    grid->rows = (height + size - 1) >> grid->cell_shift;
+    if (grid->cols < 1) grid->cols = 1;
+    if (grid->rows < 1) grid->rows = 1;
+}
+
+void hit_grid_begin(hit_grid_t *grid, int x, int y, int width, int height, int cell_shift) {
+    grid->x0 = x;
+    grid->y0 = y;
+    grid->width = width;
+    grid->height = height;
+    grid->cell_shift = cell_shift < 1 ? 1 : cell_shift;
+    set_cells(grid, width, height);
+    while (grid->cols * grid->rows > HIT_GRID_MAX_CELLS) {
+        grid->cell_shift++;
+        set_cells(grid, width, height);
+    }
+    grid->count = 0;
+    grid->built = false;
+}
+
+int hit_grid_add(hit_grid_t *grid, int x, int y, int width, int height, int id) {
+    if (grid->count >= HIT_GRID_MAX_ITEMS || width <= 0 || height <= 0) return -1;
+
+    hit_item_t *item = &grid->items[grid->count++];
+    item->x = (int16_t)x;
+    item->y = (int16_t)y;
+    item->width = (int16_t)width;
+    item->height = (int16_t)height;
+    item->id = id;
+    grid->built = false;
+    return grid->count - 1;
+}
+
+// Cells an item overlaps, clipped to the grid; false if it misses entirely
+static bool item_cells(const hit_grid_t *grid, const hit_item_t *item,
+                       int *c0, int *r0, int *c1, int *r1) {
+    int x0 = item->x - grid->x0, y0 = item->y - grid->y0;
+    int x1 = x0 + item->width - 1, y1 = y0 + item->height - 1;
+    if (x1 < 0 || y1 < 0) return false;
+
+    *c0 = x0 < 0 ? 0 : x0 >> grid->cell_shift;
+    *r0 = y0 < 0 ? 0 : y0 >> grid->cell_shift;
+    *c1 = x1 >> grid->cell_shift;
+    *r1 = y1 >> grid->cell_shift;
+    if (*c0 >= grid->cols || *r0 >= grid->rows) return false;
+    if (*c1 >= grid->cols) *c1 = grid->cols - 1;
+    if (*r1 >= grid->rows) *r1 = grid->rows - 1;
+    return true;
+}
+
+static int count_refs(const hit_grid_t *grid) {
+    int total = 0;
+    for (int i = 0; i < grid->count; i++) {
+        int c0, r0, c1, r1;
+        if (item_cells(grid, &grid->items[i], &c0, &r0, &c1, &r1)) {
+            total += (c1 - c0 + 1) * (r1 - r0 + 1);
+        }
+    }
+    return total;
+}
+
+void hit_grid_build(hit_grid_t *grid) {
+    // Big targets on small cells can overflow the reference table; coarser
+    // cells always fit eventually
+    while (count_refs(grid) > HIT_GRID_MAX_REFS) {
+        grid->cell_shift++;
+        set_cells(grid, grid->width, grid->height);
+    }
+
+    int cells = grid->cols * grid->rows;
+    for (int c = 0; c <= cells; c++) {
+        grid->cell_start[c] = 0;
+    }
+
+    // Count per cell, shifted by one so the prefix sum yields start offsets
+    for (int i = 0; i < grid->count; i++) {
+        int c0, r0, c1, r1;
+        if (!item_cells(grid, &grid->items[i], &c0, &r0, &c1, &r1)) continue;
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                grid->cell_start[r * grid->cols + c + 1]++;
+            }
+        }
+    }
+    for (int c = 0; c < cells; c++) {
+        grid->cell_start[c + 1] += grid->cell_start[c];
+    }
+
+    // Fill in item order using each cell's start as its write cursor; that
+    // leaves every start pointing at the next cell's, so shift them back
+    for (int i = 0; i < grid->count; i++) {
+        int c0, r0, c1, r1;
+        if (!item_cells(grid, &grid->items[i], &c0, &r0, &c1, &r1)) continue;
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                int cell = r * grid->cols + c;
+                grid->refs[grid->cell_start[cell]++] = (uint16_t)i;
+            }
+        }
+    }
+    for (int c = cells; c > 0; c--) {
+        grid->cell_start[c] = grid->cell_start[c - 1];
+    }
+    grid->cell_start[0] = 0;
+
+    grid->built = true;
+}
+
+int hit_grid_find(const hit_grid_t *grid, int x, int y) {
+    if (!grid->built) return -1;
+
+    // The last row and column of cells can reach past the region's edge
+    int gx = x - grid->x0, gy = y - grid->y0;
+    if (gx < 0 || gy < 0 || gx >= grid->width || gy >= grid->height) return -1;
+    int c = gx >> grid->cell_shift, r = gy >> grid->cell_shift;
+
+    int cell = r * grid->cols + c;
+    for (int k = grid->cell_start[cell + 1] - 1; k >= grid->cell_start[cell]; k--) {
+        const hit_item_t *item = &grid->items[grid->refs[k]];
+        if (x >= item->x && x < item->x + item->width &&
+            y >= item->y && y < item->y + item->height) {
+            return item->id;
+        }
+    }
+    return -1;
+}
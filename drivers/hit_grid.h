@@ -0,0 +1,45 @@
+#ifndef HIT_GRID_H
+#define HIT_GRID_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Touch targets per index, and cells/cell references the grid may use
+#define HIT_GRID_MAX_ITEMS 256
+#define HIT_GRID_MAX_CELLS 2048
+#define HIT_GRID_MAX_REFS  2048
+
+// A touch target; rects are half-open like clip_rect_t
+typedef struct {
+    int16_t x, y, width, height;
+    int id;
+} hit_item_t;
+
+// Uniform-grid hit-test index. Items are bucketed into square cells once per
+// layout, so a lookup only checks the few items overlapping one cell.
+typedef struct {
+    int x0, y0;                 // Covered region
+    int width, height;
+    int cols, rows;
+    int cell_shift;             // Cells are 1 << cell_shift pixels square
+    int count;
+    hit_item_t items[HIT_GRID_MAX_ITEMS];
+    uint16_t cell_start[HIT_GRID_MAX_CELLS + 1];    // Cell c owns refs[cell_start[c] .. cell_start[c + 1])
+    uint16_t refs[HIT_GRID_MAX_REFS];
+    bool built;
+} hit_grid_t;
+
+// Start a new layout covering (x, y, width, height). cell_shift is a hint;
+// it grows if the region would need more than HIT_GRID_MAX_CELLS cells.
+void hit_grid_begin(hit_grid_t *grid, int x, int y, int width, int height, int cell_shift);
+
+// Add a target; later items win where targets overlap. Returns -1 when full.
+int hit_grid_add(hit_grid_t *grid, int x, int y, int width, int height, int id);
+
+// Bucket the items; call after the last hit_grid_add() of a layout
+void hit_grid_build(hit_grid_t *grid);
+
+// id of the target under (x, y), or -1; nothing outside the region hits
+int hit_grid_find(const hit_grid_t *grid, int x, int y);
+
+#endif // HIT_GRID_H
@@ -0,0 +1,881 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "image_decoder.h"
+
+#define INPUT_BUFFER_SIZE  4096
+#define WINDOW_SIZE        32768
+#define WINDOW_MASK        (WINDOW_SIZE - 1)
+#define MAX_LINE_BYTES     (IMAGE_MAX_WIDTH * 4)
+#define FAST_BITS          9
+#define PNG_MAX_CHUNK      0x7FFFFFFFu  // Largest chunk length the PNG spec allows
+
+// ---------------------------------------------------------------------------
+// Buffered input
+// ---------------------------------------------------------------------------
+
+static struct {
+    image_read_fn read;
+    void *ctx;
+    uint8_t buf[INPUT_BUFFER_SIZE];
+    int pos;
+    int len;
+    bool eof;
+} in;
+
+// Next input byte, or -1 once the reader is exhausted
+static int in_byte(void) {
+    if (in.pos >= in.len) {
+        if (in.eof) return -1;
+        int n = in.read(in.ctx, in.buf, INPUT_BUFFER_SIZE);
+        if (n <= 0) {
+            in.eof = true;
+            return -1;
+        }
+        in.len = n;
+        in.pos = 0;
+    }
+    return in.buf[in.pos++];
+}
+
+static int in_bytes(uint8_t *dst, int count) {
+    for (int i = 0; i < count; i++) {
+        int b = in_byte();
+        if (b < 0) return IMAGE_ERR_IO;
+        dst[i] = (uint8_t)b;
+    }
+    return IMAGE_OK;
+}
+
+static int in_skip(uint32_t count) {
+    while (count--) {
+        if (in_byte() < 0) return IMAGE_ERR_IO;
+    }
+    return IMAGE_OK;
+}
+
+static inline uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint32_t le32(const uint8_t *p) {
+    return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint16_t le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Scanline storage shared by both formats
+static uint8_t lines[2][MAX_LINE_BYTES];
+static uint32_t row_pixels[IMAGE_MAX_WIDTH];
+
+// ---------------------------------------------------------------------------
+// PNG scanline assembly: inflate output -> unfilter -> ARGB rows
+// ---------------------------------------------------------------------------
+
+static struct {
+    const image_sink_t *sink;
+    int width, height;
+    int depth, color_type;
+    int stride;             // Bytes per scanline, excluding the filter byte
+    int bpp;                // Filter distance in bytes (at least 1)
+    int filter;             // Filter of the line being assembled, -1 before its first byte
+    int line_pos;
+    int y;
+    uint8_t *cur, *prev;
+    uint32_t palette[256];
+    int error;
+
+    // Current IDAT chunk
+    uint32_t chunk_left;
+    bool idat_done;
+    uint8_t next_chunk[8];  // Header of the chunk that ended the IDAT run
+} png;
+
+static inline uint8_t paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = p > a ? p - a : a - p;
+    int pb = p > b ? p - b : b - p;
+    int pc = p > c ? p - c : c - p;
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    if (pb <= pc) return (uint8_t)b;
+    return (uint8_t)c;
+}
+
+static void png_unfilter(void) {
+    uint8_t *cur = png.cur;
+    const uint8_t *prev = png.prev;
+    int bpp = png.bpp;
+    int n = png.stride;
+
+    switch (png.filter) {
+        case 0:
+            break;
+        case 1:
+            for (int i = bpp; i < n; i++) cur[i] += cur[i - bpp];
+            break;
+        case 2:
+            for (int i = 0; i < n; i++) cur[i] += prev[i];
+            break;
+        case 3:
+            for (int i = 0; i < bpp; i++) cur[i] += prev[i] >> 1;
+            for (int i = bpp; i < n; i++) cur[i] += (uint8_t)((cur[i - bpp] + prev[i]) >> 1);
+            break;
+        case 4:
+            for (int i = 0; i < bpp; i++) cur[i] += prev[i];
+            for (int i = bpp; i < n; i++) cur[i] += paeth(cur[i - bpp], prev[i], prev[i - bpp]);
+            break;
+        default:
+            png.error = IMAGE_ERR_CORRUPT;
+            break;
+    }
+}
+
+// Sample `index` of a packed sub-byte scanline
+static inline int packed_sample(const uint8_t *line, int index, int depth) {
+    int bit = index * depth;
+    return (line[bit >> 3] >> (8 - depth - (bit & 7))) & ((1 << depth) - 1);
+}
+
+static void png_convert_row(void) {
+    const uint8_t *s = png.cur;
+    int w = png.width;
+
+    switch (png.color_type) {
+        case 0:     // Grayscale
+            if (png.depth == 8) {
+                for (int x = 0; x < w; x++) row_pixels[x] = 0xFF000000u | (s[x] * 0x010101u);
+            } else {
+                int scale = 255 / ((1 << png.depth) - 1);
+                for (int x = 0; x < w; x++) {
+                    row_pixels[x] = 0xFF000000u | (packed_sample(s, x, png.depth) * scale * 0x010101u);
+                }
+            }
+            break;
+        case 2:     // RGB
+            for (int x = 0; x < w; x++, s += 3) {
+                row_pixels[x] = 0xFF000000u | ((uint32_t)s[0] << 16) | ((uint32_t)s[1] << 8) | s[2];
+            }
+            break;
+        case 3:     // Palette
+            if (png.depth == 8) {
+                for (int x = 0; x < w; x++) row_pixels[x] = png.palette[s[x]];
+            } else {
+                for (int x = 0; x < w; x++) row_pixels[x] = png.palette[packed_sample(s, x, png.depth)];
+            }
+            break;
+        case 4:     // Grayscale + alpha
+            for (int x = 0; x < w; x++, s += 2) {
+                row_pixels[x] = ((uint32_t)s[1] << 24) | (s[0] * 0x010101u);
+            }
+            break;
+        case 6:     // RGBA
+            for (int x = 0; x < w; x++, s += 4) {
+                row_pixels[x] = ((uint32_t)s[3] << 24) | ((uint32_t)s[0] << 16) |
+                                ((uint32_t)s[1] << 8) | s[2];
+            }
+            break;
+    }
+}
+
+// Consume one decompressed byte
+static inline void png_push(uint8_t b) {
+    if (png.y >= png.height) return;
+
+    if (png.filter < 0) {
+        png.filter = b;
+        return;
+    }
+    png.cur[png.line_pos++] = b;
+    if (png.line_pos < png.stride) return;
+
+    png_unfilter();
+    png_convert_row();
+    png.sink->row(png.sink->ctx, png.y, row_pixels, png.width);
+    png.y++;
+
+    uint8_t *t = png.prev;
+    png.prev = png.cur;
+    png.cur = t;
+    png.line_pos = 0;
+    png.filter = -1;
+}
+
+// Next byte of zlib data, following the stream across IDAT chunks
+static int idat_byte(void) {
+    while (png.chunk_left == 0) {
+        if (png.idat_done) return -1;
+        // Skip the CRC and read the next chunk header
+        if (in_skip(4) != IMAGE_OK || in_bytes(png.next_chunk, 8) != IMAGE_OK) {
+            png.idat_done = true;
+            return -1;
+        }
+        if (memcmp(png.next_chunk + 4, "IDAT", 4) != 0) {
+            png.idat_done = true;
+            return -1;
+        }
+        png.chunk_left = be32(png.next_chunk);
+        if (png.chunk_left > PNG_MAX_CHUNK) {
+            png.idat_done = true;
+            return -1;
+        }
+    }
+    png.chunk_left--;
+    return in_byte();
+}
+
+// ---------------------------------------------------------------------------
+// Inflate (RFC 1951), pull-based with a 32 KB sliding window
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    uint16_t fast[1 << FAST_BITS];  // (length << 12) | symbol for short codes, 0 otherwise
+    uint16_t count[16];             // Codes per length
+    uint16_t symbol[288];           // Symbols in canonical order
+} huffman_t;
+
+// Where inflate stopped; it picks up from here on the next inflate_run()
+enum {
+    BLOCK_HEADER,           // Next up: a block header
+    BLOCK_STORED,           // stored_left bytes of a stored block to copy
+    BLOCK_CODES,            // Inside a Huffman-coded block
+    BLOCK_DONE              // Past the final block
+};
+
+static struct {
+    uint32_t bitbuf;
+    int bitcnt;
+    bool eof;
+    uint8_t window[WINDOW_SIZE];
+    uint32_t out_total;
+    huffman_t lencode, distcode;
+    huffman_t fixed_len, fixed_dist;
+    bool fixed_ready;
+    int block;
+    bool last;              // The current block is the final one
+    uint32_t stored_left;
+    const huffman_t *lens, *dists;
+} z;
+
+static const uint16_t len_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t len_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Top up the bit buffer to at least n bits; false if the stream ran out
+static inline bool fill_bits(int n) {
+    while (z.bitcnt < n) {
+        int b = idat_byte();
+        if (b < 0) return false;
+        z.bitbuf |= (uint32_t)b << z.bitcnt;
+        z.bitcnt += 8;
+    }
+    return true;
+}
+
+static inline uint32_t get_bits(int n) {
+    if (n == 0) return 0;
+    if (!fill_bits(n)) {
+        z.eof = true;
+        return 0;
+    }
+    uint32_t v = z.bitbuf & ((1u << n) - 1);
+    z.bitbuf >>= n;
+    z.bitcnt -= n;
+    return v;
+}
+
+static inline void emit(uint8_t b) {
+    z.window[z.out_total++ & WINDOW_MASK] = b;
+    png_push(b);
+}
+
+// Build canonical decoding tables; returns false for over-subscribed code sets
+static bool build_huffman(huffman_t *h, const uint8_t *lengths, int n) {
+    uint16_t offs[16];
+    uint16_t next_code[16];
+
+    memset(h->count, 0, sizeof(h->count));
+    memset(h->fast, 0, sizeof(h->fast));
+    for (int i = 0; i < n; i++) h->count[lengths[i]]++;
+    h->count[0] = 0;
+
+    int left = 1;
+    for (int len = 1; len < 16; len++) {
+        left <<= 1;
+        left -= h->count[len];
+        if (left < 0) return false;
+    }
+
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + h->count[len];
+
+    int code = 0;
+    for (int len = 1; len < 16; len++) {
+        code = (code + h->count[len - 1]) << 1;
+        next_code[len] = (uint16_t)code;
+    }
+
+    for (int sym = 0; sym < n; sym++) {
+        int len = lengths[sym];
+        if (len == 0) continue;
+        h->symbol[offs[len]++] = (uint16_t)sym;
+
+        int c = next_code[len]++;
+        if (len <= FAST_BITS) {
+            // Codes are stored MSB-first but read LSB-first
+            int rev = 0;
+            for (int i = 0; i < len; i++) rev |= ((c >> i) & 1) << (len - 1 - i);
+            for (int k = rev; k < (1 << FAST_BITS); k += 1 << len) {
+                h->fast[k] = (uint16_t)((len << 12) | sym);
+            }
+        }
+    }
+    return true;
+}
+
+// Decode one symbol; -1 on a bad code or end of data
+static int decode_symbol(const huffman_t *h) {
+    fill_bits(FAST_BITS);
+
+    uint16_t entry = h->fast[z.bitbuf & ((1 << FAST_BITS) - 1)];
+    if (entry && (entry >> 12) <= z.bitcnt) {
+        int len = entry >> 12;
+        z.bitbuf >>= len;
+        z.bitcnt -= len;
+        return entry & 0xFFF;
+    }
+
+    // Long code: walk the canonical code one bit at a time
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; len++) {
+        if (!fill_bits(1)) {
+            z.eof = true;
+            return -1;
+        }
+        code |= z.bitbuf & 1;
+        z.bitbuf >>= 1;
+        z.bitcnt--;
+
+        int count = h->count[len];
+        if (code - count < first) return h->symbol[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+static int inflate_stored_header(void) {
+    // Stored blocks start on a byte boundary
+    get_bits(z.bitcnt & 7);
+    uint32_t len = get_bits(16);
+    uint32_t nlen = get_bits(16);
+    if (z.eof) return IMAGE_ERR_IO;
+    if ((len ^ 0xFFFF) != nlen) return IMAGE_ERR_CORRUPT;
+    z.stored_left = len;
+    return IMAGE_OK;
+}
+
+// The rest of a stored block, stopping once png.y reaches stop_row
+static int inflate_stored(int stop_row) {
+    while (z.stored_left > 0) {
+        if (png.y >= stop_row) return IMAGE_MORE;
+        emit((uint8_t)get_bits(8));
+        if (z.eof) return IMAGE_ERR_IO;
+        z.stored_left--;
+    }
+    return IMAGE_OK;
+}
+
+// The rest of a coded block, stopping once png.y reaches stop_row. A match
+// is always copied whole, so a stop can come up to 258 bytes late.
+static int inflate_codes(int stop_row) {
+    for (;;) {
+        if (png.y >= stop_row) return IMAGE_MORE;
+
+        int sym = decode_symbol(z.lens);
+        if (sym < 0) return z.eof ? IMAGE_ERR_IO : IMAGE_ERR_CORRUPT;
+
+        if (sym < 256) {
+            emit((uint8_t)sym);
+            continue;
+        }
+        if (sym == 256) return IMAGE_OK;
+
+        sym -= 257;
+        if (sym >= 29) return IMAGE_ERR_CORRUPT;
+        int len = len_base[sym] + (int)get_bits(len_extra[sym]);
+
+        int dsym = decode_symbol(z.dists);
+        if (dsym < 0 || dsym >= 30) return z.eof ? IMAGE_ERR_IO : IMAGE_ERR_CORRUPT;
+        uint32_t dist = dist_base[dsym] + get_bits(dist_extra[dsym]);
+        if (z.eof) return IMAGE_ERR_IO;
+        if (dist > z.out_total) return IMAGE_ERR_CORRUPT;
+
+        while (len--) {
+            emit(z.window[(z.out_total - dist) & WINDOW_MASK]);
+        }
+        if (png.error) return png.error;
+    }
+}
+
+static void build_fixed_tables(void) {
+    uint8_t lengths[288];
+    int i = 0;
+    for (; i < 144; i++) lengths[i] = 8;
+    for (; i < 256; i++) lengths[i] = 9;
+    for (; i < 280; i++) lengths[i] = 7;
+    for (; i < 288; i++) lengths[i] = 8;
+    build_huffman(&z.fixed_len, lengths, 288);
+
+    for (i = 0; i < 30; i++) lengths[i] = 5;
+    build_huffman(&z.fixed_dist, lengths, 30);
+    z.fixed_ready = true;
+}
+
+// Read a dynamic block's code tables into z.lencode and z.distcode
+static int inflate_dynamic_tables(void) {
+    static const uint8_t order[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+    };
+    uint8_t lengths[286 + 30];
+
+    int nlen = (int)get_bits(5) + 257;
+    int ndist = (int)get_bits(5) + 1;
+    int ncode = (int)get_bits(4) + 4;
+    if (z.eof) return IMAGE_ERR_IO;
+    if (nlen > 286 || ndist > 30) return IMAGE_ERR_CORRUPT;
+
+    memset(lengths, 0, sizeof(lengths));
+    for (int i = 0; i < ncode; i++) lengths[order[i]] = (uint8_t)get_bits(3);
+    if (!build_huffman(&z.lencode, lengths, 19)) return IMAGE_ERR_CORRUPT;
+
+    int index = 0;
+    while (index < nlen + ndist) {
+        int sym = decode_symbol(&z.lencode);
+        if (sym < 0) return z.eof ? IMAGE_ERR_IO : IMAGE_ERR_CORRUPT;
+
+        if (sym < 16) {
+            lengths[index++] = (uint8_t)sym;
+            continue;
+        }
+
+        uint8_t len = 0;
+        int repeat;
+        if (sym == 16) {
+            if (index == 0) return IMAGE_ERR_CORRUPT;
+            len = lengths[index - 1];
+            repeat = 3 + (int)get_bits(2);
+        } else if (sym == 17) {
+            repeat = 3 + (int)get_bits(3);
+        } else {
+            repeat = 11 + (int)get_bits(7);
+        }
+        if (index + repeat > nlen + ndist) return IMAGE_ERR_CORRUPT;
+        while (repeat--) lengths[index++] = len;
+    }
+
+    if (lengths[256] == 0) return IMAGE_ERR_CORRUPT;
+    if (!build_huffman(&z.lencode, lengths, nlen)) return IMAGE_ERR_CORRUPT;
+    if (!build_huffman(&z.distcode, lengths + nlen, ndist)) return IMAGE_ERR_CORRUPT;
+    return IMAGE_OK;
+}
+
+// Start inflating a zlib stream into png_push()
+static int inflate_start(void) {
+    z.bitbuf = 0;
+    z.bitcnt = 0;
+    z.eof = false;
+    z.out_total = 0;
+    z.block = BLOCK_HEADER;
+
+    uint32_t cmf = get_bits(8);
+    uint32_t flg = get_bits(8);
+    if (z.eof) return IMAGE_ERR_IO;
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) {
+        return IMAGE_ERR_CORRUPT;
+    }
+    return IMAGE_OK;
+}
+
+static int inflate_block_header(void) {
+    z.last = get_bits(1) != 0;
+    int type = (int)get_bits(2);
+    if (z.eof) return IMAGE_ERR_IO;
+
+    switch (type) {
+        case 0:
+            z.block = BLOCK_STORED;
+            return inflate_stored_header();
+        case 1:
+            if (!z.fixed_ready) build_fixed_tables();
+            z.lens = &z.fixed_len;
+            z.dists = &z.fixed_dist;
+            z.block = BLOCK_CODES;
+            return IMAGE_OK;
+        case 2:
+            z.lens = &z.lencode;
+            z.dists = &z.distcode;
+            z.block = BLOCK_CODES;
+            return inflate_dynamic_tables();
+        default:
+            return IMAGE_ERR_CORRUPT;
+    }
+}
+
+// Inflate until png.y reaches stop_row (IMAGE_MORE) or the stream ends
+static int inflate_run(int stop_row) {
+    for (;;) {
+        int result;
+        switch (z.block) {
+            case BLOCK_HEADER:
+                result = inflate_block_header();
+                if (result != IMAGE_OK) return result;
+                continue;
+            case BLOCK_STORED:
+                result = inflate_stored(stop_row);
+                break;
+            case BLOCK_CODES:
+                result = inflate_codes(stop_row);
+                break;
+            default:
+                // The Adler-32 trailer is not checked; the scanline count is
+                return IMAGE_OK;
+        }
+        if (result != IMAGE_OK) return result;
+        if (png.error) return png.error;
+        z.block = z.last ? BLOCK_DONE : BLOCK_HEADER;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// PNG container
+// ---------------------------------------------------------------------------
+
+static int png_check_header(void) {
+    switch (png.color_type) {
+        case 0:
+            if (png.depth == 16) return IMAGE_ERR_UNSUPPORTED;
+            if (png.depth != 1 && png.depth != 2 && png.depth != 4 && png.depth != 8) {
+                return IMAGE_ERR_CORRUPT;
+            }
+            return IMAGE_OK;
+        case 3:
+            if (png.depth != 1 && png.depth != 2 && png.depth != 4 && png.depth != 8) {
+                return IMAGE_ERR_CORRUPT;
+            }
+            return IMAGE_OK;
+        case 2:
+        case 4:
+        case 6:
+            if (png.depth == 16) return IMAGE_ERR_UNSUPPORTED;
+            return png.depth == 8 ? IMAGE_OK : IMAGE_ERR_CORRUPT;
+        default:
+            return IMAGE_ERR_CORRUPT;
+    }
+}
+
+// Read chunks up to the image data and start inflating it
+static int png_begin(const image_sink_t *sink) {
+    static const uint8_t channels[7] = { 1, 0, 3, 1, 2, 0, 4 };
+    uint8_t header[13];
+    uint8_t chunk[8];
+    bool have_header = false;
+
+    memset(&png, 0, sizeof(png));
+    png.sink = sink;
+    for (int i = 0; i < 256; i++) png.palette[i] = 0xFF000000u;
+
+    // Signature already matched by the caller (8 bytes)
+    for (;;) {
+        int result = in_bytes(chunk, 8);
+        if (result != IMAGE_OK) return result;
+
+        uint32_t length = be32(chunk);
+        const uint8_t *type = chunk + 4;
+
+        if (memcmp(type, "IHDR", 4) == 0) {
+            if (length != 13) return IMAGE_ERR_CORRUPT;
+            if ((result = in_bytes(header, 13)) != IMAGE_OK) return result;
+
+            uint32_t width = be32(header);
+            uint32_t height = be32(header + 4);
+            png.depth = header[8];
+            png.color_type = header[9];
+            if (header[10] != 0 || header[11] != 0) return IMAGE_ERR_CORRUPT;
+            if (header[12] != 0) return IMAGE_ERR_UNSUPPORTED;     // Interlaced
+            if (width == 0 || height == 0) return IMAGE_ERR_CORRUPT;
+            if (width > IMAGE_MAX_WIDTH || height > IMAGE_MAX_HEIGHT) return IMAGE_ERR_TOO_LARGE;
+            if ((result = png_check_header()) != IMAGE_OK) return result;
+
+            png.width = (int)width;
+            png.height = (int)height;
+            int bits = png.width * channels[png.color_type] * png.depth;
+            png.stride = (bits + 7) / 8;
+            png.bpp = (channels[png.color_type] * png.depth + 7) / 8;
+            have_header = true;
+            if ((result = in_skip(4)) != IMAGE_OK) return result;
+        } else if (memcmp(type, "PLTE", 4) == 0) {
+            uint8_t rgb[3];
+            if (length % 3 != 0 || length > 768) return IMAGE_ERR_CORRUPT;
+            for (uint32_t i = 0; i < length / 3; i++) {
+                if ((result = in_bytes(rgb, 3)) != IMAGE_OK) return result;
+                png.palette[i] = 0xFF000000u | ((uint32_t)rgb[0] << 16) | ((uint32_t)rgb[1] << 8) | rgb[2];
+            }
+            if ((result = in_skip(4)) != IMAGE_OK) return result;
+        } else if (memcmp(type, "tRNS", 4) == 0 && png.color_type == 3) {
+            uint8_t alpha;
+            if (length > 256) return IMAGE_ERR_CORRUPT;
+            for (uint32_t i = 0; i < length; i++) {
+                if ((result = in_bytes(&alpha, 1)) != IMAGE_OK) return result;
+                png.palette[i] = (png.palette[i] & 0x00FFFFFFu) | ((uint32_t)alpha << 24);
+            }
+            if ((result = in_skip(4)) != IMAGE_OK) return result;
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            if (!have_header) return IMAGE_ERR_CORRUPT;
+            if (sink->begin && sink->begin(sink->ctx, png.width, png.height) != 0) {
+                return IMAGE_ERR_ABORTED;
+            }
+
+            memset(lines, 0, sizeof(lines));
+            png.cur = lines[0];
+            png.prev = lines[1];
+            png.filter = -1;
+            if (length > PNG_MAX_CHUNK) return IMAGE_ERR_CORRUPT;
+            png.chunk_left = length;
+            return inflate_start();
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            return IMAGE_ERR_CORRUPT;   // No image data
+        } else {
+            // Ancillary chunk we don't use (or tRNS for non-palette images).
+            // Skipping stops at the end of input, but a length past the PNG
+            // limit is corrupt on its face and must not wrap the CRC skip.
+            if (length > PNG_MAX_CHUNK) return IMAGE_ERR_CORRUPT;
+            if ((result = in_skip(length)) != IMAGE_OK) return result;
+            if ((result = in_skip(4)) != IMAGE_OK) return result;
+        }
+    }
+}
+
+// Decode about max_rows more rows
+static int png_rows(int max_rows) {
+    // The last band runs on to the end of the stream, so corrupt data after
+    // the final row still fails the image
+    int stop_row = png.height - png.y > max_rows ? png.y + max_rows : png.height + 1;
+    int result = inflate_run(stop_row);
+    if (result != IMAGE_OK) return result;
+    if (png.y < png.height) return IMAGE_ERR_IO;
+
+    // Everything after the image data (IEND, text, CRCs) is ignored
+    return IMAGE_OK;
+}
+
+// ---------------------------------------------------------------------------
+// BMP
+// ---------------------------------------------------------------------------
+
+static struct {
+    int width, height;
+    int bpp;
+    int stride;
+    bool top_down;
+    bool standard;          // Plain BGR(X) masks
+    uint32_t masks[4];
+    int shifts[4];
+    int r;                  // Next row in file order
+} bmp;
+
+static inline int mask_shift(uint32_t mask) {
+    return mask ? __builtin_ctz(mask) : 0;
+}
+
+// Expand a masked channel to 8 bits
+static inline uint32_t mask_channel(uint32_t v, uint32_t mask, int shift) {
+    if (!mask) return 0;
+    uint32_t max = mask >> shift;
+    return ((v & mask) >> shift) * 255 / max;
+}
+
+// Read the headers up to the pixel data
+static int bmp_begin(const image_sink_t *sink) {
+    uint8_t file_header[12];    // After the "BM" magic
+    uint8_t info[124];
+    int result;
+
+    if ((result = in_bytes(file_header, 12)) != IMAGE_OK) return result;
+    uint32_t data_offset = le32(file_header + 8);
+
+    if ((result = in_bytes(info, 4)) != IMAGE_OK) return result;
+    uint32_t info_size = le32(info);
+    if (info_size < 40 || info_size > sizeof(info)) return IMAGE_ERR_UNSUPPORTED;
+    if ((result = in_bytes(info + 4, (int)info_size - 4)) != IMAGE_OK) return result;
+    uint32_t consumed = 14 + info_size;
+
+    int32_t width = (int32_t)le32(info + 4);
+    int32_t height = (int32_t)le32(info + 8);
+    int bpp = le16(info + 14);
+    uint32_t compression = le32(info + 16);
+
+    bool top_down = height < 0;
+    if (top_down) height = -height;
+    if (width <= 0 || height == 0) return IMAGE_ERR_CORRUPT;
+    if (width > IMAGE_MAX_WIDTH || height > IMAGE_MAX_HEIGHT) return IMAGE_ERR_TOO_LARGE;
+    if (bpp != 24 && bpp != 32) return IMAGE_ERR_UNSUPPORTED;
+
+    // Channel masks: BI_RGB is fixed BGR(X); BI_BITFIELDS stores them
+    uint32_t *masks = bmp.masks;
+    masks[0] = 0x00FF0000u;
+    masks[1] = 0x0000FF00u;
+    masks[2] = 0x000000FFu;
+    masks[3] = 0;
+    if (compression == 3 && bpp == 32) {
+        if (info_size >= 52) {
+            masks[0] = le32(info + 40);
+            masks[1] = le32(info + 44);
+            masks[2] = le32(info + 48);
+            if (info_size >= 56) masks[3] = le32(info + 52);
+        } else {
+            uint8_t extra[12];
+            if ((result = in_bytes(extra, 12)) != IMAGE_OK) return result;
+            consumed += 12;
+            masks[0] = le32(extra);
+            masks[1] = le32(extra + 4);
+            masks[2] = le32(extra + 8);
+        }
+    } else if (compression != 0) {
+        return IMAGE_ERR_UNSUPPORTED;
+    }
+
+    if (data_offset < consumed) return IMAGE_ERR_CORRUPT;
+    if ((result = in_skip(data_offset - consumed)) != IMAGE_OK) return result;
+
+    if (sink->begin && sink->begin(sink->ctx, width, height) != 0) {
+        return IMAGE_ERR_ABORTED;
+    }
+
+    for (int i = 0; i < 4; i++) bmp.shifts[i] = mask_shift(masks[i]);
+    bmp.standard = masks[0] == 0x00FF0000u && masks[1] == 0x0000FF00u &&
+                   masks[2] == 0x000000FFu;
+    bmp.width = width;
+    bmp.height = height;
+    bmp.bpp = bpp;
+    bmp.top_down = top_down;
+    bmp.stride = ((width * bpp + 31) / 32) * 4;
+    bmp.r = 0;
+    return IMAGE_OK;
+}
+
+// Decode up to max_rows more rows
+static int bmp_rows(const image_sink_t *sink, int max_rows) {
+    const uint32_t *masks = bmp.masks;
+    const int *shifts = bmp.shifts;
+    int width = bmp.width;
+    uint8_t *line = lines[0];
+    int result;
+
+    int end = bmp.height - bmp.r > max_rows ? bmp.r + max_rows : bmp.height;
+    for (; bmp.r < end; bmp.r++) {
+        if ((result = in_bytes(line, bmp.stride)) != IMAGE_OK) return result;
+
+        if (bmp.bpp == 24) {
+            const uint8_t *s = line;
+            for (int x = 0; x < width; x++, s += 3) {
+                row_pixels[x] = 0xFF000000u | ((uint32_t)s[2] << 16) | ((uint32_t)s[1] << 8) | s[0];
+            }
+        } else if (bmp.standard) {
+            // Alpha only counts when a mask declares it
+            uint32_t alpha = masks[3] ? 0 : 0xFF000000u;
+            for (int x = 0; x < width; x++) {
+                row_pixels[x] = le32(line + x * 4) | alpha;
+            }
+        } else {
+            for (int x = 0; x < width; x++) {
+                uint32_t v = le32(line + x * 4);
+                uint32_t a = masks[3] ? mask_channel(v, masks[3], shifts[3]) : 0xFF;
+                row_pixels[x] = (a << 24) |
+                                (mask_channel(v, masks[0], shifts[0]) << 16) |
+                                (mask_channel(v, masks[1], shifts[1]) << 8) |
+                                mask_channel(v, masks[2], shifts[2]);
+            }
+        }
+
+        int y = bmp.top_down ? bmp.r : bmp.height - 1 - bmp.r;
+        sink->row(sink->ctx, y, row_pixels, width);
+    }
+    return bmp.r < bmp.height ? IMAGE_MORE : IMAGE_OK;
+}
+
+// ---------------------------------------------------------------------------
+
+// The image image_decode_rows() continues; sink is NULL when there is none
+static struct {
+    const image_sink_t *sink;
+    bool is_png;
+} job;
+
+int image_decode_begin(image_read_fn read, void *read_ctx, const image_sink_t *sink) {
+    static const uint8_t png_signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    uint8_t magic[8];
+    int result;
+
+    job.sink = NULL;
+    if (!read || !sink || !sink->row) return IMAGE_ERR_IO;
+
+    in.read = read;
+    in.ctx = read_ctx;
+    in.pos = 0;
+    in.len = 0;
+    in.eof = false;
+
+    if (in_bytes(magic, 2) != IMAGE_OK) return IMAGE_ERR_IO;
+    if (magic[0] == 'B' && magic[1] == 'M') {
+        job.is_png = false;
+        result = bmp_begin(sink);
+    } else {
+        if (in_bytes(magic + 2, 6) != IMAGE_OK) return IMAGE_ERR_IO;
+        if (memcmp(magic, png_signature, 8) != 0) return IMAGE_ERR_FORMAT;
+        job.is_png = true;
+        result = png_begin(sink);
+    }
+
+    if (result == IMAGE_OK) job.sink = sink;
+    return result;
+}
+
+int image_decode_rows(const image_sink_t *sink, int max_rows) {
+    if (!sink || sink != job.sink) return IMAGE_ERR_ABORTED;
+    if (max_rows < 1) max_rows = 1;
+
+    int result = job.is_png ? png_rows(max_rows) : bmp_rows(sink, max_rows);
+    if (result != IMAGE_MORE) job.sink = NULL;
+    return result;
+}
+
+int image_decode(image_read_fn read, void *read_ctx, const image_sink_t *sink) {
+    int result = image_decode_begin(read, read_ctx, sink);
+    if (result != IMAGE_OK) return result;
+    return image_decode_rows(sink, IMAGE_MAX_HEIGHT);
+}
+
+int image_memory_read(void *ctx, uint8_t *buf, int len) {
+    image_memory_reader_t *r = (image_memory_reader_t *)ctx;
+    size_t left = r->size - r->pos;
+    if ((size_t)len > left) len = (int)left;
+    memcpy(buf, r->data + r->pos, (size_t)len);
+    r->pos += (size_t)len;
+    return len;
+}
@@ -0,0 +1,57 @@
+#ifndef IMAGE_DECODER_H
+#define IMAGE_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Largest image the decoder accepts
+#define IMAGE_MAX_WIDTH   4096
+#define IMAGE_MAX_HEIGHT  4096
+
+// Decoder results
+#define IMAGE_OK                 0
+#define IMAGE_ERR_IO            -1   // Reader failed or data ended early
+#define IMAGE_ERR_FORMAT        -2   // Neither PNG nor BMP
+#define IMAGE_ERR_UNSUPPORTED   -3   // Valid file using a feature we don't decode
+#define IMAGE_ERR_TOO_LARGE     -4
+#define IMAGE_ERR_CORRUPT       -5
+#define IMAGE_ERR_ABORTED       -6   // Sink declined the image, or another decode took over
+#define IMAGE_MORE               1   // image_decode_rows(): rows remain
+
+// Pull up to len bytes of encoded data; returns bytes read, 0 at end, <0 on error
+typedef int (*image_read_fn)(void *ctx, uint8_t *buf, int len);
+
+// Receives decoded output. begin() is called once with the dimensions and
+// may return non-zero to abort. row() gets each row as 0xAARRGGBB; rows come
+// top-down for PNG and in file order (usually bottom-up) for BMP.
+typedef struct {
+    int (*begin)(void *ctx, int width, int height);
+    void (*row)(void *ctx, int y, const uint32_t *pixels, int width);
+    void *ctx;
+} image_sink_t;
+
+// Decode a PNG (8-bit and below, non-interlaced) or BMP (24/32-bit) stream.
+// Working memory is static and bounded - the 32 KB inflate window plus two
+// scanlines - so the whole image is never resident and calls are not reentrant.
+int image_decode(image_read_fn read, void *read_ctx, const image_sink_t *sink);
+
+// The same decode in bands, for callers that can't spend a whole image's
+// time at once. image_decode_begin() reads the headers and calls begin();
+// each image_decode_rows() then delivers about max_rows rows (a PNG band can
+// run a few rows over), returning IMAGE_MORE until the last. The reader must
+// stay valid in between. The state is the same static state image_decode()
+// uses: starting any other decode ends this one, and its next
+// image_decode_rows() returns IMAGE_ERR_ABORTED.
+int image_decode_begin(image_read_fn read, void *read_ctx, const image_sink_t *sink);
+int image_decode_rows(const image_sink_t *sink, int max_rows);
+
+// Reader over an in-memory buffer
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+} image_memory_reader_t;
+
+int image_memory_read(void *ctx, uint8_t *buf, int len);
+
+#endif // IMAGE_DECODER_H
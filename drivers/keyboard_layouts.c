@@ -0,0 +1,117 @@
+// keyboard_layouts.c - virtual keyboard layouts, described as text
+#include "keyboard_layouts.h"
+#include <string.h>
+
+static const char *const layout_specs[KB_LAYOUT_COUNT] = {
+    [KB_LAYOUT_QWERTY] =
+        "Q W E R T Y U I O P\n"
+        "A S D F G H J K L\n"
+        "Z X C V B N M bksp*3\n"
+        "sym*3 , space*10 . enter*3\n",
+    [KB_LAYOUT_SYMBOLS] =
+        "1 2 3 4 5 6 7 8 9 0\n"
+        "@ # $ % & - + ( )\n"
+        "* \" ' : ; ! ? bksp*3\n"
+        "abc*3 / space*10 = enter*3\n",
+    [KB_LAYOUT_NUMERIC] =
+        "1*4 2*4 3*4 bksp*4\n"
+        "4*4 5*4 6*4 enter*4\n"
+        "7*4 8*4 9*4 .*4\n"
+        "abc*4 0*8 ,*4\n",
+};
+
+// Keys that don't type their own name
+typedef struct {
+    const char *name;
+    char code;
+    const char *label;
+} kb_special_t;
+
+static const kb_special_t specials[] = {
+    { "space", ' ',                                 "space" },
+    { "bksp",  KB_KEY_BACKSPACE,                    "<-" },
+    { "enter", KB_KEY_ENTER,                        "enter" },
+    { "abc",   KB_KEY_LAYOUT + KB_LAYOUT_QWERTY,    "ABC" },
+    { "sym",   KB_KEY_LAYOUT + KB_LAYOUT_SYMBOLS,   "?123" },
+    { "num",   KB_KEY_LAYOUT + KB_LAYOUT_NUMERIC,   "123" },
+};
+
+#define SPECIAL_COUNT ((int)(sizeof(specials) / sizeof(specials[0])))
+
+const char *keyboard_layout_spec(keyboard_layout_id_t id) {
+    if ((unsigned)id >= KB_LAYOUT_COUNT) return NULL;
+    return layout_specs[id];
+}
+
+// Fill in code and label for the key named by name[0..len)
+static bool name_key(const char *name, int len, kb_key_def_t *key) {
+    if (len == 1) {
+        key->code = name[0];
+        key->label[0] = name[0];
+        key->label[1] = '\0';
+        return true;
+    }
+    for (int i = 0; i < SPECIAL_COUNT; i++) {
+        if ((int)strlen(specials[i].name) == len && memcmp(specials[i].name, name, len) == 0) {
+            key->code = specials[i].code;
+            memcpy(key->label, specials[i].label, strlen(specials[i].label) + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool keyboard_layout_parse(const char *spec, kb_layout_t *out) {
+    out->rows = 0;
+    out->count = 0;
+    if (!spec) return false;
+
+    const char *p = spec;
+    while (*p) {
+        if (out->rows >= KB_MAX_ROWS) return false;
+        int row = out->rows;
+        int units = 0;
+
+        while (*p && *p != '\n') {
+            if (*p == ' ') {
+                p++;
+                continue;
+            }
+
+            // A token runs to the next space or newline; a lone '*' is a key
+            const char *start = p;
+            while (*p && *p != ' ' && *p != '\n') p++;
+            const char *star = start + 1;
+            while (star < p && *star != '*') star++;
+
+            if (out->count >= KB_MAX_KEYS) return false;
+            kb_key_def_t *key = &out->keys[out->count];
+            if (!name_key(start, (int)(star - start), key)) return false;
+
+            key->row = (uint8_t)row;
+            key->units = KB_LETTER_UNITS;
+            if (star < p) {
+                int width = 0;
+                for (const char *d = star + 1; d < p; d++) {
+                    if (*d < '0' || *d > '9') return false;
+                    width = width * 10 + (*d - '0');
+                    if (width > KB_MAX_ROW_UNITS) return false;
+                }
+                if (width == 0) return false;
+                key->units = (uint8_t)width;
+            }
+
+            units += key->units;
+            if (units > KB_MAX_ROW_UNITS) return false;
+            out->count++;
+        }
+        if (*p == '\n') p++;
+
+        // Blank lines don't make rows
+        if (units > 0) {
+            out->row_units[row] = (uint8_t)units;
+            out->rows++;
+        }
+    }
+    return out->count > 0;
+}
@@ -0,0 +1,51 @@
+#ifndef KEYBOARD_LAYOUTS_H
+#define KEYBOARD_LAYOUTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Layout limits; widths are in units, a letter key is KB_LETTER_UNITS wide
+#define KB_MAX_ROWS       5
+#define KB_MAX_KEYS       48
+#define KB_MAX_ROW_UNITS  24
+#define KB_LETTER_UNITS   2
+#define KB_LABEL_MAX      8
+
+// Key codes besides printable characters
+#define KB_KEY_BACKSPACE  '\b'
+#define KB_KEY_ENTER      '\n'
+#define KB_KEY_LAYOUT     0x10      // KB_KEY_LAYOUT + id switches to layout id
+
+typedef enum {
+    KB_LAYOUT_QWERTY,
+    KB_LAYOUT_SYMBOLS,
+    KB_LAYOUT_NUMERIC,
+    KB_LAYOUT_COUNT
+} keyboard_layout_id_t;
+
+#define KB_IS_LAYOUT_KEY(code) ((code) >= KB_KEY_LAYOUT && (code) < KB_KEY_LAYOUT + KB_LAYOUT_COUNT)
+
+typedef struct {
+    char code;                      // What the key types, or a KB_KEY_* code
+    uint8_t row;
+    uint8_t units;                  // Width
+    char label[KB_LABEL_MAX];       // Printed on the cap
+} kb_key_def_t;
+
+typedef struct {
+    int rows;
+    int count;
+    uint8_t row_units[KB_MAX_ROWS]; // Total width of each row
+    kb_key_def_t keys[KB_MAX_KEYS]; // Row by row, left to right
+} kb_layout_t;
+
+// Text description of a built-in layout, or NULL
+const char *keyboard_layout_spec(keyboard_layout_id_t id);
+
+// Parse a layout description: one row per line, keys separated by spaces.
+// A one-character key types that character; longer names are special keys
+// (space, bksp, enter, abc, sym, num). Either may end in *units to set its
+// width. Returns false, leaving out unusable, if the description is malformed.
+bool keyboard_layout_parse(const char *spec, kb_layout_t *out);
+
+#endif // KEYBOARD_LAYOUTS_H
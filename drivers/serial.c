@@ -0,0 +1,57 @@
+// serial.c - buffered, non-blocking 16550 UART output
+#include "serial.h"
+#include "../kernel/io.h"
+
+// Register offsets from the base port
+#define UART_DATA       0
+#define UART_IER        1
+#define UART_FCR        2
+#define UART_LCR        3
+#define UART_MCR        4
+#define UART_LSR        5
+#define UART_SCRATCH    7
+
+#define LSR_THR_EMPTY   0x20
+#define UART_FIFO_BYTES 16
+
+// One transmit queue; output goes to whichever port was initialised last
+static char tx_buffer[SERIAL_TX_BUFFER];
+static uint32_t tx_head = 0;
+static uint32_t tx_tail = 0;
+static uint16_t tx_port = 0;
+
+bool serial_init(uint16_t port) {
+    // No UART if the scratch register doesn't hold a value
+    outb(port + UART_SCRATCH, 0x5A);
+    if (inb(port + UART_SCRATCH) != 0x5A) return false;
+
+    outb(port + UART_IER, 0x00);        // Polled, no interrupts
+    outb(port + UART_LCR, 0x80);        // Divisor latch on
+    outb(port + UART_DATA, 0x01);       // 115200 baud
+    outb(port + UART_IER, 0x00);
+    outb(port + UART_LCR, 0x03);        // 8N1, latch off
+    outb(port + UART_FCR, 0xC7);        // Enable and clear FIFOs
+    outb(port + UART_MCR, 0x03);        // DTR + RTS
+
+    tx_head = tx_tail = 0;
+    tx_port = port;
+    return true;
+}
+
+void serial_write(uint16_t port, const char *s) {
+    if (port != tx_port) return;
+    while (*s && tx_head - tx_tail < SERIAL_TX_BUFFER) {
+        tx_buffer[tx_head++ % SERIAL_TX_BUFFER] = *s++;
+    }
+    serial_pump();
+}
+
+void serial_pump(void) {
+    if (!tx_port || tx_head == tx_tail) return;
+
+    // An empty holding register means the whole FIFO can be refilled
+    if (!(inb(tx_port + UART_LSR) & LSR_THR_EMPTY)) return;
+    for (int i = 0; i < UART_FIFO_BYTES && tx_tail != tx_head; i++) {
+        outb(tx_port + UART_DATA, (uint8_t)tx_buffer[tx_tail++ % SERIAL_TX_BUFFER]);
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 16550 UART base ports
+#define SERIAL_COM1 0x3F8
+#define SERIAL_COM2 0x2F8
+
+// Bytes buffered for transmission; writes beyond this are dropped
+#define SERIAL_TX_BUFFER 4096
+
+// Program the UART for 115200 8N1 with FIFOs; false if no UART answers
+bool serial_init(uint16_t port);
+
+// Queue a string for transmission. Never waits for the UART; call
+// serial_pump() (e.g. once per frame) to move queued bytes out.
+void serial_write(uint16_t port, const char *s);
+
+// Feed the UART FIFO from the queue without blocking
+void serial_pump(void);
+
+#endif // SERIAL_H
@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "tile_raster.h"
+#include "../kernel/io.h"
+
+#define BIN_WORDS (DL_MAX_COMMANDS / 32)
+
+// Per-tile bitmask of commands touching it; bit order is paint order
+static uint32_t tile_bins[TILE_COUNT][BIN_WORDS];
+static uint16_t job_tiles[TILE_COUNT];
+
+// Frame currently published to the workers
+static struct {
+    const display_list_t *dl;
+    const dl_frame_t *frame;
+    clip_rect_t region;
+    int tile_count;
+} job;
+
+static volatile int job_active = 0;
+static volatile int next_tile = 0;
+static volatile int tiles_done = 0;
+static volatile int busy_workers = 0;
+static int worker_count = 0;
+
+static tile_raster_stats_t stats;
+
+void tile_raster_init(void) {
+    memset(tile_bins, 0, sizeof(tile_bins));
+    memset(&stats, 0, sizeof(stats));
+    memset(&job, 0, sizeof(job));
+    job_active = 0;
+    next_tile = 0;
+    tiles_done = 0;
+    worker_count = 0;
+}
+
+// Cores can register concurrently: claim the next id only if it is still free
+int tile_raster_add_worker(void) {
+    int count = __atomic_load_n(&worker_count, __ATOMIC_SEQ_CST);
+    do {
+        if (count >= TILE_MAX_WORKERS) return -1;
+    } while (!__atomic_compare_exchange_n(&worker_count, &count, count + 1, false,
+                                          __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+    return count + 1;
+}
+
+int tile_raster_worker_count(void) {
+    return worker_count;
+}
+
+// Rasterize one tile: clear it, then replay its binned commands in order
+static void render_tile(int tile) {
+    int tx = tile % TILE_COLS;
+    int ty = tile / TILE_COLS;
+    clip_rect_t clip = { tx * TILE_SIZE, ty * TILE_SIZE,
+                         tx * TILE_SIZE + TILE_SIZE, ty * TILE_SIZE + TILE_SIZE };
+    if (!intersect_clip_rect(&clip, &job.region)) return;
+
+    dl_erase(job.dl, &clip);
+
+    const uint32_t *bin = tile_bins[tile];
+    for (int w = 0; w < BIN_WORDS; w++) {
+        uint32_t bits = bin[w];
+        while (bits) {
+            int bit = __builtin_ctz(bits);
+            bits &= bits - 1;
+            dl_replay_command(job.frame, w * 32 + bit, &clip);
+        }
+    }
+}
+
+// Pull tiles off the shared counter until none are left
+static int drain_tiles(void) {
+    int rendered = 0;
+    for (;;) {
+        int index = __atomic_fetch_add(&next_tile, 1, __ATOMIC_ACQ_REL);
+        if (index >= job.tile_count) break;
+        render_tile(job_tiles[index]);
+        rendered++;
+        __atomic_add_fetch(&tiles_done, 1, __ATOMIC_RELEASE);
+    }
+    return rendered;
+}
+
+bool tile_raster_worker_poll(int worker_id) {
+    int rendered = 0;
+
+    // Idle workers stay off busy_workers, or the boot CPU could wait on them
+    // forever before publishing
+    if (!__atomic_load_n(&job_active, __ATOMIC_ACQUIRE)) return false;
+
+    // While busy, the boot CPU will not rewrite the job under us
+    __atomic_add_fetch(&busy_workers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&job_active, __ATOMIC_SEQ_CST)) {
+        rendered = drain_tiles();
+        if (worker_id > 0 && worker_id <= TILE_MAX_WORKERS) {
+            __atomic_add_fetch(&stats.tiles_by_worker[worker_id], rendered, __ATOMIC_RELAXED);
+        }
+    }
+    __atomic_sub_fetch(&busy_workers, 1, __ATOMIC_SEQ_CST);
+
+    return rendered > 0;
+}
+
+// Drop each command into every tile its bounds overlap
+static void bin_commands(const dl_frame_t *frame, int tx0, int ty0, int tx1, int ty1) {
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            memset(tile_bins[ty * TILE_COLS + tx], 0, sizeof(tile_bins[0]));
+        }
+    }
+
+    for (int i = 0; i < frame->count; i++) {
+        clip_rect_t b = frame->cmds[i].bounds;
+        if (!intersect_clip_rect(&b, &job.region)) continue;
+
+        int cx0 = b.x0 / TILE_SIZE, cx1 = (b.x1 - 1) / TILE_SIZE;
+        int cy0 = b.y0 / TILE_SIZE, cy1 = (b.y1 - 1) / TILE_SIZE;
+        for (int ty = cy0; ty <= cy1; ty++) {
+            for (int tx = cx0; tx <= cx1; tx++) {
+                tile_bins[ty * TILE_COLS + tx][i >> 5] |= 1u << (i & 31);
+                stats.binned_commands++;
+            }
+        }
+    }
+}
+
+void tile_raster_render(const display_list_t *dl, const clip_rect_t *region) {
+    const dl_frame_t *frame = &dl->frames[dl->current];
+    clip_rect_t r = *region;
+    if (!intersect_clip_rect(&r, get_clip_rect())) return;
+
+    // Workers must be out of the previous job before it is rewritten
+    while (__atomic_load_n(&busy_workers, __ATOMIC_SEQ_CST) != 0) {
+        cpu_relax();
+    }
+
+    int tx0 = r.x0 / TILE_SIZE, tx1 = (r.x1 - 1) / TILE_SIZE;
+    int ty0 = r.y0 / TILE_SIZE, ty1 = (r.y1 - 1) / TILE_SIZE;
+
+    job.dl = dl;
+    job.frame = frame;
+    job.region = r;
+    job.tile_count = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    bin_commands(frame, tx0, ty0, tx1, ty1);
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            job_tiles[job.tile_count++] = (uint16_t)(ty * TILE_COLS + tx);
+        }
+    }
+    stats.tiles = job.tile_count;
+
+    // Publish
+    __atomic_store_n(&tiles_done, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&next_tile, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&job_active, 1, __ATOMIC_SEQ_CST);
+
+    // The boot CPU works too; with no workers registered it renders every tile
+    stats.tiles_by_worker[0] = drain_tiles();
+
+    // Join before the frame is presented
+    while (__atomic_load_n(&tiles_done, __ATOMIC_ACQUIRE) < job.tile_count) {
+        cpu_relax();
+    }
+    __atomic_store_n(&job_active, 0, __ATOMIC_SEQ_CST);
+}
+
+void tile_raster_get_stats(tile_raster_stats_t *out) {
+    *out = stats;
+}
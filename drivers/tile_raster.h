@@ -0,0 +1,45 @@
+#ifndef TILE_RASTER_H
+#define TILE_RASTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "display4k.h"
+#include "display_list.h"
+
+// Screen tiling used to split a display list across cores
+#define TILE_SIZE          128
+#define TILE_COLS          ((SCREEN_WIDTH + TILE_SIZE - 1) / TILE_SIZE)
+#define TILE_ROWS          ((SCREEN_HEIGHT + TILE_SIZE - 1) / TILE_SIZE)
+#define TILE_COUNT         (TILE_COLS * TILE_ROWS)
+#define TILE_MAX_WORKERS   8
+
+// Damage at least this large is rasterized through the tile path
+#define TILE_RASTER_MIN_AREA   (SCREEN_WIDTH * SCREEN_HEIGHT / 4)
+
+// Counters from the last tiled render
+typedef struct {
+    uint32_t tiles;             // Tiles touched by the region
+    uint32_t binned_commands;   // Sum of commands over all tiles
+    uint32_t tiles_by_worker[TILE_MAX_WORKERS + 1];  // Slot 0 is the boot CPU
+} tile_raster_stats_t;
+
+// Resets the tile state and forgets registered workers; call before any
+// worker core starts
+void tile_raster_init(void);
+
+// Register a worker core; returns its id (1..TILE_MAX_WORKERS) or -1 if full.
+// The core must then call tile_raster_worker_poll() in its idle loop.
+int tile_raster_add_worker(void);
+int tile_raster_worker_count(void);
+
+// Help with the published frame, if any. Returns true if tiles were rasterized.
+bool tile_raster_worker_poll(int worker_id);
+
+// Erase `region` to the list's background and replay its current frame into
+// it tile by tile. The calling core rasterizes alongside the workers and
+// returns only after every tile is finished, so the framebuffer is complete.
+void tile_raster_render(const display_list_t *dl, const clip_rect_t *region);
+
+void tile_raster_get_stats(tile_raster_stats_t *stats);
+
+#endif // TILE_RASTER_H
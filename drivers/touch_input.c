@@ -1,16 +1,43 @@
 #include "touch_input.h"
+#include "display4k.h"
+#include "../kernel/timer.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+
+#define QUEUE_MASK (TOUCH_QUEUE_SIZE - 1)
+
+// Keep the compiler from moving queue stores across the index update. x86
+// doesn't reorder stores with other stores, so this is all a single core needs.
+#define queue_barrier() __asm__ volatile ("" ::: "memory")
 
 // Internal simulated touch storage
 static TouchEvent current_touch = { 0, 0, 0 };
 
+// Lock-free ring: head is only written by the producer (IRQ), tail only by
+// the consumer (UI). Both count up freely and wrap; the slot is index & mask.
+static touch_sample_t queue[TOUCH_QUEUE_SIZE];
+static volatile uint32_t queue_head = 0;
+static volatile uint32_t queue_tail = 0;
+
+// Last event queued per contact, for dropping moves that go nowhere
+static touch_sample_t last_pushed[TOUCH_MAX_CONTACTS];
+
+static touch_queue_stats_t stats;
+
 // Initialize touch input system
 void init_touch_input() {
     // In real hardware: initialize touch controller (I2C, SPI, etc.)
     current_touch.x = 0;
     current_touch.y = 0;
     current_touch.is_pressed = 0;
+
+    queue_head = 0;
+    queue_tail = 0;
+    for (int i = 0; i < TOUCH_MAX_CONTACTS; i++) {
+        last_pushed[i].type = TOUCH_UP;
+    }
+    stats = (touch_queue_stats_t){ 0 };
 }
 
 // Read touch event (in real device: from hardware)
@@ -19,11 +46,114 @@ TouchEvent get_touch_event() {
     return current_touch;
 }
 
+// Queue one contact change with its timestamp (IRQ context)
+void touch_clamp_to_screen(int *x, int *y) {
+    if (*x < 0) *x = 0;
+    if (*x >= SCREEN_WIDTH) *x = SCREEN_WIDTH - 1;
+    if (*y < 0) *y = 0;
+    if (*y >= SCREEN_HEIGHT) *y = SCREEN_HEIGHT - 1;
+}
+
+bool touch_input_irq_push(uint8_t id, touch_event_t type, int x, int y) {
+    if (id >= TOUCH_MAX_CONTACTS) return false;
+    touch_clamp_to_screen(&x, &y);
+
+    touch_sample_t *last = &last_pushed[id];
+    if (type == TOUCH_MOVE && last->type != TOUCH_UP && last->x == x && last->y == y) {
+        stats.duplicates++;
+        return true;
+    }
+
+    // Pollers see the primary contact even when the queue is full
+    if (id == 0) {
+        current_touch.x = x;
+        current_touch.y = y;
+        current_touch.is_pressed = type != TOUCH_UP;
+    }
+
+    uint32_t head = queue_head;
+    if (head - queue_tail >= TOUCH_QUEUE_SIZE) {
+        stats.overflows++;
+        return false;
+    }
+
+    touch_sample_t *slot = &queue[head & QUEUE_MASK];
+    slot->time_us = timer_now_us();
+    slot->x = (int16_t)x;
+    slot->y = (int16_t)y;
+    slot->id = id;
+    slot->type = type;
+    *last = *slot;
+
+    // Publish the slot only once it's filled in
+    queue_barrier();
+    queue_head = head + 1;
+    stats.pushed++;
+    return true;
+}
+
+// Pop queued events, merging each contact's moves into its latest (UI context)
+int touch_input_drain(touch_sample_t *out, int max) {
+    uint32_t tail = queue_tail;
+    uint32_t head = queue_head;
+    queue_barrier();
+
+    if (head - tail > stats.max_depth) {
+        stats.max_depth = head - tail;
+    }
+
+    // Slot in out holding each contact's pending move, or -1. A press or
+    // release clears them all, so a move is never pulled ahead of one.
+    int pending_move[TOUCH_MAX_CONTACTS];
+    for (int i = 0; i < TOUCH_MAX_CONTACTS; i++) {
+        pending_move[i] = -1;
+    }
+
+    int count = 0;
+    while (tail != head) {
+        const touch_sample_t *ev = &queue[tail & QUEUE_MASK];
+
+        if (ev->type == TOUCH_MOVE && pending_move[ev->id] >= 0) {
+            // Only the newest position of a drag matters to the UI, even
+            // when other fingers' moves were queued in between
+            out[pending_move[ev->id]] = *ev;
+            stats.coalesced++;
+        } else if (count < max) {
+            if (ev->type == TOUCH_MOVE) {
+                pending_move[ev->id] = count;
+            } else {
+                for (int i = 0; i < TOUCH_MAX_CONTACTS; i++) {
+                    pending_move[i] = -1;
+                }
+            }
+            out[count++] = *ev;
+        } else {
+            break;
+        }
+        tail++;
+    }
+
+    // Hand the slots back to the producer only after they've been copied
+    queue_barrier();
+    queue_tail = tail;
+    return count;
+}
+
+int touch_input_pending(void) {
+    return (int)(queue_head - queue_tail);
+}
+
+void touch_input_get_stats(touch_queue_stats_t *out) {
+    *out = stats;
+}
+
 // Simulate touch event manually (for QEMU or keyboard-based testing)
 void set_simulated_touch(int x, int y, int is_pressed) {
-    current_touch.x = x;
-    current_touch.y = y;
-    current_touch.is_pressed = is_pressed;
+    if (is_pressed) {
+        touch_input_irq_push(0, current_touch.is_pressed ? TOUCH_MOVE : TOUCH_DOWN, x, y);
+    } else if (current_touch.is_pressed) {
+        touch_input_irq_push(0, TOUCH_UP, x, y);
+    }
 }
 
 // ✅ MISSING FUNCTION IMPLEMENTATION
@@ -35,4 +165,4 @@ bool get_touch_input(int *x, int *y) {
         return true;
     }
     return false;
-}
\ No newline at end of file
+}
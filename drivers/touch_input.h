@@ -1,7 +1,14 @@
 #ifndef TOUCH_INPUT_H
 #define TOUCH_INPUT_H
 
+#include <stdint.h>
 #include <stdbool.h>  // ✅ Add this for 'bool' type support
+#include "../input/touch.h"
+
+// Events queued between IRQ and UI; must be a power of two
+#define TOUCH_QUEUE_SIZE    128
+// Simultaneous contacts tracked (ids 0..TOUCH_MAX_CONTACTS-1)
+#define TOUCH_MAX_CONTACTS  5
 
 // Simple touch event structure
 typedef struct {
@@ -10,6 +17,14 @@ typedef struct {
     int is_pressed; // 1 = touch pressed, 0 = released
 } TouchEvent;
 
+typedef struct {
+    uint32_t pushed;        // Events queued by the IRQ side
+    uint32_t duplicates;    // Moves dropped because the contact hadn't moved
+    uint32_t coalesced;     // Moves merged into a later one while draining
+    uint32_t overflows;     // Events lost because the queue was full
+    uint32_t max_depth;     // Deepest the queue has been at drain time
+} touch_queue_stats_t;
+
 // Initialize the touch input system
 void init_touch_input();
 
@@ -22,4 +37,26 @@ void set_simulated_touch(int x, int y, int is_pressed);
 // ✅ ADD THIS FUNCTION PROTOTYPE
 bool get_touch_input(int *x, int *y);
 
+// Producer side, called from the touch controller IRQ handler (single
+// producer). Timestamps the event and clamps it to the screen; a move to
+// where the contact already is is dropped. Returns false if the event was
+// lost to a full queue.
+bool touch_input_irq_push(uint8_t id, touch_event_t type, int x, int y);
+
+// Pull a point reported past the edge of the screen back onto it. A finger
+// sliding off the glass is reported outside it, and its lift has to count.
+void touch_clamp_to_screen(int *x, int *y);
+
+// Consumer side, called from the UI thread only (single consumer). Copies up
+// to max queued events into out, oldest first. Each contact's moves are merged
+// into its latest one up to the next press or release of any contact, so
+// moves of other contacts may come out ahead of a merged move's timestamp.
+// Returns the number copied.
+int touch_input_drain(touch_sample_t *out, int max);
+
+// Events waiting to be drained
+int touch_input_pending(void);
+
+void touch_input_get_stats(touch_queue_stats_t *stats);
+
 #endif // TOUCH_INPUT_H
@@ -1,57 +1,224 @@
 #include <stdint.h>
+#include <string.h>
 #include "display4k.h"
 #include "virtual_keyboard.h"
 #include "touch_input.h"
+#include "hit_grid.h"
 
-// Virtual key layout (simple grid example)
+// Key geometry: a unit is half a letter key plus its share of the gap
+#define KB_UNIT_PX        75
+#define KB_KEY_GAP        50
+#define KB_KEY_HEIGHT     100
+#define KB_ROW_PITCH      120
+#define KB_LEFT           100
+#define KB_BOTTOM         2140      // Bottom edge of the last row
+#define KB_PANEL_PAD      20
+#define KB_CAP_RADIUS     12
+
+#define KB_PANEL_COLOR    0x1A1A1A
+#define KB_CAP_COLOR      0x333333
+#define KB_FUNC_CAP_COLOR 0x262626  // Keys that don't type a character
+#define KB_PRESSED_COLOR  0x007AFF
+#define KB_LABEL_COLOR    0xFFFFFF
+
+// Widest key, and every cap of the fullest layout side by side
+#define KB_MAX_CAP_PIXELS (KB_MAX_ROW_UNITS * KB_UNIT_PX * KB_KEY_HEIGHT)
+#define KB_CAP_PIXELS     (KB_MAX_ROWS * KB_MAX_CAP_PIXELS)
+
+// Keys are about 100px wide; 64px cells put each touch next to one or two
+#define KEY_HIT_CELL_SHIFT 6
+
+// A key of the active layout, placed on screen
 struct VirtualKey {
-    char label;
+    char label;                     // Key code
     int x, y, width, height;
+    uint32_t cap;                   // Offset of its cap in cap_pixels
+    const char *text;               // Printed on the cap
 };
 
-struct VirtualKey keys[] = {
-    { 'A', 100, 1800, 100, 100 },
-    { 'B', 250, 1800, 100, 100 },
-    { 'C', 400, 1800, 100, 100 },
-    { 'D', 550, 1800, 100, 100 },
-    { 'E', 700, 1800, 100, 100 },
-    { 'F', 850, 1800, 100, 100 },
-    { 'G', 1000, 1800, 100, 100 },
-    { 'H', 1150, 1800, 100, 100 },
-    { 'I', 1300, 1800, 100, 100 },
-    { 'J', 1450, 1800, 100, 100 },
-    // Second row
-    { 'K', 100, 1920, 100, 100 },
-    { 'L', 250, 1920, 100, 100 },
-    { 'M', 400, 1920, 100, 100 },
-    { 'N', 550, 1920, 100, 100 },
-    { 'O', 700, 1920, 100, 100 },
-    { 'P', 850, 1920, 100, 100 },
-    { 'Q', 1000, 1920, 100, 100 },
-    { 'R', 1150, 1920, 100, 100 },
-    { 'S', 1300, 1920, 100, 100 },
-    { 'T', 1450, 1920, 100, 100 },
-    // Third row
-    { 'U', 100, 2040, 100, 100 },
-    { 'V', 250, 2040, 100, 100 },
-    { 'W', 400, 2040, 100, 100 },
-    { 'X', 550, 2040, 100, 100 },
-    { 'Y', 700, 2040, 100, 100 },
-    { 'Z', 850, 2040, 100, 100 },
-    { ' ', 1000, 2040, 300, 100 }, // Space bar
-};
-
-#define NUM_KEYS (sizeof(keys) / sizeof(keys[0]))
-
 // Static variables for keyboard state
 static bool keyboard_initialized = false;
+static bool keyboard_visible = false;
 static char last_pressed_key = 0;
+static hit_grid_t key_hits;
+
+static keyboard_layout_id_t layout_id = KB_LAYOUT_QWERTY;
+static kb_layout_t layout;
+static struct VirtualKey keys[KB_MAX_KEYS];
+static int num_keys = 0;
+static clip_rect_t panel;
+static int pressed_key = -1;
+
+// Every cap of the layout rendered once, each packed at its own width so a
+// key repaints with one draw_image(); the pressed look is rendered on demand
+static uint32_t cap_pixels[KB_CAP_PIXELS];
+static uint32_t pressed_cap[KB_MAX_CAP_PIXELS];
+
+static int isqrt(int n) {
+    int root = 0;
+    while ((root + 1) * (root + 1) <= n) root++;
+    return root;
+}
+
+static bool is_function_key(char code) {
+    return (unsigned char)code < ' ';
+}
+
+// Render one cap into a width x height image: rounded body on the panel
+// color, label centered at the largest scale that fits
+static void render_cap(uint32_t *dst, int width, int height, const char *text, uint32_t body) {
+    for (int y = 0; y < height; y++) {
+        int edge = y < KB_CAP_RADIUS ? KB_CAP_RADIUS - 1 - y :
+                   y >= height - KB_CAP_RADIUS ? y - (height - KB_CAP_RADIUS) : -1;
+        int inset = edge < 0 ? 0 : KB_CAP_RADIUS - isqrt(KB_CAP_RADIUS * KB_CAP_RADIUS - edge * edge);
+        uint32_t *row = &dst[y * width];
+        memset32(row, KB_PANEL_COLOR, inset);
+        memset32(row + inset, body, width - 2 * inset);
+        memset32(row + width - inset, KB_PANEL_COLOR, inset);
+    }
+
+    int len = (int)strlen(text);
+    if (len == 0) return;
+    int scale = len == 1 ? 4 : 3;
+    int text_w = (len * FONT_CHAR_ADVANCE - (FONT_CHAR_ADVANCE - FONT_GLYPH_WIDTH)) * scale;
+    while (scale > 1 && (text_w > width || FONT_GLYPH_HEIGHT * scale > height)) {
+        scale--;
+        text_w = (len * FONT_CHAR_ADVANCE - (FONT_CHAR_ADVANCE - FONT_GLYPH_WIDTH)) * scale;
+    }
+    int x0 = (width - text_w) / 2;
+    int y0 = (height - FONT_GLYPH_HEIGHT * scale) / 2;
+
+    for (int i = 0; i < len; i++) {
+        const unsigned char *glyph = get_font_glyph(text[i]);
+        if (!glyph) continue;
+        int gx = x0 + i * FONT_CHAR_ADVANCE * scale;
+        for (int gy = 0; gy < FONT_GLYPH_HEIGHT * scale; gy++) {
+            int y = y0 + gy;
+            unsigned char bits = glyph[gy / scale];
+            if (!bits || y < 0 || y >= height) continue;
+            for (int col = 0; col < FONT_GLYPH_WIDTH; col++) {
+                if (!(bits & (0x80 >> col))) continue;
+                int x = gx + col * scale;
+                int x1 = x + scale;
+                if (x < 0) x = 0;
+                if (x1 > width) x1 = width;
+                if (x < x1) memset32(&dst[y * width + x], KB_LABEL_COLOR, x1 - x);
+            }
+        }
+    }
+}
+
+static uint32_t cap_color(const struct VirtualKey *key) {
+    return is_function_key(key->label) ? KB_FUNC_CAP_COLOR : KB_CAP_COLOR;
+}
+
+// Place the parsed layout's keys, centering each row under the widest one
+static void place_keys() {
+    int max_units = 0;
+    for (int r = 0; r < layout.rows; r++) {
+        if (layout.row_units[r] > max_units) max_units = layout.row_units[r];
+    }
+
+    int top = KB_BOTTOM - (layout.rows - 1) * KB_ROW_PITCH - KB_KEY_HEIGHT;
+    uint32_t cap = 0;
+    int row_x = 0, row = -1;
+    num_keys = layout.count;
+    for (int i = 0; i < num_keys; i++) {
+        const kb_key_def_t *def = &layout.keys[i];
+        if (def->row != row) {
+            row = def->row;
+            row_x = KB_LEFT + (max_units - layout.row_units[row]) * KB_UNIT_PX / 2;
+        }
+
+        struct VirtualKey *key = &keys[i];
+        key->label = def->code;
+        key->text = def->label;
+        key->x = row_x;
+        key->y = top + row * KB_ROW_PITCH;
+        key->width = def->units * KB_UNIT_PX - KB_KEY_GAP;
+        key->height = KB_KEY_HEIGHT;
+        key->cap = cap;
+        cap += (uint32_t)(key->width * key->height);
+        row_x += def->units * KB_UNIT_PX;
+    }
+
+    panel.x0 = KB_LEFT - KB_PANEL_PAD;
+    panel.y0 = top - KB_PANEL_PAD;
+    panel.x1 = KB_LEFT + max_units * KB_UNIT_PX - KB_KEY_GAP + KB_PANEL_PAD;
+    panel.y1 = KB_BOTTOM + KB_PANEL_PAD;
+}
+
+static void render_caps() {
+    for (int i = 0; i < num_keys; i++) {
+        render_cap(&cap_pixels[keys[i].cap], keys[i].width, keys[i].height, keys[i].text, cap_color(&keys[i]));
+    }
+}
+
+// Index the layout for hit-testing; needed again whenever keys[] changes
+static void rebuild_key_index() {
+    int x0 = keys[0].x, y0 = keys[0].y;
+    int x1 = x0, y1 = y0;
+    for (int i = 0; i < num_keys; i++) {
+        if (keys[i].x < x0) x0 = keys[i].x;
+        if (keys[i].y < y0) y0 = keys[i].y;
+        if (keys[i].x + keys[i].width > x1) x1 = keys[i].x + keys[i].width;
+        if (keys[i].y + keys[i].height > y1) y1 = keys[i].y + keys[i].height;
+    }
+
+    hit_grid_begin(&key_hits, x0, y0, x1 - x0, y1 - y0, KEY_HIT_CELL_SHIFT);
+    for (int i = 0; i < num_keys; i++) {
+        hit_grid_add(&key_hits, keys[i].x, keys[i].y, keys[i].width, keys[i].height, i);
+    }
+    hit_grid_build(&key_hits);
+}
+
+// Make a parsed layout current: geometry, caps and hit index
+static void apply_layout(const kb_layout_t *parsed) {
+    layout = *parsed;
+    pressed_key = -1;
+    place_keys();
+    render_caps();
+    rebuild_key_index();
+}
+
+bool load_keyboard_layout(const char *spec) {
+    static kb_layout_t parsed;
+    if (!keyboard_layout_parse(spec, &parsed)) return false;
+    apply_layout(&parsed);
+    return true;
+}
+
+bool set_keyboard_layout(keyboard_layout_id_t id) {
+    if (!load_keyboard_layout(keyboard_layout_spec(id))) return false;
+    layout_id = id;
+    return true;
+}
+
+keyboard_layout_id_t get_keyboard_layout(void) {
+    return layout_id;
+}
 
 // ✅ MISSING FUNCTION IMPLEMENTATION
 // Initialize the virtual keyboard system
 void init_virtual_keyboard() {
     keyboard_initialized = true;
     last_pressed_key = 0;
+    set_keyboard_layout(KB_LAYOUT_QWERTY);
+}
+
+void show_virtual_keyboard(bool visible) {
+    keyboard_visible = visible;
+}
+
+bool is_virtual_keyboard_visible(void) {
+    return keyboard_visible;
+}
+
+void get_virtual_keyboard_bounds(clip_rect_t *bounds) {
+    if (!keyboard_initialized) {
+        init_virtual_keyboard();
+    }
+    *bounds = panel;
 }
 
 // Draw virtual keyboard
@@ -59,33 +226,129 @@ void draw_virtual_keyboard() {
     if (!keyboard_initialized) {
         init_virtual_keyboard();
     }
-    
-    for (int i = 0; i < NUM_KEYS; i++) {
-        draw_rect(keys[i].x, keys[i].y, keys[i].width, keys[i].height, 0x333333); // Key background
-        // Optional: Draw key label using display_print
-        // display_print_char(keys[i].x + 40, keys[i].y + 40, keys[i].label, 0xFFFFFF);
+
+    draw_filled_rect(panel.x0, panel.y0, panel.x1 - panel.x0, panel.y1 - panel.y0, KB_PANEL_COLOR);
+    for (int i = 0; i < num_keys; i++) {
+        if (i == pressed_key) {
+            render_cap(pressed_cap, keys[i].width, keys[i].height, keys[i].text, KB_PRESSED_COLOR);
+            draw_image(keys[i].x, keys[i].y, keys[i].width, keys[i].height, pressed_cap);
+        } else {
+            draw_image(keys[i].x, keys[i].y, keys[i].width, keys[i].height, &cap_pixels[keys[i].cap]);
+        }
     }
 }
 
 // Detect which key is pressed based on touch coordinates
 char detect_virtual_key(int touch_x, int touch_y) {
-    for (int i = 0; i < NUM_KEYS; i++) {
-        if (touch_x >= keys[i].x && touch_x <= (keys[i].x + keys[i].width) &&
-            touch_y >= keys[i].y && touch_y <= (keys[i].y + keys[i].height)) {
-            return keys[i].label;
+    if (!keyboard_initialized) {
+        init_virtual_keyboard();
+    }
+
+    int key = hit_grid_find(&key_hits, touch_x, touch_y);
+    return key >= 0 ? keys[key].label : 0; // 0 = no key pressed
+}
+
+static void key_rect(int i, clip_rect_t *rect) {
+    rect->x0 = keys[i].x;
+    rect->y0 = keys[i].y;
+    rect->x1 = keys[i].x + keys[i].width;
+    rect->y1 = keys[i].y + keys[i].height;
+}
+
+static void rect_union(clip_rect_t *dst, const clip_rect_t *a, const clip_rect_t *b) {
+    dst->x0 = a->x0 < b->x0 ? a->x0 : b->x0;
+    dst->y0 = a->y0 < b->y0 ? a->y0 : b->y0;
+    dst->x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+    dst->y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+}
+
+static void no_repaint(clip_rect_t *repainted) {
+    if (repainted) {
+        repainted->x0 = repainted->x1 = 0;
+        repainted->y0 = repainted->y1 = 0;
+    }
+}
+
+// Put a key back to its cached look
+static void restore_key(int i, clip_rect_t *repainted) {
+    draw_image(keys[i].x, keys[i].y, keys[i].width, keys[i].height, &cap_pixels[keys[i].cap]);
+    if (repainted) key_rect(i, repainted);
+}
+
+char virtual_keyboard_press(int x, int y, clip_rect_t *repainted) {
+    if (!keyboard_initialized) {
+        init_virtual_keyboard();
+    }
+    no_repaint(repainted);
+
+    int key = hit_grid_find(&key_hits, x, y);
+    if (key == pressed_key) return key >= 0 ? keys[key].label : 0;
+
+    // Only one key shows pressed; a new press takes the highlight over
+    int previous = pressed_key;
+    if (previous >= 0) restore_key(previous, repainted);
+    pressed_key = key;
+    if (key < 0) return 0;
+
+    render_cap(pressed_cap, keys[key].width, keys[key].height, keys[key].text, KB_PRESSED_COLOR);
+    draw_image(keys[key].x, keys[key].y, keys[key].width, keys[key].height, pressed_cap);
+    if (repainted) {
+        clip_rect_t rect;
+        key_rect(key, &rect);
+        if (previous >= 0) {
+            rect_union(repainted, repainted, &rect);
+        } else {
+            *repainted = rect;
         }
     }
-    return 0; // No key pressed
+    return keys[key].label;
+}
+
+void virtual_keyboard_release(clip_rect_t *repainted) {
+    no_repaint(repainted);
+    if (pressed_key < 0) return;
+
+    int key = pressed_key;
+    pressed_key = -1;
+    char code = keys[key].label;
+    if (KB_IS_LAYOUT_KEY(code)) {
+        // Layout keys act on release; the whole keyboard changes
+        clip_rect_t old_panel = panel;
+        handle_virtual_key_press(code);
+        draw_virtual_keyboard();
+        if (repainted) rect_union(repainted, &old_panel, &panel);
+        return;
+    }
+    restore_key(key, repainted);
+}
+
+// Keys fire once, when the finger lands; a held or dragged finger does
+// nothing more until it lifts
+char virtual_keyboard_touch(const touch_sample_t *touch, clip_rect_t *repainted) {
+    if (touch->type == TOUCH_UP) {
+        virtual_keyboard_release(repainted);
+        return 0;
+    }
+    if (touch->type != TOUCH_DOWN) {
+        no_repaint(repainted);
+        return 0;
+    }
+
+    char key = virtual_keyboard_press(touch->x, touch->y, repainted);
+    if (key == 0 || KB_IS_LAYOUT_KEY(key)) return 0;
+    handle_virtual_key_press(key);
+    return key;
 }
 
 // ✅ MISSING FUNCTION IMPLEMENTATION
 // Handle a virtual key press event
 void handle_virtual_key_press(char key) {
+    if (KB_IS_LAYOUT_KEY(key)) {
+        set_keyboard_layout((keyboard_layout_id_t)(key - KB_KEY_LAYOUT));
+        return;
+    }
     if (key != 0) {
         last_pressed_key = key;
-        // Add visual feedback here if needed
-        // For example: highlight the pressed key
-        
         // Process the key press (add to input buffer, etc.)
         // This would typically interface with your text input system
     }
@@ -98,18 +361,12 @@ void simulate_key_press(char key) {
 }
 
 // ✅ MISSING FUNCTION IMPLEMENTATION
-// Get the current virtual key being pressed
+// Key under the finger right now, without pressing it; 0 if none or hidden
 char get_virtual_key() {
     int touch_x, touch_y;
-    
-    // Check if there's currently a touch input
-    if (get_touch_input(&touch_x, &touch_y)) {
-        char key = detect_virtual_key(touch_x, touch_y);
-        if (key != 0) {
-            handle_virtual_key_press(key);
-            return key;
-        }
+
+    if (!keyboard_visible || !get_touch_input(&touch_x, &touch_y)) {
+        return 0;
     }
-    
-    return 0; // No key currently pressed
-}
\ No newline at end of file
+    return detect_virtual_key(touch_x, touch_y);
+}
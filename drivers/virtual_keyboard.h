@@ -1,16 +1,56 @@
 #ifndef VIRTUAL_KEYBOARD_H
 #define VIRTUAL_KEYBOARD_H
 
+#include <stdbool.h>
+#include "display4k.h"
+#include "keyboard_layouts.h"
+#include "../input/touch.h"
+
 // Initialize the virtual keyboard system
 void init_virtual_keyboard();
 
+// Switch to a built-in layout; re-renders the cached key caps
+bool set_keyboard_layout(keyboard_layout_id_t id);
+
+// Switch to a layout described as text (see keyboard_layout_parse); the
+// current layout stays if the description is malformed
+bool load_keyboard_layout(const char *spec);
+
+keyboard_layout_id_t get_keyboard_layout(void);
+
+void show_virtual_keyboard(bool visible);
+bool is_virtual_keyboard_visible(void);
+
+// Paint the whole keyboard from the cached key caps
+void draw_virtual_keyboard();
+
+// Screen area the keyboard covers
+void get_virtual_keyboard_bounds(clip_rect_t *bounds);
+
+// Key code under a touch, or 0
+char detect_virtual_key(int touch_x, int touch_y);
+
+// Finger down: highlight the key under (x, y) and return its code (0 if none).
+// Only that key is repainted; its rect is stored in repainted if given, which
+// is empty when nothing changed.
+char virtual_keyboard_press(int x, int y, clip_rect_t *repainted);
+
+// Finger up: restore the highlighted key from the cache, same as above
+void virtual_keyboard_release(clip_rect_t *repainted);
+
+// Route one queued touch to the keyboard: press on TOUCH_DOWN, release on
+// TOUCH_UP, moves ignored. Returns the code this touch typed, or 0; layout
+// keys never type, they switch the layout when released.
+char virtual_keyboard_touch(const touch_sample_t *touch, clip_rect_t *repainted);
+
 // Handle a virtual key press event
 void handle_virtual_key_press(char key);
 
 // Simulate key press (for testing without real hardware)
 void simulate_key_press(char key);
 
-// ✅ ADD THIS FUNCTION PROTOTYPE
+// Key code under the current touch, or 0 (also while hidden). Only a lookup:
+// it doesn't press, type or switch layouts; use virtual_keyboard_touch()
 char get_virtual_key();
 
 #endif // VIRTUAL_KEYBOARD_H
@@ -0,0 +1,46 @@
+#ifndef HASHOS_TOUCH_H
+#define HASHOS_TOUCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Phase of a touch contact
+typedef enum {
+    TOUCH_DOWN,
+    TOUCH_MOVE,
+    TOUCH_UP
+} touch_event_t;
+
+// Last known contact position
+typedef struct {
+    int x;
+    int y;
+    bool pressed;
+} touch_state_t;
+
+// One timestamped contact change, as queued by the touch driver
+typedef struct {
+    uint32_t time_us;       // timer_now_us() when the controller reported it
+    int16_t x;
+    int16_t y;
+    uint8_t id;             // Contact slot from the controller
+    touch_event_t type;
+} touch_sample_t;
+
+// Gestures recognized from touch sequences (see ui/gesture.h)
+typedef enum {
+    GESTURE_NONE,
+    GESTURE_SWIPE_UP,       // Flings, by dominant direction, with velocity
+    GESTURE_SWIPE_DOWN,
+    GESTURE_SWIPE_LEFT,
+    GESTURE_SWIPE_RIGHT,
+    GESTURE_PINCH_IN,       // Two fingers lifted after closing
+    GESTURE_PINCH_OUT,      // Two fingers lifted after spreading
+    GESTURE_TAP,
+    GESTURE_LONG_PRESS,
+    GESTURE_PAN,            // Finger moved past the slop; repeats while it moves
+    GESTURE_PAN_END,        // Finger lifted after a pan, too slowly to fling
+    GESTURE_PINCH           // Pinch scale changed; repeats while it changes
+} gesture_t;
+
+#endif // HASHOS_TOUCH_H
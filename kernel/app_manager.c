@@ -1,4 +1,6 @@
 #include "app_manager.h"
+#include "timer.h"
+#include "../ui/frame_pacer.h"
 
 // Maximum number of apps supported (native + third-party)
 #define MAX_APPS 10
@@ -7,9 +9,26 @@
 App apps[MAX_APPS];
 int app_count = 0;
 
+// Suspended apps' snapshots, packed back to back in the arena. State is
+// saved into the staging buffer and compressed from there.
+static uint8_t snapshot_arena[APP_SNAPSHOT_ARENA];
+static uint32_t arena_used = 0;
+static uint8_t staging[APP_SNAPSHOT_MAX];
+static uint32_t switch_clock = 0;
+static app_manager_stats_t stats;
+
+typedef struct {
+    uint8_t *buf;
+    uint32_t size;
+    uint32_t pos;
+} snapshot_io_t;
+
 // Initialize app registry
 void init_apps() {
     app_count = 0;
+    arena_used = 0;
+    switch_clock = 0;
+    stats = (app_manager_stats_t){ 0, 0, 0, 0, 0, 0 };
 }
 
 // Register an app into the system
@@ -33,34 +52,259 @@ void register_app( const char *name, void (*ui_loop)(), void (*background_loop)(
     apps[app_count].ui_loop = ui_loop;
     apps[app_count].background_loop = background_loop;
     apps[app_count].is_system_app = is_system_app;
+    apps[app_count].suspend_ops = 0;
+    apps[app_count].last_active = 0;
+    apps[app_count].paused_ms = 0;
+    apps[app_count].snapshot_offset = 0;
+    apps[app_count].snapshot_size = 0;
 
     app_count++;
 }
 
-// Switch active app by ID
+// Let an app be suspended while paused
+void app_set_suspend_ops(int app_id, const app_suspend_ops_t *ops) {
+    if (app_id < 0 || app_id >= app_count) return;
+    apps[app_id].suspend_ops = ops;
+}
+
+static int snapshot_write(void *ctx, const uint8_t *buf, int len) {
+    snapshot_io_t *io = (snapshot_io_t *)ctx;
+    if (len < 0 || (uint32_t)len > io->size - io->pos) return -1;
+    for (int i = 0; i < len; i++) io->buf[io->pos + i] = buf[i];
+    io->pos += (uint32_t)len;
+    return len;
+}
+
+static int snapshot_read(void *ctx, uint8_t *buf, int len) {
+    snapshot_io_t *io = (snapshot_io_t *)ctx;
+    if (len < 0) return -1;
+    if ((uint32_t)len > io->size - io->pos) len = (int)(io->size - io->pos);
+    for (int i = 0; i < len; i++) buf[i] = io->buf[io->pos + i];
+    io->pos += (uint32_t)len;
+    return len;
+}
+
+// PackBits: a control byte c < 128 is followed by c + 1 literal bytes, and
+// c > 128 by one byte repeated 257 - c times. Saved state is mostly zeroed
+// buffers and small integers, which this squeezes well enough.
+static int pack(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t max) {
+    uint32_t in = 0, out = 0;
+    while (in < len) {
+        uint32_t run = 1;
+        while (in + run < len && run < 128 && src[in + run] == src[in]) run++;
+
+        if (run >= 3) {
+            if (out + 2 > max) return -1;
+            dst[out++] = (uint8_t)(257 - run);
+            dst[out++] = src[in];
+            in += run;
+            continue;
+        }
+
+        // Literals up to the next run worth encoding
+        uint32_t start = in, count = 0;
+        while (in < len && count < 128) {
+            if (in + 2 < len && src[in] == src[in + 1] && src[in] == src[in + 2]) break;
+            in++;
+            count++;
+        }
+        if (out + 1 + count > max) return -1;
+        dst[out++] = (uint8_t)(count - 1);
+        for (uint32_t i = 0; i < count; i++) dst[out++] = src[start + i];
+    }
+    return (int)out;
+}
+
+static int unpack(const uint8_t *src, uint32_t len, uint8_t *dst, uint32_t max) {
+    uint32_t in = 0, out = 0;
+    while (in < len) {
+        uint8_t c = src[in++];
+        if (c < 128) {
+            uint32_t count = (uint32_t)c + 1;
+            if (in + count > len || out + count > max) return -1;
+            for (uint32_t i = 0; i < count; i++) dst[out++] = src[in++];
+        } else if (c > 128) {
+            uint32_t count = 257 - (uint32_t)c;
+            if (in >= len || out + count > max) return -1;
+            for (uint32_t i = 0; i < count; i++) dst[out++] = src[in];
+            in++;
+        }
+    }
+    return (int)out;
+}
+
+// Close the gap a snapshot leaves in the arena
+static void free_snapshot(App *app) {
+    uint32_t start = app->snapshot_offset;
+    uint32_t size = app->snapshot_size;
+    for (uint32_t i = start + size; i < arena_used; i++) {
+        snapshot_arena[i - size] = snapshot_arena[i];
+    }
+    arena_used -= size;
+
+    for (int i = 0; i < app_count; i++) {
+        if (apps[i].state == TASK_SUSPENDED && apps[i].snapshot_offset > start) {
+            apps[i].snapshot_offset -= size;
+        }
+    }
+    app->snapshot_offset = 0;
+    app->snapshot_size = 0;
+    stats.snapshot_bytes -= size;
+}
+
+// Save a paused app's state and drop its surfaces; 0 leaves it paused
+static int suspend_app(App *app) {
+    const app_suspend_ops_t *ops = app->suspend_ops;
+    snapshot_io_t io = { staging, APP_SNAPSHOT_MAX, 0 };
+    if (ops->save(snapshot_write, &io) != 0) {
+        stats.failed++;
+        return 0;
+    }
+
+    int packed = pack(staging, io.pos, &snapshot_arena[arena_used], APP_SNAPSHOT_ARENA - arena_used);
+    if (packed < 0) {
+        stats.failed++;
+        return 0;
+    }
+
+    ops->drop();
+    app->snapshot_offset = arena_used;
+    app->snapshot_size = (uint32_t)packed;
+    app->state = TASK_SUSPENDED;
+    arena_used += (uint32_t)packed;
+    stats.suspended++;
+    stats.snapshot_bytes += (uint32_t)packed;
+    stats.raw_bytes += io.pos;
+    return 1;
+}
+
+// Bring a suspended app back from its snapshot, paused
+static void resume_app(App *app) {
+    const app_suspend_ops_t *ops = app->suspend_ops;
+    int raw = unpack(&snapshot_arena[app->snapshot_offset], app->snapshot_size, staging, APP_SNAPSHOT_MAX);
+    free_snapshot(app);
+    app->state = TASK_UI_PAUSED;
+
+    snapshot_io_t io = { staging, raw < 0 ? 0 : (uint32_t)raw, 0 };
+    if (raw < 0 || ops->restore(snapshot_read, &io) != 0) {
+        stats.restore_failed++;
+    }
+    if (raw > 0) stats.raw_bytes -= (uint32_t)raw;
+    stats.resumed++;
+}
+
+int app_manager_trim(uint32_t budget) {
+    uint32_t resident = 0;
+    int tried[MAX_APPS] = { 0 };
+    for (int i = 0; i < app_count; i++) {
+        if (apps[i].suspend_ops && apps[i].state != TASK_SUSPENDED) {
+            resident += apps[i].suspend_ops->resident_bytes();
+        }
+    }
+
+    int suspended = 0;
+    while (resident > budget) {
+        App *victim = 0;
+        for (int i = 0; i < app_count; i++) {
+            App *app = &apps[i];
+            if (!app->suspend_ops || app->state != TASK_UI_PAUSED || tried[i]) continue;
+            if (!victim || app->last_active < victim->last_active) victim = app;
+        }
+        if (!victim) break;
+
+        tried[victim->id] = 1;
+        uint32_t bytes = victim->suspend_ops->resident_bytes();
+        if (suspend_app(victim)) {
+            resident -= bytes < resident ? bytes : resident;
+            suspended++;
+        }
+    }
+    return suspended;
+}
+
+// Switch active app by ID, then suspend whatever no longer fits
 void switch_app(int new_app_id) {
+    if (new_app_id >= 0 && new_app_id < app_count && apps[new_app_id].state == TASK_SUSPENDED) {
+        resume_app(&apps[new_app_id]);
+    }
+
     for (int i = 0; i < app_count; i++) {
         if (i == new_app_id) {
             apps[i].state = TASK_UI_ACTIVE;
+            apps[i].last_active = ++switch_clock;
         } else if (apps[i].state == TASK_UI_ACTIVE) {
             apps[i].state = TASK_UI_PAUSED;
+            apps[i].last_active = ++switch_clock;
+            apps[i].paused_ms = timer_now_ms();
         }
         // Background services are not affected
     }
+
+    app_manager_trim(APP_MEMORY_BUDGET);
+}
+
+void app_manager_get_stats(app_manager_stats_t *out) {
+    *out = stats;
+}
+
+// Switch to the registered app named by the last component of path
+// (compared case-insensitively); returns its id or -1 if none matches
+int app_manager_launch(const char *path) {
+    const char *base = path;
+    for (const char *p = path; *p; p++) {
+        if (*p == '/') base = p + 1;
+    }
+
+    for (int i = 0; i < app_count; i++) {
+        const char *a = apps[i].name;
+        const char *b = base;
+        while (*a && *b && (*a | 0x20) == (*b | 0x20)) {
+            a++;
+            b++;
+        }
+        if (*a == '\0' && *b == '\0') {
+            switch_app(i);
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Suspend paused apps that have been behind for APP_SUSPEND_IDLE_MS with
+// nothing left to do. A failed suspension waits out another idle period.
+static void suspend_idle_apps(void) {
+    uint32_t now = timer_now_ms();
+    for (int i = 0; i < app_count; i++) {
+        App *app = &apps[i];
+        const app_suspend_ops_t *ops = app->suspend_ops;
+        if (!ops || app->state != TASK_UI_PAUSED) continue;
+        if (now - app->paused_ms < APP_SUSPEND_IDLE_MS || (ops->busy && ops->busy())) continue;
+
+        if (!suspend_app(app)) app->paused_ms = now;
+    }
+}
+
+// One scheduler round: the app in front runs its UI, and every app behind
+// it, paused or a background service, gets its background work in
+void run_scheduler_round() {
+    for (int i = 0; i < app_count; i++) {
+        if (apps[i].state == TASK_UI_ACTIVE) {
+            apps[i].ui_loop();
+        } else if ((apps[i].state == TASK_UI_PAUSED || apps[i].state == TASK_BACKGROUND) &&
+                   apps[i].background_loop) {
+            apps[i].background_loop();
+        }
+    }
+    suspend_idle_apps();
 }
 
 // Main app/task scheduler
 void run_scheduler() {
     while (1) {
-        for (int i = 0; i < app_count; i++) {
-            // Run UI loop for active app
-            if (apps[i].state == TASK_UI_ACTIVE) {
-                apps[i].ui_loop();
-            }
-            // Run background service (if provided)
-            else if (apps[i].state == TASK_BACKGROUND) {
-                apps[i].background_loop();
-            }
-        }
+        frame_pacer_begin_frame();
+        run_scheduler_round();
+
+        // One scheduler round per display refresh
+        frame_pacer_end_frame();
     }
 }
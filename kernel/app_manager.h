@@ -1,12 +1,46 @@
 #ifndef HASHOS_APP_MANAGER_H
 #define HASHOS_APP_MANAGER_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
+// Paused apps are suspended, least recently used first, while the apps that
+// aren't suspended hold more than this between them
+#define APP_MEMORY_BUDGET       (8 * 1024 * 1024)
+
+// The scheduler also suspends an app that has been paused this long with no
+// background work left, whatever memory it holds
+#define APP_SUSPEND_IDLE_MS     5000
+
+// Saved state per app before compression, and all compressed snapshots
+#define APP_SNAPSHOT_MAX        16384
+#define APP_SNAPSHOT_ARENA      65536
+
 typedef enum {
     TASK_UI_ACTIVE,
     TASK_UI_PAUSED,
-    TASK_BACKGROUND
+    TASK_BACKGROUND,
+    TASK_SUSPENDED              // State saved, surfaces dropped; restored by switch_app()
 } TaskState;
 
+// Snapshot writer / reader: bytes written or read, <0 on error
+typedef int (*app_write_fn)(void *ctx, const uint8_t *buf, int len);
+typedef int (*app_read_fn)(void *ctx, uint8_t *buf, int len);
+
+// How an app gets suspended. save() writes whatever it needs to come back as
+// it was; drop() is called only once the snapshot is kept, and gives back
+// its surfaces and caches. restore() reads the snapshot back; if it fails
+// the app should start over as if freshly launched. busy() is optional: an
+// app that says its background loop still has work isn't suspended for
+// being idle.
+typedef struct {
+    uint32_t (*resident_bytes)(void);       // Memory drop() would give back
+    int (*save)(app_write_fn write, void *ctx);     // 0 on success
+    void (*drop)(void);
+    int (*restore)(app_read_fn read, void *ctx);    // 0 on success
+    bool (*busy)(void);
+} app_suspend_ops_t;
+
 typedef struct {
     int id;
     char name[32];
@@ -14,15 +48,42 @@ typedef struct {
     void (*ui_loop)();
     void (*background_loop)();
     int is_system_app; // 1 = Native app, 0 = Third-party
+    const app_suspend_ops_t *suspend_ops;   // NULL: never suspended
+    uint32_t last_active;                   // Switch count when it was last in front
+    uint32_t paused_ms;                     // When it last went behind, or failed to suspend
+    uint32_t snapshot_offset;               // Compressed snapshot, while suspended
+    uint32_t snapshot_size;
 } App;
 
+typedef struct {
+    uint32_t suspended;
+    uint32_t resumed;
+    uint32_t failed;            // Suspensions abandoned: save failed or no room
+    uint32_t restore_failed;
+    uint32_t snapshot_bytes;    // Compressed bytes held right now
+    uint32_t raw_bytes;         // The same snapshots before compression
+} app_manager_stats_t;
+
 void init_apps();
 void null_background_loop();
 void null_ui_loop();
 void register_app(const char *name, void (*ui_loop)(), void (*background_loop)(), int is_system_app);
+void app_set_suspend_ops(int app_id, const app_suspend_ops_t *ops);
 void switch_app(int new_app_id);
+int app_manager_launch(const char *path);
 void run_scheduler();
 
+// One pass of run_scheduler() without the frame pacing: the active app's UI
+// loop, then the background loop of every paused or background app, then
+// suspending the paused apps that have sat idle for APP_SUSPEND_IDLE_MS
+void run_scheduler_round();
+
+// Suspend paused apps, least recently used first, until the apps left
+// resident hold at most budget bytes. Returns how many were suspended.
+int app_manager_trim(uint32_t budget);
+
+void app_manager_get_stats(app_manager_stats_t *stats);
+
 extern int app_count;
 extern App apps[];
 
@@ -19,6 +19,9 @@ void parse_config() {
     system_config.default_audio_profile[6] = 'r'; system_config.default_audio_profile[7] = 'd';
     system_config.default_audio_profile[8] = '\0';
 
+    system_config.vsync_enabled = 1;
+    system_config.refresh_rate = 60;
+
     // Visual confirmation via colored rectangles
     // Example: If brightness > 80, show green block
     if (system_config.screen_brightness > 80) {
@@ -6,6 +6,8 @@ typedef struct {
     char boot_theme[32];
     int screen_brightness;
     char default_audio_profile[32];
+    int vsync_enabled;       // Pace frames to the display refresh
+    int refresh_rate;        // Target frames per second
 } SystemConfig;
 
 void parse_config();
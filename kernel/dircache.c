@@ -0,0 +1,271 @@
+// dircache.c - directory listing cache and change watches
+//
+// A listing is a directory's entries in directory order, with their names in
+// the listing's own arena. A change that moves a directory from generation g
+// to g + 1 is applied to the listing cached at g, so it stays usable; any
+// other gap means changes were missed, and the listing is dropped.
+#include "dircache.h"
+#include <string.h>
+
+typedef struct {
+    uint32_t name;              // Offset in the listing's arena
+    uint8_t type;
+    uint64_t size;
+    uint64_t modified_time;
+} cached_entry_t;
+
+typedef struct {
+    uint32_t dir;
+    uint32_t generation;
+    bool valid;                 // False: free, or dropped while pinned
+    bool committed;             // False while being filled
+    int uses;
+    uint32_t last_used;
+    int count;
+    uint32_t names_used;        // Deleted entries leave their names behind
+    cached_entry_t entries[DIRCACHE_MAX_ENTRIES];
+    char names[DIRCACHE_NAME_BYTES];
+} listing_t;
+
+typedef struct {
+    bool used;
+    uint32_t dir;
+    int head;
+    int count;
+    dircache_event_t queue[DIRCACHE_QUEUE];
+} watch_t;
+
+static listing_t listings[DIRCACHE_LISTINGS];
+static watch_t watches[DIRCACHE_WATCHES];
+static uint32_t use_clock = 0;
+static dircache_stats_t stats;
+
+static bool valid_listing(int listing) {
+    return listing >= 0 && listing < DIRCACHE_LISTINGS && listings[listing].uses > 0;
+}
+
+int dircache_find(uint32_t dir, uint32_t generation) {
+    for (int i = 0; i < DIRCACHE_LISTINGS; i++) {
+        listing_t *l = &listings[i];
+        if (l->valid && l->committed && l->dir == dir && l->generation == generation) {
+            l->uses++;
+            l->last_used = ++use_clock;
+            stats.hits++;
+            return i;
+        }
+    }
+    stats.misses++;
+    return -1;
+}
+
+int dircache_count(int listing) {
+    return valid_listing(listing) ? listings[listing].count : 0;
+}
+
+bool dircache_get(int listing, int index, dircache_entry_t *out) {
+    if (!valid_listing(listing)) return false;
+    const listing_t *l = &listings[listing];
+    if (index < 0 || index >= l->count) return false;
+
+    const cached_entry_t *e = &l->entries[index];
+    out->name = &l->names[e->name];
+    out->type = e->type;
+    out->size = e->size;
+    out->modified_time = e->modified_time;
+    return true;
+}
+
+void dircache_release(int listing) {
+    if (valid_listing(listing)) listings[listing].uses--;
+}
+
+// A free slot, or the least recently used listing nobody holds
+int dircache_begin(uint32_t dir, uint32_t generation) {
+    listing_t *slot = NULL;
+    for (int i = 0; i < DIRCACHE_LISTINGS; i++) {
+        listing_t *l = &listings[i];
+        if (l->uses > 0) continue;
+        if (!l->valid) {
+            slot = l;
+            break;
+        }
+        if (!slot || l->last_used < slot->last_used) slot = l;
+    }
+    if (!slot) return -1;
+    if (slot->valid) stats.evictions++;
+
+    slot->dir = dir;
+    slot->generation = generation;
+    slot->valid = true;
+    slot->committed = false;
+    slot->uses = 1;
+    slot->last_used = ++use_clock;
+    slot->count = 0;
+    slot->names_used = 0;
+    return (int)(slot - listings);
+}
+
+static bool store_entry(listing_t *l, cached_entry_t *e, const dircache_entry_t *entry) {
+    const char *name = entry->name ? entry->name : "";
+    uint32_t len = (uint32_t)strlen(name);
+    if (l->names_used + len + 1 > DIRCACHE_NAME_BYTES) return false;
+
+    e->name = l->names_used;
+    memcpy(&l->names[l->names_used], name, len + 1);
+    l->names_used += len + 1;
+    e->type = entry->type;
+    e->size = entry->size;
+    e->modified_time = entry->modified_time;
+    return true;
+}
+
+static bool append_entry(listing_t *l, const dircache_entry_t *entry) {
+    if (l->count >= DIRCACHE_MAX_ENTRIES || !store_entry(l, &l->entries[l->count], entry)) {
+        return false;
+    }
+    l->count++;
+    return true;
+}
+
+bool dircache_append(int listing, const dircache_entry_t *entry) {
+    if (!valid_listing(listing)) return false;
+    listing_t *l = &listings[listing];
+    if (!l->valid) return false;
+
+    if (!append_entry(l, entry)) {
+        l->valid = false;
+        return false;
+    }
+    return true;
+}
+
+bool dircache_commit(int listing) {
+    if (!valid_listing(listing) || !listings[listing].valid) return false;
+    listings[listing].committed = true;
+    stats.fills++;
+    return true;
+}
+
+static int find_name(const listing_t *l, const char *name) {
+    for (int i = 0; i < l->count; i++) {
+        if (strcmp(&l->names[l->entries[i].name], name) == 0) return i;
+    }
+    return -1;
+}
+
+// Bring a listing forward by one change; false if it can't be applied
+static bool patch(listing_t *l, dircache_event_type_t type, const dircache_entry_t *entry) {
+    const char *name = entry && entry->name ? entry->name : NULL;
+    if (!name) return false;
+
+    int index = find_name(l, name);
+    switch (type) {
+        case DIRCACHE_CREATED:
+            if (index < 0) return append_entry(l, entry);
+            // Created over an existing name: same as a modification
+            l->entries[index].type = entry->type;
+            l->entries[index].size = entry->size;
+            l->entries[index].modified_time = entry->modified_time;
+            return true;
+
+        case DIRCACHE_DELETED:
+            if (index < 0) return false;
+            for (int i = index; i + 1 < l->count; i++) {
+                l->entries[i] = l->entries[i + 1];
+            }
+            l->count--;
+            return true;
+
+        case DIRCACHE_MODIFIED:
+            if (index < 0) return false;
+            l->entries[index].type = entry->type;
+            l->entries[index].size = entry->size;
+            l->entries[index].modified_time = entry->modified_time;
+            return true;
+
+        case DIRCACHE_OVERFLOW:
+            break;
+    }
+    return false;
+}
+
+static void queue_event(watch_t *w, dircache_event_type_t type, uint32_t dir, uint32_t generation,
+                        const char *name) {
+    if (w->count == DIRCACHE_QUEUE) {
+        // Full: the watcher has to reread the directory anyway
+        w->head = 0;
+        w->count = 0;
+        type = DIRCACHE_OVERFLOW;
+        name = NULL;
+        stats.overflows++;
+    }
+
+    dircache_event_t *ev = &w->queue[(w->head + w->count) % DIRCACHE_QUEUE];
+    w->count++;
+    ev->type = type;
+    ev->dir = dir;
+    ev->generation = generation;
+    ev->name[0] = '\0';
+    if (name) {
+        size_t len = strlen(name);
+        if (len > DIRCACHE_NAME_MAX - 1) len = DIRCACHE_NAME_MAX - 1;
+        memcpy(ev->name, name, len);
+        ev->name[len] = '\0';
+    }
+    stats.events++;
+}
+
+void dircache_notify(uint32_t dir, uint32_t generation, dircache_event_type_t type,
+                     const dircache_entry_t *entry) {
+    for (int i = 0; i < DIRCACHE_LISTINGS; i++) {
+        listing_t *l = &listings[i];
+        if (!l->valid || l->dir != dir || l->generation == generation) continue;
+
+        // Half-filled listings may have read either side of the change
+        if (l->committed && l->generation + 1 == generation && patch(l, type, entry)) {
+            l->generation = generation;
+            stats.patched++;
+        } else {
+            l->valid = false;
+            stats.dropped++;
+        }
+    }
+
+    for (int i = 0; i < DIRCACHE_WATCHES; i++) {
+        if (watches[i].used && watches[i].dir == dir) {
+            queue_event(&watches[i], type, dir, generation, entry ? entry->name : NULL);
+        }
+    }
+}
+
+int dircache_watch(uint32_t dir) {
+    for (int i = 0; i < DIRCACHE_WATCHES; i++) {
+        if (!watches[i].used) {
+            watches[i].used = true;
+            watches[i].dir = dir;
+            watches[i].head = 0;
+            watches[i].count = 0;
+            return i;
+        }
+    }
+    return -1;
+}
+
+void dircache_unwatch(int watch) {
+    if (watch >= 0 && watch < DIRCACHE_WATCHES) watches[watch].used = false;
+}
+
+bool dircache_poll(int watch, dircache_event_t *out) {
+    if (watch < 0 || watch >= DIRCACHE_WATCHES) return false;
+    watch_t *w = &watches[watch];
+    if (!w->used || w->count == 0) return false;
+
+    *out = w->queue[w->head];
+    w->head = (w->head + 1) % DIRCACHE_QUEUE;
+    w->count--;
+    return true;
+}
+
+void dircache_get_stats(dircache_stats_t *out) {
+    *out = stats;
+}
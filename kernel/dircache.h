@@ -0,0 +1,81 @@
+#ifndef HASHOS_DIRCACHE_H
+#define HASHOS_DIRCACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Directory listings, keyed by directory inode and generation. A directory's
+// generation goes up with every change to it; the filesystem reports each
+// change with dircache_notify(), which patches the cached listing forward to
+// the new generation and queues an event for anyone watching the directory.
+#define DIRCACHE_LISTINGS       16
+#define DIRCACHE_MAX_ENTRIES    1024    // Bigger directories aren't cached
+#define DIRCACHE_NAME_BYTES     16384   // Name bytes per listing
+#define DIRCACHE_WATCHES        16
+#define DIRCACHE_QUEUE          32      // Events per watch before they collapse into one overflow
+#define DIRCACHE_NAME_MAX       64      // Name bytes carried by an event
+
+typedef struct {
+    const char *name;
+    uint8_t type;               // The caller's file type, kept as is
+    uint64_t size;
+    uint64_t modified_time;
+} dircache_entry_t;
+
+typedef enum {
+    DIRCACHE_CREATED,
+    DIRCACHE_DELETED,
+    DIRCACHE_MODIFIED,
+    DIRCACHE_OVERFLOW           // Events were lost; reread the directory
+} dircache_event_type_t;
+
+typedef struct {
+    dircache_event_type_t type;
+    uint32_t dir;
+    uint32_t generation;        // The directory's generation after the change
+    char name[DIRCACHE_NAME_MAX];
+} dircache_event_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t fills;             // Listings committed
+    uint32_t patched;           // Changes applied to a cached listing
+    uint32_t dropped;           // Listings thrown out by a change they couldn't take
+    uint32_t evictions;
+    uint32_t events;
+    uint32_t overflows;
+} dircache_stats_t;
+
+// Listings are handed out pinned: they are never evicted, though changes can
+// still patch them, until dircache_release().
+
+// The listing of dir at generation, or -1
+int dircache_find(uint32_t dir, uint32_t generation);
+int dircache_count(int listing);
+bool dircache_get(int listing, int index, dircache_entry_t *out);
+void dircache_release(int listing);
+
+// Fill a listing for dir at generation, in directory order. Returns -1 when
+// every listing is pinned. append() returns false once the directory no
+// longer fits, and commit() false if the listing was dropped meanwhile; it
+// stays pinned either way.
+int dircache_begin(uint32_t dir, uint32_t generation);
+bool dircache_append(int listing, const dircache_entry_t *entry);
+bool dircache_commit(int listing);
+
+// Called by the filesystem after a change moved dir to generation. entry is
+// the file created, deleted or modified.
+void dircache_notify(uint32_t dir, uint32_t generation, dircache_event_type_t type,
+                     const dircache_entry_t *entry);
+
+// Watch a directory for changes; -1 when every watch is taken
+int dircache_watch(uint32_t dir);
+void dircache_unwatch(int watch);
+
+// Next queued change for a watch, oldest first
+bool dircache_poll(int watch, dircache_event_t *out);
+
+void dircache_get_stats(dircache_stats_t *stats);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef HASHOS_IO_H
+#define HASHOS_IO_H
+
+#include <stdint.h>
+
+// x86 port I/O helpers
+static inline void outb(uint16_t port, uint8_t value) {
+    __asm__ volatile ("outb %0, %1" : : "a"(value), "Nd"(port));
+}
+
+static inline uint8_t inb(uint16_t port) {
+    uint8_t value;
+    __asm__ volatile ("inb %1, %0" : "=a"(value) : "Nd"(port));
+    return value;
+}
+
+// Spin-wait hint for busy loops
+static inline void cpu_relax(void) {
+    __asm__ volatile ("pause");
+}
+
+#endif
@@ -12,6 +12,10 @@
 #include "../ui/file_explorer.h"
 #include "../ui/settings.h"
 #include "../ui/launcher.h"
+#include "../ui/frame_pacer.h"
+#include "../ui/latency.h"
+#include "../drivers/tile_raster.h"
+#include "timer.h"
 
 // Constants
 #define MIN_FRAMEBUFFER_ADDRESS 0x100000
@@ -193,8 +197,9 @@ int init_system_apps(void) {
     int result = register_app_safe("Launcher", launcher_ui_loop, null_background_loop, 9);
     if (result >= 0) apps_registered++; else registration_errors++;
 
-    result = register_app_safe("File Explorer", file_explorer_ui_loop, null_background_loop, 8);
+    result = register_app_safe("File Explorer", file_explorer_ui_loop, file_explorer_background_loop, 8);
     if (result >= 0) apps_registered++; else registration_errors++;
+    if (result >= 0) app_set_suspend_ops(app_count - 1, &file_explorer_suspend_ops);
 
     result = register_app_safe("Settings", settings_ui_loop, null_background_loop, 7);
     if (result >= 0) apps_registered++; else registration_errors++;
@@ -222,11 +227,26 @@ void kernel_main(unsigned int framebuffer_address) {
         kernel_panic("Graphics initialization failed");
     }
 
+    init_timer();
+
+    // Application processors are not started yet; the boot CPU rasterizes
+    // every tile until they register with tile_raster_add_worker()
+    tile_raster_init();
+
     init_drivers();  // corrected: removed if()
     drivers_initialized = 1;
 
     parse_config();  // corrected: removed if()
 
+    SystemConfig config = get_system_config();
+    frame_pacer_init(config.refresh_rate, config.vsync_enabled);
+    latency_init();
+#ifdef DEBUG
+    frame_pacer_set_hud(true);
+    latency_set_hud(true);
+    latency_set_serial_interval_ms(10000);
+#endif
+
     init_filesystem();  // corrected: removed if()
     filesystem_initialized = 1;
 
@@ -0,0 +1,88 @@
+#include "timer.h"
+#include "io.h"
+
+// PIT ports and input clock
+#define PIT_CHANNEL2     0x42
+#define PIT_COMMAND      0x43
+#define PIT_GATE_PORT    0x61
+#define PIT_FREQUENCY    1193182
+#define CALIBRATE_MS     10
+#define MS_PER_US_FRAC   4294967 // 2^32 / 1000
+
+static uint64_t tsc_base = 0;
+static uint32_t tsc_per_us = 1;
+static uint32_t us_per_tsc_frac = 0xFFFFFFFF; // 2^32 / tsc_per_us, avoids 64-bit division
+
+static inline uint64_t read_tsc() {
+    uint32_t lo, hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+// Measure TSC ticks over a one-shot PIT channel 2 countdown
+static uint32_t calibrate_tsc() {
+    uint32_t count = PIT_FREQUENCY / (1000 / CALIBRATE_MS);
+
+    // Gate channel 2 off, speaker off
+    uint8_t gate = inb(PIT_GATE_PORT) & ~0x03;
+    outb(PIT_GATE_PORT, gate);
+
+    // Channel 2, lobyte/hibyte, mode 0 (interrupt on terminal count)
+    outb(PIT_COMMAND, 0xB0);
+    outb(PIT_CHANNEL2, count & 0xFF);
+    outb(PIT_CHANNEL2, (count >> 8) & 0xFF);
+
+    // Raise the gate to start counting
+    outb(PIT_GATE_PORT, gate | 0x01);
+    uint64_t start = read_tsc();
+    while (!(inb(PIT_GATE_PORT) & 0x20)) {
+        cpu_relax();
+    }
+    uint64_t end = read_tsc();
+
+    outb(PIT_GATE_PORT, gate);
+
+    uint32_t ticks = (uint32_t)(end - start);
+    uint32_t per_us = ticks / (CALIBRATE_MS * 1000);
+    return per_us ? per_us : 1;
+}
+
+// Calibrate the monotonic clock
+void init_timer() {
+    tsc_per_us = calibrate_tsc();
+    us_per_tsc_frac = 0xFFFFFFFF / tsc_per_us;
+    tsc_base = read_tsc();
+}
+
+// (value * frac) >> 32 using only 32x32 multiplies (no libgcc 64-bit division)
+static uint64_t scale_frac(uint64_t value, uint32_t frac) {
+    uint32_t hi = (uint32_t)(value >> 32);
+    uint32_t lo = (uint32_t)value;
+    return (uint64_t)hi * frac + (((uint64_t)lo * frac) >> 32);
+}
+
+// Full-width microseconds since init_timer()
+static uint64_t timer_now_us64() {
+    return scale_frac(read_tsc() - tsc_base, us_per_tsc_frac);
+}
+
+uint32_t timer_now_us() {
+    return (uint32_t)timer_now_us64();
+}
+
+uint32_t timer_now_ms() {
+    return (uint32_t)scale_frac(timer_now_us64(), MS_PER_US_FRAC);
+}
+
+// Busy-wait for at least us microseconds
+void timer_delay_us(uint32_t us) {
+    uint32_t start = timer_now_us();
+    while ((uint32_t)(timer_now_us() - start) < us) {
+        cpu_relax();
+    }
+}
+
+// System time in milliseconds (used by the splash screen)
+uint32_t get_system_time() {
+    return timer_now_ms();
+}
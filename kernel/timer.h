@@ -0,0 +1,21 @@
+#ifndef HASHOS_TIMER_H
+#define HASHOS_TIMER_H
+
+#include <stdint.h>
+
+// Calibrate the monotonic clock (TSC against PIT channel 2)
+void init_timer();
+
+// Monotonic time since init_timer(); 32-bit values wrap, compare with differences
+uint32_t timer_now_us();
+uint32_t timer_now_ms();
+
+// Busy-wait for at least us microseconds
+void timer_delay_us(uint32_t us);
+
+// Signed difference a - b, safe across wraparound
+static inline int32_t timer_diff(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b);
+}
+
+#endif
@@ -1 +1,2160 @@
+// test.c - host render harness
+//
+// Runs the display layer and the UI screens against an in-memory 4K
+// framebuffer, times each screen and checks the result against golden
+// CRCs. Built and run on the host by `make render-test` (part of `make test`).
+// Before the scenes it replays the recorded touch traces in TRACE_DIR through
+// the gesture recognizer and checks the gestures each one expects, then types
+// the search queries and checks the best match of each, then runs the unit
+// checks of modules that have no screen of their own. Scenes may also
+// check state beyond the frame; a failed check fails its scene.
+//
+//   render_test [--update] [--dump] [--serial] [golden-file]
+//
+// --update rewrites the golden file from the current output; a missing golden
+// file is created the same way. --dump writes every frame to RENDER_OUT_DIR.
+// --serial prints what the code under test writes to the serial port.
+// Frames that don't match their golden CRC are always dumped so they can be
+// compared against a good build.
+//
+// The code under test sees a manual clock (host_advance_ms) so animated
+// scenes are reproducible; only the measurements use the real clock.
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../drivers/display4k.h"
+#include "../drivers/virtual_keyboard.h"
+#include "../drivers/tile_raster.h"
+#include "../drivers/image_decoder.h"
+#include "../drivers/hit_grid.h"
+#include "../drivers/touch_input.h"
+#include "../ui/launcher.h"
+#include "../ui/file_explorer.h"
+#include "../ui/status_bar.h"
+#include "../ui/splash.h"
+#include "../ui/animations.h"
+#include "../ui/gesture.h"
+#include "../ui/touch_resampler.h"
+#include "../ui/latency.h"
+#include "../ui/app_search.h"
+#include "../ui/wallpapers.h"
+#include "../ui/thumbnail_cache.h"
+#include "../ui/effect_pool.h"
+#include "../kernel/dircache.h"
+#include "../kernel/app_manager.h"
+
+#define RENDER_GOLDEN_FILE   "tests/golden/render.txt"
+#define RENDER_OUT_DIR       "build/render"
+#define RENDER_ITERATIONS    7
+#define RENDER_MAX_SCENES    32
+
+#define TRACE_DIR            "tests/traces"
+#define TRACE_MAX_SAMPLES    256
+#define TRACE_FRAME_US       16667
+
+#define SEARCH_FILLER_APPS   3000
+#define HUGE_DIR_ENTRIES     100000                   // Big, but still sorted
+
+// Timings slower than the recorded reference by this factor are reported
+#define RENDER_SLOWDOWN_WARN 1.5
+
+// =============================================================================
+// Host stand-ins for kernel services
+// =============================================================================
+
+uint32_t *framebuffer = NULL;
+static uint32_t host_framebuffer[SCREEN_WIDTH * SCREEN_HEIGHT];
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Clock seen by the code under test
+static uint32_t host_clock_us = 0;
+
+static void host_advance_ms(uint32_t ms) {
+    host_clock_us += ms * 1000;
+}
+
+uint32_t timer_now_us() {
+    return host_clock_us;
+}
+
+uint32_t timer_now_ms() {
+    return host_clock_us / 1000;
+}
+
+uint32_t get_system_time() {
+    return timer_now_ms();
+}
+
+// No spare frame time, so screens never start background work mid-measurement
+uint32_t frame_pacer_next_present_us(void) {
+    return timer_now_us();
+}
+
+// The scheduler loop isn't run here
+void frame_pacer_begin_frame(void) {}
+void frame_pacer_end_frame(void) {}
+
+// Serial output goes to stdout with --serial
+static bool host_serial_echo = false;
+
+void serial_write(uint16_t port, const char *s) {
+    (void)port;
+    if (host_serial_echo) fputs(s, stdout);
+}
+
+// =============================================================================
+// Checks
+// =============================================================================
+
+// What scenes and unit checks assert beyond the frame. A failed check is
+// counted and printed (once per scene, not per iteration), and fails the run.
+static int check_failures = 0;
+static bool check_quiet = false;
+
+static void check_failed(const char *fmt, ...) {
+    check_failures++;
+    if (check_quiet) return;
+
+    va_list args;
+    va_start(args, fmt);
+    printf("check failed: ");
+    vprintf(fmt, args);
+    printf("\n");
+    va_end(args);
+}
+
+// =============================================================================
+// Test images
+// =============================================================================
+
+static uint32_t crc_table[256];
+
+static void crc32_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32_buffer(const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint32_t c = 0xFFFFFFFFu;
+    while (len--) {
+        c = crc_table[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+// Minimal image encoders for decoder input: 8-bit RGB PNG with stored
+// (uncompressed) deflate blocks, and 24-bit bottom-up BMP
+#define TEST_IMAGE_MAX      (64 * 1024)
+
+static uint8_t *put_be32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+    return p + 4;
+}
+
+static uint8_t *put_le(uint8_t *p, uint32_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) *p++ = (uint8_t)(v >> (8 * i));
+    return p;
+}
+
+static uint8_t *png_chunk(uint8_t *p, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t *start = p + 4;
+    p = put_be32(p, len);
+    memcpy(p, type, 4);
+    if (len) memcpy(p + 4, data, len);
+    p += 4 + len;
+    return put_be32(p, crc32_buffer(start, len + 4));
+}
+
+// Returns the encoded size; *idat_end is where the image data ends
+static size_t make_png(uint8_t *out, int width, int height, const uint32_t *rgb, size_t *idat_end) {
+    static uint8_t raw[TEST_IMAGE_MAX], zlib[TEST_IMAGE_MAX];
+    uint8_t header[13];
+    uint8_t *p = out;
+
+    memcpy(p, "\x89PNG\r\n\x1a\n", 8);
+    p += 8;
+    put_be32(header, (uint32_t)width);
+    put_be32(header + 4, (uint32_t)height);
+    memcpy(header + 8, "\x08\x02\x00\x00\x00", 5);
+    p = png_chunk(p, "IHDR", header, 13);
+
+    size_t n = 0;
+    for (int y = 0; y < height; y++) {
+        raw[n++] = 0;                       // Filter: none
+        for (int x = 0; x < width; x++) {
+            uint32_t c = rgb[y * width + x];
+            raw[n++] = (uint8_t)(c >> 16);
+            raw[n++] = (uint8_t)(c >> 8);
+            raw[n++] = (uint8_t)c;
+        }
+    }
+
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < n; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint8_t *z = zlib;
+    *z++ = 0x78;
+    *z++ = 0x01;
+    *z++ = 0x01;                            // Final stored block
+    z = put_le(z, (uint32_t)n, 2);
+    z = put_le(z, (uint32_t)(~n & 0xFFFF), 2);
+    memcpy(z, raw, n);
+    z = put_be32(z + n, (b << 16) | a);
+
+    p = png_chunk(p, "IDAT", zlib, (uint32_t)(z - zlib));
+    if (idat_end) *idat_end = (size_t)(p - out);
+    p = png_chunk(p, "IEND", NULL, 0);
+    return (size_t)(p - out);
+}
+
+static size_t make_bmp(uint8_t *out, int width, int height, const uint32_t *rgb) {
+    int stride = (width * 3 + 3) & ~3;
+    uint8_t *p = out;
+    memcpy(p, "BM", 2);
+    p = put_le(p + 2, (uint32_t)(54 + stride * height), 4);
+    p = put_le(p, 0, 4);
+    p = put_le(p, 54, 4);
+    p = put_le(p, 40, 4);
+    p = put_le(p, (uint32_t)width, 4);
+    p = put_le(p, (uint32_t)height, 4);
+    p = put_le(p, 1, 2);
+    p = put_le(p, 24, 2);
+    memset(p, 0, 24);
+    p += 24;
+    for (int y = height - 1; y >= 0; y--) {
+        uint8_t *row = p;
+        for (int x = 0; x < width; x++) p = put_le(p, rgb[y * width + x], 3);
+        while (p - row < stride) *p++ = 0;
+    }
+    return (size_t)(p - out);
+}
+
+// =============================================================================
+// Scenes
+// =============================================================================
+
+// setup() runs untimed before every iteration, render() is what gets timed.
+// If same_as names an earlier scene, the frame must be identical to its frame.
+typedef struct {
+    const char *name;
+    void (*setup)(void);
+    void (*render)(void);
+    const char *same_as;
+} render_scene_t;
+
+typedef struct {
+    char name[32];
+    uint32_t crc;
+    double ms;
+} golden_entry_t;
+
+// Primitive microbenchmarks: many shapes, a good share of them clipped by the
+// screen edges, so the timings cover the span fills and the clipping paths
+static uint32_t prim_seed = 1;
+
+static int prim_rand(int lo, int hi) {
+    prim_seed = prim_seed * 1103515245u + 12345u;
+    return lo + (int)((prim_seed >> 8) % (uint32_t)(hi - lo));
+}
+
+static uint32_t prim_color(void) {
+    return 0xFF000000u | (uint32_t)prim_rand(0, 0x1000000);
+}
+
+static void setup_prims(void) {
+    prim_seed = 1;
+    clear_screen(0x000000);
+}
+
+static void render_prims_lines(void) {
+    int cx = SCREEN_WIDTH / 2, cy = SCREEN_HEIGHT / 2;
+    for (int i = 0; i < 1000; i++) {
+        int x = prim_rand(-400, SCREEN_WIDTH + 400);
+        int y = prim_rand(-400, SCREEN_HEIGHT + 400);
+        draw_line(cx, cy, x, y, prim_color());
+    }
+    for (int i = 0; i < 200; i++) {
+        draw_line(-100, i * 11, SCREEN_WIDTH + 100, i * 11, 0x00FF00);
+        draw_line(i * 19, -100, i * 19, SCREEN_HEIGHT + 100, 0x0000FF);
+    }
+}
+
+static void render_prims_circles(void) {
+    for (int i = 0; i < 300; i++) {
+        int x = prim_rand(-100, SCREEN_WIDTH + 100);
+        int y = prim_rand(-100, SCREEN_HEIGHT + 100);
+        int r = prim_rand(10, 130);
+        uint32_t color = prim_color();
+        if (i & 1) {
+            draw_circle(x, y, r, color);
+        } else {
+            draw_circle_border(x, y, r, color);
+        }
+    }
+}
+
+static void render_prims_rounded(void) {
+    for (int i = 0; i < 300; i++) {
+        int x = prim_rand(-100, SCREEN_WIDTH + 100);
+        int y = prim_rand(-100, SCREEN_HEIGHT + 100);
+        int w = prim_rand(40, 340), h = prim_rand(30, 230);
+        draw_rounded_rect(x, y, w, h, prim_rand(4, 28), prim_color());
+    }
+}
+
+static void setup_splash(void) {
+    init_splash_screen();
+    update_boot_progress(42);
+}
+
+static void setup_status_bar(void) {
+    init_status_bar();
+}
+
+// Battery and volume change, then a minute goes by
+static void change_status(void) {
+    update_battery_status(15, true);
+    update_volume(0, true);
+    status_bar_tick(1000);
+    status_bar_tick(60999);
+    status_bar_tick(61000);
+}
+
+// Drawn from scratch with the changes already made
+static void setup_status_bar_fresh(void) {
+    init_status_bar();
+    change_status();
+}
+
+static uint32_t status_dirty_before_minute = 0;
+
+// Drawn once, then changed: only the changed fields repaint
+static void setup_status_bar_update(void) {
+    init_status_bar();
+    render_enhanced_status_bar();
+    update_battery_status(15, true);
+    update_volume(0, true);
+    status_bar_tick(1000);
+    status_bar_tick(60999);
+    status_dirty_before_minute = status_bar_dirty_fields();
+    status_bar_tick(61000);
+}
+
+static void render_status_bar_update(void) {
+    uint32_t dirty = status_bar_dirty_fields();
+    render_enhanced_status_bar();
+    if (status_dirty_before_minute != (STATUS_FIELD_BATTERY | STATUS_FIELD_VOLUME) ||
+        dirty != (STATUS_FIELD_BATTERY | STATUS_FIELD_VOLUME | STATUS_FIELD_TIME)) {
+        check_failed("status_bar_update: dirty fields %x, then %x", status_dirty_before_minute, dirty);
+    }
+}
+
+// Cold frames start from a fresh app state, so everything is repainted
+static void setup_launcher(void) {
+    init_animation_system();
+    launcher_init();
+}
+
+// A wallpaper replaced after the launcher drew the old one must repaint the
+// whole screen, though it is decoded into the same buffer
+static void load_test_wallpaper(uint32_t top, uint32_t bottom) {
+    static uint8_t file[TEST_IMAGE_MAX];
+    uint32_t rgb[16 * 9];
+    for (int i = 0; i < 16 * 9; i++) rgb[i] = i < 16 * 5 ? top : bottom;
+    wallpaper_load_memory(file, make_png(file, 16, 9, rgb, NULL));
+}
+
+static void setup_launcher_wallpaper(void) {
+    load_test_wallpaper(0x203050, 0x502030);
+    setup_launcher();
+}
+
+static void setup_launcher_wallpaper_change(void) {
+    load_test_wallpaper(0x305020, 0x205030);
+    setup_launcher();
+    launcher_ui_loop();
+    load_test_wallpaper(0x203050, 0x502030);
+}
+
+// Later scenes expect the default background
+static void render_launcher_wallpaper(void) {
+    launcher_ui_loop();
+    wallpaper_clear();
+}
+
+// Idle frames replay a frame that already matches the screen
+static void setup_launcher_idle(void) {
+    setup_launcher();
+    launcher_ui_loop();
+}
+
+// Finger down on the first icon: found through the hit-test index and shown pressed
+static void setup_launcher_press(void) {
+    touch_sample_t down = { timer_now_us(), 1760, 100, 0, TOUCH_DOWN };
+    setup_launcher_idle();
+    handle_launcher_touch(&down);
+}
+
+// Search overlay after typing "ca": name matches, shortest name first
+static void setup_launcher_search(void) {
+    gesture_event_t swipe = { .type = GESTURE_SWIPE_DOWN };
+    setup_launcher();
+    launcher_handle_gesture(&swipe);
+    launcher_update_search("c");
+    launcher_update_search("ca");
+}
+
+// Page drag in progress, half a frame after the last sample: the grid is drawn
+// where the finger is predicted to be at present time
+static void setup_launcher_drag(void) {
+    setup_launcher_idle();
+    for (int i = 0; i <= 6; i++) {
+        touch_sample_t move = { timer_now_us(), (int16_t)(2400 - 40 * i), 600, 0, i ? TOUCH_MOVE : TOUCH_DOWN };
+        handle_launcher_touch(&move);
+        launcher_ui_loop();
+        host_advance_ms(i < 6 ? 16 : 8);
+    }
+}
+
+// Touches 3..13 ms old at dispatch, presented 6..16 ms later; a few stragglers
+static void setup_latency_hud(void) {
+    latency_init();
+    latency_set_hud(true);
+    for (int i = 0; i < 40; i++) {
+        uint32_t input_us = timer_now_us();
+        host_advance_ms(3 + i % 11);
+        latency_input_dispatched(input_us);
+        host_advance_ms(i % 9 == 0 ? 40 : 6 + i % 11);
+        latency_frame_presented(timer_now_us());
+    }
+    latency_dump_serial();
+}
+
+static void render_latency_hud(void) {
+    draw_latency_hud(20, 20);
+}
+
+static void setup_keyboard(void) {
+    init_virtual_keyboard();
+}
+
+// Only the pressed key is repainted, on top of the cached keyboard
+static void setup_keyboard_drawn(void) {
+    setup_keyboard();
+    draw_virtual_keyboard();
+}
+
+static void render_keyboard_press(void) {
+    virtual_keyboard_press(1000, 1950, NULL);
+}
+
+// Lifting restores the key from the cache; nothing of the highlight is left
+static void render_keyboard_release(void) {
+    virtual_keyboard_press(1000, 1950, NULL);
+    virtual_keyboard_release(NULL);
+}
+
+// ?123 switches the whole keyboard when the finger lifts
+static void render_keyboard_symbols(void) {
+    virtual_keyboard_press(200, 2100, NULL);
+    virtual_keyboard_release(NULL);
+}
+
+static void setup_explorer(void) {
+    init_animation_system();
+    file_explorer_init();
+}
+
+// Reopening the directory on the way is served from the directory cache
+static void setup_explorer_idle(void) {
+    file_list_stats_t before, after;
+    uint32_t inode;
+
+    setup_explorer();
+    file_list_get_stats(&before);
+    file_explorer_refresh();
+    file_list_get_stats(&after);
+    if (after.cached_opens != before.cached_opens + 1 || !file_list_identity(&inode)) {
+        check_failed("explorer_idle: the sample directory was read again, not cached");
+    }
+    file_explorer_ui_loop();
+}
+
+// A generated directory too big for any fixed-size table but the sort's
+static int huge_dir_reads = 0;
+static int huge_dir_size = HUGE_DIR_ENTRIES;
+
+static int huge_dir_open(const char *path, void **dir) {
+    (void)path;
+    *dir = &huge_dir_reads;
+    return 0;
+}
+
+static int huge_dir_count(void *dir) {
+    (void)dir;
+    return huge_dir_size;
+}
+
+static int huge_dir_read(void *dir, int index, file_entry_t *out) {
+    static char name[32];
+    (void)dir;
+    if (index < 0 || index >= huge_dir_size) return -1;
+    snprintf(name, sizeof(name), "%s%06d.%s", index % 7 ? "file" : "photo", index, index % 7 ? "txt" : "raw");
+    out->name = name;
+    out->type = index % 7 ? FILE_TYPE_TEXT : FILE_TYPE_UNKNOWN;
+    out->size = (uint64_t)index * 37;
+    out->modified_time = 0;
+    huge_dir_reads++;
+    host_clock_us++;            // Reading an entry takes a microsecond
+    return 0;
+}
+
+static const dir_source_t huge_dir = { huge_dir_open, huge_dir_count, huge_dir_read, NULL, NULL };
+
+// The same entries, but the count is only known once they have all been read
+static const dir_source_t huge_stream = { huge_dir_open, NULL, huge_dir_read, NULL, NULL };
+
+// Opening it and jumping to the end shows it unsorted while it is enumerated;
+// the frame reads only the pages on screen
+static void setup_explorer_huge(void) {
+    setup_explorer();
+    huge_dir_size = HUGE_DIR_ENTRIES;
+    file_explorer_set_source(&huge_dir);
+    file_explorer_handle_input(9, 0, 0);
+    huge_dir_reads = 0;
+}
+
+static void render_explorer_huge(void) {
+    file_explorer_ui_loop();
+    if (huge_dir_reads > 2 * FILE_LIST_PAGE_SIZE || !file_list_busy()) {
+        check_failed("explorer_huge: %d entries read for one screen, %s", huge_dir_reads,
+                     file_list_busy() ? "still loading" : "already sorted");
+    }
+}
+
+static void idle_app_loop(void) {}
+
+// Put the explorer behind another app, where only the scheduler drives it
+static void explorer_to_background(void) {
+    init_apps();
+    register_app("Launcher", idle_app_loop, idle_app_loop, 1);
+    register_app("File Explorer", file_explorer_ui_loop, file_explorer_background_loop, 1);
+    app_set_suspend_ops(1, &file_explorer_suspend_ops);
+    switch_app(1);
+    switch_app(0);
+}
+
+// Scheduler rounds until the list behind the front app is sorted; false if
+// it made no progress, which would spin forever
+static bool scheduler_sort_list(void) {
+    for (int round = 0; file_list_busy(); round++) {
+        if (round > 100000) return false;
+        run_scheduler_round();
+    }
+    return true;
+}
+
+// One entry past the sort's capacity, streamed or counted up front: listed
+// whole, in source order, and marked as such
+static void check_explorer_unsortable(const dir_source_t *src) {
+    file_list_stats_t before, after;
+    file_entry_t row;
+    char first[32], last[32];
+
+    huge_dir_size = FILE_LIST_MAX_SORTED + 1;
+    file_list_get_stats(&before);
+    file_explorer_set_source(src);
+    scheduler_sort_list();
+    file_list_get_stats(&after);
+
+    huge_dir_read(NULL, 0, &row);
+    snprintf(first, sizeof(first), "%s", row.name);
+    huge_dir_read(NULL, FILE_LIST_MAX_SORTED, &row);
+    snprintf(last, sizeof(last), "%s", row.name);
+    if (file_list_count() != FILE_LIST_MAX_SORTED + 1 || after.sorts != before.sorts ||
+        !file_list_unsorted() ||
+        !file_list_get(0, &row) || strcmp(row.name, first) != 0 ||
+        !file_list_get(FILE_LIST_MAX_SORTED, &row) || strcmp(row.name, last) != 0) {
+        check_failed("explorer_huge_sorted: %d entries over the sort's capacity not in source order",
+                     file_list_count());
+    }
+    huge_dir_size = HUGE_DIR_ENTRIES;
+}
+
+// Streamed from a source of unknown size, cancelled by a refresh halfway,
+// then sorted by the scheduler while another app is in front, and shown
+// from the end once the explorer is back
+static void setup_explorer_huge_sorted(void) {
+    file_list_stats_t before, after;
+
+    setup_explorer();
+    huge_dir_size = HUGE_DIR_ENTRIES;
+    explorer_to_background();
+    check_explorer_unsortable(&huge_dir);
+    check_explorer_unsortable(&huge_stream);
+    file_list_get_stats(&before);
+
+    file_explorer_set_source(&huge_stream);
+    if (file_list_count() <= 0 || file_list_count() >= HUGE_DIR_ENTRIES) {
+        check_failed("explorer_huge_sorted: count should grow while streaming");
+    }
+    for (int i = 0; i < 5; i++) {
+        run_scheduler_round();
+    }
+    file_explorer_refresh();
+    if (!scheduler_sort_list()) check_failed("explorer_huge_sorted: never sorted behind the launcher");
+
+    file_list_get_stats(&after);
+    if (after.cancelled == before.cancelled) check_failed("explorer_huge_sorted: refresh didn't cancel");
+    if (file_list_count() != HUGE_DIR_ENTRIES || file_list_unsorted()) {
+        check_failed("explorer_huge_sorted: wrong count, or left unsorted");
+    }
+
+    char prev[32] = "";
+    for (int i = 0; i < HUGE_DIR_ENTRIES; i++) {
+        file_entry_t entry;
+        if (!file_list_get(i, &entry) || strcmp(prev, entry.name) >= 0) {
+            check_failed("explorer_huge_sorted: rows out of order");
+            break;
+        }
+        snprintf(prev, sizeof(prev), "%s", entry.name);
+    }
+    switch_app(1);
+    file_explorer_handle_input(9, 0, 0);
+}
+
+// Too big to sort: the status bar says it is listed unsorted
+static void setup_explorer_unsorted(void) {
+    setup_explorer();
+    huge_dir_size = FILE_LIST_MAX_SORTED + 1;
+    file_explorer_set_source(&huge_dir);
+    while (file_list_pump(1000000)) {}
+}
+
+static void render_explorer_unsorted(void) {
+    file_explorer_ui_loop();
+    if (!file_list_unsorted() || file_list_count() != FILE_LIST_MAX_SORTED + 1) {
+        check_failed("explorer_unsorted: %d entries not reported unsorted", file_list_count());
+    }
+}
+
+// A directory whose changes the filesystem reports to the directory cache
+#define WATCHED_DIR_INODE 42
+#define WATCHED_DIR_MAX   8
+
+static struct {
+    char name[16];
+    file_type_t type;
+    uint64_t size;
+} watched_files[WATCHED_DIR_MAX];
+static int watched_count = 0;
+static int watched_reads = 0;
+static uint32_t watched_generation = 0;     // Never reset: the cache outlives a scene
+
+static int watched_open(const char *path, void **dir) {
+    (void)path;
+    *dir = watched_files;
+    return 0;
+}
+
+static int watched_count_fn(void *dir) {
+    (void)dir;
+    return watched_count;
+}
+
+static int watched_read(void *dir, int index, file_entry_t *out) {
+    (void)dir;
+    if (index < 0 || index >= watched_count) return -1;
+    out->name = watched_files[index].name;
+    out->type = watched_files[index].type;
+    out->size = watched_files[index].size;
+    out->modified_time = 0;
+    watched_reads++;
+    return 0;
+}
+
+static int watched_identify(void *dir, uint32_t *inode, uint32_t *generation) {
+    (void)dir;
+    *inode = WATCHED_DIR_INODE;
+    *generation = watched_generation;
+    return 0;
+}
+
+static const dir_source_t watched_dir = { watched_open, watched_count_fn, watched_read, NULL, watched_identify };
+
+static void watched_add(const char *name, file_type_t type, uint64_t size) {
+    snprintf(watched_files[watched_count].name, sizeof(watched_files[0].name), "%s", name);
+    watched_files[watched_count].type = type;
+    watched_files[watched_count].size = size;
+    watched_count++;
+}
+
+// Change the directory the way the filesystem would, and tell the cache
+static void watched_change(dircache_event_type_t type, const char *name, file_type_t file_type, uint64_t size) {
+    int index = 0;
+    while (index < watched_count && strcmp(watched_files[index].name, name) != 0) index++;
+    if (type == DIRCACHE_CREATED) {
+        watched_add(name, file_type, size);
+    } else if (type == DIRCACHE_DELETED) {
+        watched_files[index] = watched_files[--watched_count];
+    } else {
+        watched_files[index].size = size;
+    }
+
+    dircache_entry_t entry = { name, (uint8_t)file_type, size, 0 };
+    dircache_notify(WATCHED_DIR_INODE, ++watched_generation, type, &entry);
+}
+
+static dircache_stats_t watch_before;
+
+// Listed once, then changed three times behind the explorer's back
+static void setup_explorer_watch(void) {
+    setup_explorer();
+    watched_count = 0;
+    watched_add("..", FILE_TYPE_FOLDER, 0);
+    watched_add("Music", FILE_TYPE_FOLDER, 0);
+    watched_add("b.txt", FILE_TYPE_TEXT, 100);
+    watched_add("d.txt", FILE_TYPE_TEXT, 200);
+    watched_generation++;
+    file_explorer_set_source(&watched_dir);
+    file_explorer_ui_loop();
+
+    dircache_get_stats(&watch_before);
+    watched_reads = 0;
+    watched_change(DIRCACHE_CREATED, "c.txt", FILE_TYPE_TEXT, 300);
+    watched_change(DIRCACHE_DELETED, "b.txt", FILE_TYPE_TEXT, 0);
+    watched_change(DIRCACHE_MODIFIED, "d.txt", FILE_TYPE_TEXT, 4096);
+}
+
+// The explorer picks the changes up from its watch and relists from the
+// patched cache without reading the directory again
+static void render_explorer_watch(void) {
+    file_explorer_ui_loop();
+
+    dircache_stats_t after;
+    dircache_get_stats(&after);
+    file_entry_t third;
+    bool ok = watched_reads == 0 && after.patched == watch_before.patched + 3 &&
+              after.hits > watch_before.hits && file_list_count() == 4 &&
+              file_list_get(2, &third) && strcmp(third.name, "c.txt") == 0;
+    if (!ok) {
+        check_failed("explorer_watch: %d entries reread, %u changes patched, %d rows", watched_reads,
+                     after.patched - watch_before.patched, file_list_count());
+    }
+}
+
+// Second row selected, with its bounce animation already over
+static void setup_explorer_select(void) {
+    setup_explorer();
+    file_explorer_handle_input(2, 0, 0);
+    host_advance_ms(1000);
+}
+
+// The same selection, after the scheduler suspended the explorer for sitting
+// idle behind another app, and switched back to: it has to come back exactly
+// as it was
+static void setup_explorer_resumed(void) {
+    setup_explorer_select();
+    explorer_to_background();
+
+    // Scheduler rounds a frame apart, until just short of the idle time
+    int rounds = 0;
+    for (; rounds * 16 < APP_SUSPEND_IDLE_MS - 16; rounds++) {
+        run_scheduler_round();
+        host_advance_ms(16);
+    }
+    if (apps[1].state != TASK_UI_PAUSED) {
+        check_failed("explorer_resumed: suspended after %d ms", rounds * 16);
+    }
+    for (int i = 0; i < 4 && apps[1].state == TASK_UI_PAUSED; i++) {
+        host_advance_ms(16);
+        run_scheduler_round();
+    }
+
+    app_manager_stats_t stats;
+    app_manager_get_stats(&stats);
+    bool ok = stats.suspended == 1 && apps[1].state == TASK_SUSPENDED && apps[0].state == TASK_UI_ACTIVE &&
+              file_list_count() == 0 && stats.snapshot_bytes < stats.raw_bytes;
+    if (!ok) {
+        check_failed("explorer_resumed: %u suspended, %u of %u snapshot bytes kept, %d rows left",
+                     stats.suspended, stats.snapshot_bytes, stats.raw_bytes, file_list_count());
+    }
+
+    switch_app(1);
+    app_manager_get_stats(&stats);
+    if (apps[1].state != TASK_UI_ACTIVE || stats.resumed != 1 || stats.restore_failed ||
+        stats.snapshot_bytes != 0) {
+        check_failed("explorer_resumed: resume failed");
+    }
+}
+
+// Mid-bounce: the previous animation frame is on screen and must be erased
+static void setup_explorer_bounce(void) {
+    setup_explorer_idle();
+    file_explorer_handle_input(2, 0, 0);
+    host_advance_ms(100);
+    file_explorer_ui_loop();
+    host_advance_ms(100);
+}
+
+// The frame after the bounce ends must leave nothing behind
+static void setup_explorer_bounce_done(void) {
+    setup_explorer_bounce();
+    file_explorer_ui_loop();
+    host_advance_ms(1000);
+}
+
+static const render_scene_t scenes[] = {
+    { "prims_lines",         setup_prims,                render_prims_lines,            NULL },
+    { "prims_circles",       setup_prims,                render_prims_circles,          NULL },
+    { "prims_rounded",       setup_prims,                render_prims_rounded,          NULL },
+    { "splash",              setup_splash,               render_enhanced_splash_screen, NULL },
+    { "status_bar",          setup_status_bar,           render_enhanced_status_bar,    NULL },
+    { "status_bar_fresh",    setup_status_bar_fresh,     render_enhanced_status_bar,    NULL },
+    { "status_bar_update",   setup_status_bar_update,    render_status_bar_update,      "status_bar_fresh" },
+    { "launcher",            setup_launcher,             launcher_ui_loop,              NULL },
+    { "launcher_idle",       setup_launcher_idle,        launcher_ui_loop,              "launcher" },
+    { "launcher_press",      setup_launcher_press,       launcher_ui_loop,              NULL },
+    { "launcher_drag",       setup_launcher_drag,        launcher_ui_loop,              NULL },
+    { "launcher_search",     setup_launcher_search,      launcher_ui_loop,              NULL },
+    { "launcher_wallpaper",  setup_launcher_wallpaper,   render_launcher_wallpaper,     NULL },
+    { "launcher_wp_change",  setup_launcher_wallpaper_change, render_launcher_wallpaper, "launcher_wallpaper" },
+    { "latency_hud",         setup_latency_hud,          render_latency_hud,            NULL },
+    { "keyboard",            setup_keyboard,             draw_virtual_keyboard,         NULL },
+    { "keyboard_press",      setup_keyboard_drawn,       render_keyboard_press,         NULL },
+    { "keyboard_release",    setup_keyboard_drawn,       render_keyboard_release,       "keyboard" },
+    { "keyboard_symbols",    setup_keyboard_drawn,       render_keyboard_symbols,       NULL },
+    { "explorer",            setup_explorer,             file_explorer_ui_loop,         NULL },
+    { "explorer_idle",       setup_explorer_idle,        file_explorer_ui_loop,         "explorer" },
+    { "explorer_select",     setup_explorer_select,      file_explorer_ui_loop,         NULL },
+    { "explorer_resumed",    setup_explorer_resumed,     file_explorer_ui_loop,         "explorer_select" },
+    { "explorer_bounce",     setup_explorer_bounce,      file_explorer_ui_loop,         NULL },
+    { "explorer_huge",       setup_explorer_huge,        render_explorer_huge,          NULL },
+    { "explorer_huge_sorted", setup_explorer_huge_sorted, file_explorer_ui_loop,         NULL },
+    { "explorer_unsorted",   setup_explorer_unsorted,    render_explorer_unsorted,      NULL },
+    { "explorer_watch",      setup_explorer_watch,       render_explorer_watch,         NULL },
+    { "explorer_bounce_end", setup_explorer_bounce_done, file_explorer_ui_loop,         "explorer_select" },
+};
+
+#define SCENE_COUNT ((int)(sizeof(scenes) / sizeof(scenes[0])))
+
+// =============================================================================
+// Helpers
+// =============================================================================
+
+static uint32_t framebuffer_crc(void) {
+    return crc32_buffer(host_framebuffer, sizeof(host_framebuffer));
+}
+
+// Write the framebuffer as a binary PPM (alpha byte dropped)
+static int dump_frame(const char *name) {
+    static uint8_t row[SCREEN_WIDTH * 3];
+    char path[256];
+
+    mkdir("build", 0755);
+    mkdir(RENDER_OUT_DIR, 0755);
+    snprintf(path, sizeof(path), "%s/%s.ppm", RENDER_OUT_DIR, name);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+
+    fprintf(f, "P6\n%d %d\n255\n", SCREEN_WIDTH, SCREEN_HEIGHT);
+    for (int y = 0; y < SCREEN_HEIGHT; y++) {
+        const uint32_t *src = &host_framebuffer[y * SCREEN_WIDTH];
+        for (int x = 0; x < SCREEN_WIDTH; x++) {
+            row[x * 3 + 0] = (uint8_t)(src[x] >> 16);
+            row[x * 3 + 1] = (uint8_t)(src[x] >> 8);
+            row[x * 3 + 2] = (uint8_t)src[x];
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    fclose(f);
+    return 0;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+// Golden file: one "name crc ms" line per scene, '#' starts a comment
+static int load_golden(const char *path, golden_entry_t *entries, int max) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    char line[128];
+    int count = 0;
+    while (count < max && fgets(line, sizeof(line), f)) {
+        golden_entry_t *e = &entries[count];
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (sscanf(line, "%31s %x %lf", e->name, &e->crc, &e->ms) == 3) {
+            count++;
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+static int save_golden(const char *path, const golden_entry_t *entries, int count) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+
+    fprintf(f, "# Golden framebuffer CRCs and reference median render time (ms)\n");
+    fprintf(f, "# Regenerate with: make render-test RENDER_FLAGS=--update\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(f, "%-20s %08x %.3f\n", entries[i].name, entries[i].crc, entries[i].ms);
+    }
+    fclose(f);
+    return 0;
+}
+
+static const golden_entry_t *find_golden(const golden_entry_t *entries, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(entries[i].name, name) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+// Render one scene RENDER_ITERATIONS times; returns false if frames differ
+static bool run_scene(const render_scene_t *scene, golden_entry_t *result) {
+    double times[RENDER_ITERATIONS];
+    bool stable = true;
+
+    for (int i = 0; i < RENDER_ITERATIONS; i++) {
+        memset(host_framebuffer, 0, sizeof(host_framebuffer));
+        reset_clip_rect();
+        check_quiet = i > 0;
+        scene->setup();
+
+        uint64_t start = host_now_ns();
+        scene->render();
+        times[i] = (double)(host_now_ns() - start) / 1e6;
+        check_quiet = false;
+
+        uint32_t crc = framebuffer_crc();
+        if (i == 0) {
+            result->crc = crc;
+        } else if (crc != result->crc) {
+            stable = false;
+        }
+    }
+
+    qsort(times, RENDER_ITERATIONS, sizeof(double), compare_double);
+    snprintf(result->name, sizeof(result->name), "%s", scene->name);
+    result->ms = times[RENDER_ITERATIONS / 2];
+    return stable;
+}
+
+// =============================================================================
+// Gesture traces
+// =============================================================================
+
+// Each trace file holds one "expect" line naming the gestures it must produce
+// in order (NONE for none; continuous PAN and PINCH updates aren't listed),
+// then "time_ms id down|move|up x y" samples as the touch driver queues them.
+static const char *const traces[] = {
+    "tap", "double_tap", "long_press", "fling_left", "fling_down",
+    "slow_drag", "pinch_out", "pinch_in", "pinch_abandoned",
+};
+
+#define TRACE_COUNT ((int)(sizeof(traces) / sizeof(traces[0])))
+
+typedef struct {
+    char expect[128];
+    touch_sample_t samples[TRACE_MAX_SAMPLES];
+    int count;
+} touch_trace_t;
+
+static int load_trace(const char *path, touch_trace_t *trace) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    char line[128];
+    trace->expect[0] = '\0';
+    trace->count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        char event[8];
+        unsigned time_ms;
+        int id, x, y;
+
+        if (line[0] == '#' || line[0] == '\n') continue;
+        if (strncmp(line, "expect ", 7) == 0) {
+            snprintf(trace->expect, sizeof(trace->expect), "%s", line + 7);
+            trace->expect[strcspn(trace->expect, "\r\n")] = '\0';
+            continue;
+        }
+        if (trace->count >= TRACE_MAX_SAMPLES ||
+            sscanf(line, "%u %d %7s %d %d", &time_ms, &id, event, &x, &y) != 5) {
+            continue;
+        }
+
+        touch_sample_t *sample = &trace->samples[trace->count++];
+        sample->time_us = time_ms * 1000;
+        sample->id = (uint8_t)id;
+        sample->x = (int16_t)x;
+        sample->y = (int16_t)y;
+        sample->type = strcmp(event, "down") == 0 ? TOUCH_DOWN :
+                       strcmp(event, "up") == 0 ? TOUCH_UP : TOUCH_MOVE;
+    }
+    fclose(f);
+    return 0;
+}
+
+static void note_gesture(char *out, size_t size, const gesture_event_t *ev) {
+    if (ev->type == GESTURE_PAN || ev->type == GESTURE_PINCH) return;
+    size_t len = strlen(out);
+    snprintf(out + len, size - len, "%s%s", len ? " " : "", gesture_name(ev->type));
+}
+
+// Replay a trace, polling once per frame between samples like a UI loop would
+static void replay_trace(const touch_trace_t *trace, char *got, size_t size, char *detail, size_t detail_size) {
+    gesture_recognizer_t rec;
+    gesture_event_t events[GESTURE_MAX_EVENTS];
+    uint32_t next_frame = 0;
+
+    gesture_init(&rec);
+    got[0] = '\0';
+    detail[0] = '\0';
+    for (int i = 0; i < trace->count; i++) {
+        const touch_sample_t *sample = &trace->samples[i];
+        for (; next_frame < sample->time_us; next_frame += TRACE_FRAME_US) {
+            if (gesture_poll(&rec, next_frame, events)) note_gesture(got, size, &events[0]);
+        }
+
+        int n = gesture_feed(&rec, sample, events);
+        for (int k = 0; k < n; k++) {
+            note_gesture(got, size, &events[k]);
+            if (events[k].vx || events[k].vy) {
+                snprintf(detail, detail_size, "v=%d,%d px/s", events[k].vx, events[k].vy);
+            } else if (events[k].type == GESTURE_PINCH_IN || events[k].type == GESTURE_PINCH_OUT) {
+                snprintf(detail, detail_size, "scale=%.2f", events[k].scale / 65536.0);
+            }
+        }
+    }
+    if (!got[0]) snprintf(got, size, "NONE");
+}
+
+// Returns the number of traces that failed
+static int run_traces(void) {
+    static touch_trace_t trace;
+    int failures = 0;
+
+    printf("%-20s %-24s %s\n", "trace", "gestures", "result");
+    for (int i = 0; i < TRACE_COUNT; i++) {
+        char path[256], got[128], detail[64];
+        const char *status = "ok";
+
+        snprintf(path, sizeof(path), "%s/%s.trace", TRACE_DIR, traces[i]);
+        if (load_trace(path, &trace) < 0) {
+            status = "FAIL (cannot read trace)";
+            got[0] = detail[0] = '\0';
+        } else {
+            replay_trace(&trace, got, sizeof(got), detail, sizeof(detail));
+            if (strcmp(got, trace.expect) != 0) status = "FAIL (expected different gestures)";
+        }
+
+        failures += status[0] == 'F';
+        printf("%-20s %-24s %s%s%s\n", traces[i], got, status, detail[0] ? "  " : "", detail);
+        if (status[0] == 'F' && trace.expect[0]) printf("%-20s expected: %s\n", "", trace.expect);
+    }
+    printf("\n");
+    return failures;
+}
+
+// =============================================================================
+// App search
+// =============================================================================
+
+// Each query is typed a character at a time against the launcher's apps plus
+// SEARCH_FILLER_APPS generated ones; the best match after the last character
+// must be `expect` (NULL: nothing may match)
+static const struct {
+    const char *query;
+    const char *expect;
+} searches[] = {
+    { "cam",        "Camera" },
+    { "se",         "Settings" },
+    { "store",      "App Store" },      // Later word of the name
+    { "appstore",   "App Store" },      // Keyword (executable name)
+    { "ulator",     "Calculator" },     // Inside a word
+    { "setings",    "Settings" },       // Typos
+    { "calcualtor", "Calculator" },
+    { "zzzz",       NULL },
+};
+
+#define SEARCH_COUNT ((int)(sizeof(searches) / sizeof(searches[0])))
+
+static const char *const search_apps[][2] = {
+    { "Phone", "phone" }, { "Messages", "messages" }, { "Mail", "mail" }, { "Safari", "safari" },
+    { "Camera", "camera" }, { "Photos", "photos" }, { "Maps", "maps" }, { "Weather", "weather" },
+    { "Clock", "clock" }, { "Calculator", "calculator" }, { "Settings", "settings" }, { "Files", "files" },
+    { "Music", "music" }, { "Notes", "notes" }, { "Contacts", "contacts" }, { "App Store", "appstore" },
+};
+
+#define SEARCH_APP_COUNT ((int)(sizeof(search_apps) / sizeof(search_apps[0])))
+
+// Returns the number of searches that failed
+static int run_searches(void) {
+    static const char *const filler_words[] = { "Widget", "Kiosk", "Bolt", "Quill", "Jolly", "Vortex", "Pixel", "Drum" };
+    static char filler_names[SEARCH_FILLER_APPS][24];
+    int failures = 0;
+
+    app_search_clear();
+    for (int i = 0; i < SEARCH_APP_COUNT; i++) {
+        app_search_add(i, search_apps[i][0], search_apps[i][1]);
+    }
+    for (int i = 0; i < SEARCH_FILLER_APPS; i++) {
+        snprintf(filler_names[i], sizeof(filler_names[i]), "%s %s %d",
+                 filler_words[i % 8], filler_words[(i / 8) % 8], i);
+        app_search_add(SEARCH_APP_COUNT + i, filler_names[i], NULL);
+    }
+    // Build the index up front so the timings are per keystroke
+    app_search_query("", NULL, 0);
+
+    printf("%-20s %-16s %8s  %s\n", "search", "best match", "worst us", "result");
+    for (int i = 0; i < SEARCH_COUNT; i++) {
+        search_result_t results[SEARCH_MAX_RESULTS];
+        char typed[SEARCH_QUERY_MAX];
+        int count = 0;
+        double worst_us = 0;
+
+        for (int len = 1; searches[i].query[len - 1]; len++) {
+            snprintf(typed, sizeof(typed), "%.*s", len, searches[i].query);
+            uint64_t start = host_now_ns();
+            count = app_search_query(typed, results, SEARCH_MAX_RESULTS);
+            double us = (double)(host_now_ns() - start) / 1e3;
+            if (us > worst_us) worst_us = us;
+        }
+
+        const char *best = count == 0 ? "NONE" :
+                           results[0].id < SEARCH_APP_COUNT ? search_apps[results[0].id][0] :
+                           filler_names[results[0].id - SEARCH_APP_COUNT];
+        const char *expect = searches[i].expect ? searches[i].expect : "NONE";
+        const char *status = strcmp(best, expect) == 0 ? "ok" : "FAIL (expected different match)";
+
+        failures += status[0] == 'F';
+        printf("%-20s %-16s %8.1f  %s\n", searches[i].query, best, worst_us, status);
+        if (status[0] == 'F') printf("%-20s expected: %s\n", "", expect);
+    }
+
+    app_search_stats_t stats;
+    app_search_get_stats(&stats);
+    printf("%u entries, %u postings; %u of %u queries extended the previous one\n\n",
+           stats.entries, stats.postings, stats.incremental, stats.queries);
+    return failures;
+}
+
+// =============================================================================
+// Unit checks
+// =============================================================================
+
+// Modules checked directly rather than through a screen; each reports through
+// check_failed() and may print what it measured
+
+// A full-screen list of overlapping shapes, repainted through the tile path
+#define TILE_BENCH_WORKERS  4
+#define TILE_BENCH_FRAMES   5
+
+static display_list_t tile_bench_list;
+static volatile bool tile_workers_stop = false;
+
+static void *tile_worker_main(void *arg) {
+    int id = tile_raster_add_worker();
+    (void)arg;
+    while (!__atomic_load_n(&tile_workers_stop, __ATOMIC_ACQUIRE)) {
+        tile_raster_worker_poll(id);
+    }
+    return NULL;
+}
+
+static void *tile_register_main(void *arg) {
+    *(int *)arg = tile_raster_add_worker();
+    return NULL;
+}
+
+// Repaint the bench list from scratch; returns the median ms per frame
+static double tile_bench_frame(uint32_t *crc) {
+    double times[TILE_BENCH_FRAMES];
+    for (int f = 0; f < TILE_BENCH_FRAMES; f++) {
+        memset(host_framebuffer, 0, sizeof(host_framebuffer));
+        dl_invalidate(&tile_bench_list);
+        uint64_t start = host_now_ns();
+        dl_submit(&tile_bench_list);
+        times[f] = (double)(host_now_ns() - start) / 1e6;
+    }
+    *crc = framebuffer_crc();
+    qsort(times, TILE_BENCH_FRAMES, sizeof(double), compare_double);
+    return times[TILE_BENCH_FRAMES / 2];
+}
+
+// Scaling from the boot CPU alone to TILE_BENCH_WORKERS more threads; every
+// worker count must produce the single-core frame
+static void unit_tile_raster(void) {
+    pthread_t threads[TILE_MAX_WORKERS * 2];
+    uint32_t single_crc = 0;
+    char line[160];
+    int len;
+
+    tile_raster_init();
+    reset_clip_rect();
+    prim_seed = 7;
+    dl_init(&tile_bench_list, 0x202020);
+    dl_begin(&tile_bench_list);
+    for (int i = 0; i < 200; i++) {
+        int x = prim_rand(-100, SCREEN_WIDTH), y = prim_rand(-100, SCREEN_HEIGHT);
+        if (i % 4 == 0) {
+            dl_circle(&tile_bench_list, x, y, prim_rand(20, 300), prim_color());
+        } else if (i % 4 == 1) {
+            dl_text(&tile_bench_list, x, y, "tiles", prim_color());
+        } else {
+            dl_rounded_rect(&tile_bench_list, x, y, prim_rand(50, 900), prim_rand(50, 600),
+                            prim_rand(4, 40), prim_color());
+        }
+    }
+    dl_end(&tile_bench_list);
+
+    double single_ms = tile_bench_frame(&single_crc);
+    len = snprintf(line, sizeof(line), "tile raster ms by cores: 1=%.2f", single_ms);
+
+    __atomic_store_n(&tile_workers_stop, false, __ATOMIC_RELEASE);
+    for (int n = 1; n <= TILE_BENCH_WORKERS; n++) {
+        pthread_create(&threads[n - 1], NULL, tile_worker_main, NULL);
+        while (tile_raster_worker_count() < n) {}
+
+        uint32_t crc;
+        double ms = tile_bench_frame(&crc);
+        len += snprintf(line + len, sizeof(line) - (size_t)len, " %d=%.2f", n + 1, ms);
+        if (crc != single_crc) {
+            check_failed("tile_raster: frame with %d workers differs from the single-core frame", n);
+        }
+    }
+    __atomic_store_n(&tile_workers_stop, true, __ATOMIC_RELEASE);
+    for (int n = 0; n < TILE_BENCH_WORKERS; n++) {
+        pthread_join(threads[n], NULL);
+    }
+    printf("%s (%ld host CPUs)\n", line, sysconf(_SC_NPROCESSORS_ONLN));
+
+    // More cores racing to register than there are worker ids
+    int ids[TILE_MAX_WORKERS * 2];
+    tile_raster_init();
+    for (int i = 0; i < TILE_MAX_WORKERS * 2; i++) {
+        pthread_create(&threads[i], NULL, tile_register_main, &ids[i]);
+    }
+    int registered = 0;
+    uint32_t seen = 0;
+    for (int i = 0; i < TILE_MAX_WORKERS * 2; i++) {
+        pthread_join(threads[i], NULL);
+        if (ids[i] > 0) {
+            registered++;
+            seen |= 1u << ids[i];
+        }
+    }
+    if (registered != TILE_MAX_WORKERS || tile_raster_worker_count() != TILE_MAX_WORKERS ||
+        seen != ((1u << (TILE_MAX_WORKERS + 1)) - 2)) {
+        check_failed("tile_raster: %d of %d cores registered, count %d", registered,
+                     TILE_MAX_WORKERS * 2, tile_raster_worker_count());
+    }
+    tile_raster_init();
+    memset(host_framebuffer, 0, sizeof(host_framebuffer));
+}
+
+// Decoded images land here, indexed by the row the decoder reports
+#define DECODE_MAX_SIDE     16
+
+static struct {
+    int width, height;
+    int rows;
+    uint32_t pixels[DECODE_MAX_SIDE * DECODE_MAX_SIDE];
+} decoded;
+
+static int decode_begin(void *ctx, int width, int height) {
+    (void)ctx;
+    if (width > DECODE_MAX_SIDE || height > DECODE_MAX_SIDE) return -1;
+    decoded.width = width;
+    decoded.height = height;
+    return 0;
+}
+
+static void decode_row(void *ctx, int y, const uint32_t *pixels, int width) {
+    (void)ctx;
+    memcpy(&decoded.pixels[y * width], pixels, (size_t)width * sizeof(uint32_t));
+    decoded.rows++;
+}
+
+static int decode_buffer(const uint8_t *data, size_t size) {
+    image_sink_t sink = { decode_begin, decode_row, NULL };
+    image_memory_reader_t reader = { data, size, 0 };
+    memset(&decoded, 0, sizeof(decoded));
+    return image_decode(image_memory_read, &reader, &sink);
+}
+
+static void fill_test_image(uint32_t *rgb, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            rgb[y * width + x] = (uint32_t)(x * 40) << 16 | (uint32_t)(y * 50) << 8 | (uint32_t)((x ^ y) * 30);
+        }
+    }
+}
+
+static bool decoded_matches(const uint32_t *rgb, int width, int height) {
+    if (decoded.width != width || decoded.height != height || decoded.rows != height) return false;
+    for (int i = 0; i < width * height; i++) {
+        if (decoded.pixels[i] != (0xFF000000u | rgb[i])) return false;
+    }
+    return true;
+}
+
+// Valid PNG and BMP decode exactly; truncated files and chunk lengths that
+// can't be right fail cleanly
+static void unit_image_decoder(void) {
+    static uint8_t file[TEST_IMAGE_MAX];
+    uint32_t rgb[7 * 5];
+    size_t idat_end;
+    int result;
+
+    fill_test_image(rgb, 7, 5);
+    size_t size = make_png(file, 7, 5, rgb, &idat_end);
+    if ((result = decode_buffer(file, size)) != IMAGE_OK || !decoded_matches(rgb, 7, 5)) {
+        check_failed("image_decoder: PNG decoded wrong (%d)", result);
+    }
+    // Rows are all out before the Adler-32 and CRC, which aren't verified
+    for (size_t cut = 0; cut < idat_end - 8; cut++) {
+        if ((result = decode_buffer(file, cut)) == IMAGE_OK) {
+            check_failed("image_decoder: PNG cut at %zu of %zu bytes decoded", cut, size);
+            break;
+        }
+    }
+
+    // An ancillary chunk whose length + 4 wraps to 0 used to be skipped as
+    // empty; one whose data runs past the end of the file
+    size_t ihdr_end = 8 + 25;
+    static uint8_t bad[TEST_IMAGE_MAX];
+    const uint32_t lengths[] = { 0xFFFFFFFCu, 0x80000000u, 0x7FFFFFF0u };
+    const int expect[] = { IMAGE_ERR_CORRUPT, IMAGE_ERR_CORRUPT, IMAGE_ERR_IO };
+    for (int i = 0; i < 3; i++) {
+        memcpy(bad, file, ihdr_end);
+        uint8_t *p = put_be32(bad + ihdr_end, lengths[i]);
+        memcpy(p, "tEXt", 4);
+        memcpy(p + 4, file + ihdr_end, size - ihdr_end);
+        if ((result = decode_buffer(bad, size + 8)) != expect[i]) {
+            check_failed("image_decoder: chunk length %08x gave %d, expected %d", lengths[i], result, expect[i]);
+        }
+    }
+
+    // The same for the image data's own length
+    memcpy(bad, file, size);
+    put_be32(bad + ihdr_end, 0xFFFFFFF0u);
+    if ((result = decode_buffer(bad, size)) == IMAGE_OK) {
+        check_failed("image_decoder: oversized IDAT length decoded");
+    }
+
+    size = make_bmp(file, 7, 5, rgb);
+    if ((result = decode_buffer(file, size)) != IMAGE_OK || !decoded_matches(rgb, 7, 5)) {
+        check_failed("image_decoder: BMP decoded wrong (%d)", result);
+    }
+    for (size_t cut = 0; cut < size; cut++) {
+        if (decode_buffer(file, cut) == IMAGE_OK) {
+            check_failed("image_decoder: BMP cut at %zu of %zu bytes decoded", cut, size);
+            break;
+        }
+    }
+}
+
+// Every load is a new generation, though the pixels stay in the same buffer
+static void unit_wallpaper(void) {
+    static uint8_t file[TEST_IMAGE_MAX];
+    uint32_t rgb[16 * 9];
+
+    for (int i = 0; i < 16 * 9; i++) rgb[i] = 0x336699;
+    size_t size = make_png(file, 16, 9, rgb, NULL);
+
+    uint32_t before = wallpaper_generation();
+    int result = wallpaper_load_memory(file, size);
+    const uint32_t *first = wallpaper_get_pixels();
+    if (result != IMAGE_OK || !first || first[0] != 0x336699 || wallpaper_generation() == before) {
+        check_failed("wallpaper: first load (%d)", result);
+    }
+
+    for (int i = 0; i < 16 * 9; i++) rgb[i] = 0x996633;
+    size = make_png(file, 16, 9, rgb, NULL);
+    uint32_t loaded = wallpaper_generation();
+    wallpaper_load_memory(file, size);
+    const uint32_t *second = wallpaper_get_pixels();
+    if (second != first || second[SCREEN_WIDTH * SCREEN_HEIGHT - 1] != 0x996633 ||
+        wallpaper_generation() == loaded) {
+        check_failed("wallpaper: second load not seen as a change");
+    }
+
+    loaded = wallpaper_generation();
+    if (wallpaper_load_memory(file, size / 2) == IMAGE_OK || wallpaper_get_pixels() ||
+        wallpaper_generation() == loaded) {
+        check_failed("wallpaper: failed load kept the old wallpaper");
+    }
+    wallpaper_clear();
+}
+
+// Every path is a 64x64 image of its own color
+#define THUMB_TEST_SIDE     64
+
+static uint8_t thumb_file[TEST_IMAGE_MAX];
+static image_memory_reader_t thumb_reader;
+static int thumb_opens = 0;
+
+static uint32_t thumb_test_color(const char *path) {
+    uint32_t c = 0;
+    while (*path) c = c * 131 + (uint8_t)*path++;
+    return c & 0xFFFFFF;
+}
+
+static int thumb_test_open(const char *path, void **handle) {
+    static uint32_t rgb[THUMB_TEST_SIDE * THUMB_TEST_SIDE];
+    for (int i = 0; i < THUMB_TEST_SIDE * THUMB_TEST_SIDE; i++) rgb[i] = thumb_test_color(path);
+    size_t size = make_png(thumb_file, THUMB_TEST_SIDE, THUMB_TEST_SIDE, rgb, NULL);
+    thumb_reader = (image_memory_reader_t){ thumb_file, size, 0 };
+    *handle = &thumb_reader;
+    thumb_opens++;
+    return 0;
+}
+
+static void thumb_test_close(void *handle) {
+    (void)handle;
+}
+
+static const thumbnail_source_t thumb_test_source = { thumb_test_open, image_memory_read, thumb_test_close };
+
+// Look a thumbnail up, generating it on a miss; true if it shows path's color
+static bool thumb_fetch(const char *path, uint64_t mtime) {
+    thumbnail_t thumb;
+    if (!thumbnail_cache_get(path, mtime, &thumb)) {
+        thumbnail_cache_pump(1000000);
+        if (!thumbnail_cache_get(path, mtime, &thumb)) return false;
+    }
+    return thumb.pixels[(THUMB_SIZE / 2) * THUMB_SIZE + THUMB_SIZE / 2] == thumb_test_color(path);
+}
+
+// The cache's FNV-1a, to make sure the colliding paths below still collide
+static uint32_t fnv1a(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint8_t thumb_saved[THUMB_CACHE_SLOTS * (16 + THUMB_PATH_MAX + THUMB_SIZE * THUMB_SIZE * 4)];
+static size_t thumb_saved_size = 0;
+
+static int thumb_save_write(void *ctx, const uint8_t *buf, int len) {
+    (void)ctx;
+    if (thumb_saved_size + (size_t)len > sizeof(thumb_saved)) return -1;
+    memcpy(thumb_saved + thumb_saved_size, buf, (size_t)len);
+    thumb_saved_size += (size_t)len;
+    return len;
+}
+
+// Hits, regeneration on a new mtime, colliding paths, LRU eviction and a
+// save/load round trip
+static void unit_thumbnail_cache(void) {
+    thumbnail_cache_stats_t stats;
+    thumbnail_t thumb;
+    char path[32];
+
+    thumbnail_cache_init();
+    thumbnail_cache_set_source(&thumb_test_source);
+    thumb_opens = 0;
+
+    if (!thumb_fetch("/pics/a.png", 1) || !thumbnail_cache_get("/pics/a.png", 1, &thumb)) {
+        check_failed("thumbnail_cache: no hit after generating");
+    }
+    thumbnail_cache_get_stats(&stats);
+    if (stats.hits != 2 || stats.generated != 1 || thumb_opens != 1) {
+        check_failed("thumbnail_cache: %u hits, %u generated, %d opens", stats.hits, stats.generated, thumb_opens);
+    }
+    if (thumbnail_cache_get("/pics/a.png", 2, &thumb) || !thumb_fetch("/pics/a.png", 2) || thumb_opens != 2) {
+        check_failed("thumbnail_cache: new mtime didn't regenerate");
+    }
+
+    const char *first = "/pics/img423919.png", *second = "/pics/img1021460.png";
+    if (fnv1a(first) != fnv1a(second)) {
+        check_failed("thumbnail_cache: test paths no longer collide");
+    }
+    if (!thumb_fetch(first, 1) || thumbnail_cache_get(second, 1, &thumb) ||
+        !thumb_fetch(second, 1) || !thumb_fetch(first, 1)) {
+        check_failed("thumbnail_cache: colliding paths share a thumbnail");
+    }
+
+    thumbnail_cache_init();
+    for (int i = 0; i < THUMB_CACHE_SLOTS + 10; i++) {
+        snprintf(path, sizeof(path), "/pics/%d.png", i);
+        if (!thumb_fetch(path, 1)) {
+            check_failed("thumbnail_cache: %s not generated", path);
+            break;
+        }
+    }
+    thumbnail_cache_get_stats(&stats);
+    bool oldest = thumbnail_cache_get("/pics/0.png", 1, &thumb);
+    if (stats.evicted != 10 || oldest || !thumb_fetch(path, 1)) {
+        check_failed("thumbnail_cache: %u evicted, oldest %s", stats.evicted, oldest ? "kept" : "gone");
+    }
+
+    // The miss above queued the oldest again; fill every slot before saving
+    thumbnail_cache_pump(1000000);
+    thumb_saved_size = 0;
+    int saved = thumbnail_cache_save(thumb_save_write, NULL);
+    thumbnail_cache_init();
+    image_memory_reader_t reader = { thumb_saved, thumb_saved_size, 0 };
+    int opens = thumb_opens;
+    int loaded = thumbnail_cache_load(image_memory_read, &reader);
+    if (saved != THUMB_CACHE_SLOTS || loaded != saved || !thumbnail_cache_get(path, 1, &thumb) ||
+        !thumb_fetch(path, 1) || thumb_opens != opens) {
+        check_failed("thumbnail_cache: %d saved, %d loaded", saved, loaded);
+    }
+
+    thumbnail_cache_init();
+    thumbnail_cache_set_source(NULL);
+}
+
+// A 128x128 gradient whose every byte read costs a microsecond
+#define THUMB_SLOW_SIDE     128
+
+static int thumb_slow_read(void *ctx, uint8_t *buf, int len) {
+    int n = image_memory_read(ctx, buf, len);
+    if (n > 0) host_clock_us += (uint32_t)n;
+    return n;
+}
+
+static int thumb_slow_open(const char *path, void **handle) {
+    static uint32_t rgb[THUMB_SLOW_SIDE * THUMB_SLOW_SIDE];
+    (void)path;
+    for (int y = 0; y < THUMB_SLOW_SIDE; y++) {
+        for (int x = 0; x < THUMB_SLOW_SIDE; x++) {
+            rgb[y * THUMB_SLOW_SIDE + x] = (uint32_t)(x * 2) << 16 | (uint32_t)(y * 2) << 8 | (uint32_t)(x ^ y);
+        }
+    }
+    size_t size = make_png(thumb_file, THUMB_SLOW_SIDE, THUMB_SLOW_SIDE, rgb, NULL);
+    thumb_reader = (image_memory_reader_t){ thumb_file, size, 0 };
+    *handle = &thumb_reader;
+    thumb_opens++;
+    return 0;
+}
+
+static const thumbnail_source_t thumb_slow_source = { thumb_slow_open, thumb_slow_read, thumb_test_close };
+
+// A slow image is generated over several pumps, none overrunning its budget
+// by more than a band, and a decode in between restarts it rather than
+// spoiling it
+static void unit_thumbnail_bands(void) {
+    static uint32_t whole[THUMB_SIZE * THUMB_SIZE];
+    static uint8_t other[TEST_IMAGE_MAX];
+    const char *path = "/pics/big.png";
+    thumbnail_t thumb;
+    uint32_t rgb[7 * 5];
+
+    thumbnail_cache_init();
+    thumbnail_cache_set_source(&thumb_slow_source);
+    thumbnail_cache_get(path, 1, &thumb);
+    uint32_t start = host_clock_us;
+    thumbnail_cache_pump(1000000);
+    uint32_t whole_us = host_clock_us - start;
+    if (!thumbnail_cache_get(path, 1, &thumb)) {
+        check_failed("thumbnail_bands: not generated in one long pump");
+        return;
+    }
+    memcpy(whole, thumb.pixels, sizeof(whole));
+
+    fill_test_image(rgb, 7, 5);
+    size_t other_size = make_png(other, 7, 5, rgb, NULL);
+
+    thumbnail_cache_init();
+    thumb_opens = 0;
+    int pumps = 0;
+    uint32_t worst_us = 0;
+    while (!thumbnail_cache_get(path, 1, &thumb) && pumps < 100) {
+        start = host_clock_us;
+        thumbnail_cache_pump(1000);
+        if (host_clock_us - start > worst_us) worst_us = host_clock_us - start;
+        if (++pumps == 3 && decode_buffer(other, other_size) != IMAGE_OK) {
+            check_failed("thumbnail_bands: the decode in between failed");
+        }
+    }
+
+    if (pumps < 4 || worst_us > whole_us / 2) {
+        check_failed("thumbnail_bands: %d pumps, worst %u us of %u us for the image", pumps, worst_us, whole_us);
+    }
+    if (thumb_opens != 2 || memcmp(thumb.pixels, whole, sizeof(whole)) != 0) {
+        check_failed("thumbnail_bands: %d opens; thumbnail %s the one made in one go", thumb_opens,
+                     memcmp(thumb.pixels, whole, sizeof(whole)) ? "differs from" : "matches");
+    }
+
+    thumbnail_cache_init();
+    thumbnail_cache_set_source(NULL);
+}
+
+// An app that is suspendable, and busy for as long as fake_app_busy says
+static bool fake_app_busy = false;
+static int fake_app_drops = 0;
+
+static uint32_t fake_app_resident(void) { return 4096; }
+static int fake_app_save(app_write_fn write, void *ctx) { return write(ctx, (const uint8_t *)"app", 3) == 3 ? 0 : -1; }
+static void fake_app_drop(void) { fake_app_drops++; }
+static int fake_app_restore(app_read_fn read, void *ctx) { uint8_t buf[3]; return read(ctx, buf, 3) == 3 ? 0 : -1; }
+static bool fake_app_is_busy(void) { return fake_app_busy; }
+
+static const app_suspend_ops_t fake_app_ops = {
+    fake_app_resident, fake_app_save, fake_app_drop, fake_app_restore, fake_app_is_busy
+};
+
+// Scheduler rounds a frame apart for ms; true if the app got suspended
+static bool fake_app_rounds(uint32_t ms) {
+    for (uint32_t t = 0; t < ms && apps[1].state != TASK_SUSPENDED; t += 16) {
+        host_advance_ms(16);
+        run_scheduler_round();
+    }
+    return apps[1].state == TASK_SUSPENDED;
+}
+
+// Well under the memory budget, the scheduler still suspends an app left
+// idle behind another, but only once its background work is done
+static void unit_app_suspend(void) {
+    init_apps();
+    register_app("Front", idle_app_loop, idle_app_loop, 1);
+    register_app("Behind", idle_app_loop, idle_app_loop, 1);
+    app_set_suspend_ops(1, &fake_app_ops);
+    switch_app(1);
+    switch_app(0);
+    fake_app_drops = 0;
+
+    fake_app_busy = true;
+    if (fake_app_rounds(2 * APP_SUSPEND_IDLE_MS)) {
+        check_failed("app_suspend: suspended while busy");
+    }
+    fake_app_busy = false;
+    if (!fake_app_rounds(32) || fake_app_drops != 1) {
+        check_failed("app_suspend: not suspended once idle (%d drops)", fake_app_drops);
+    }
+
+    // Back in front and behind again: the idle time starts over
+    switch_app(1);
+    switch_app(0);
+    if (fake_app_rounds(APP_SUSPEND_IDLE_MS - 32) || !fake_app_rounds(64)) {
+        check_failed("app_suspend: second suspension not after %d ms idle", APP_SUSPEND_IDLE_MS);
+    }
+    init_apps();
+}
+
+// Handles outlive their slot's reuse, a full pool gives up the effects
+// nearest their end, and fading effects fade all the way, sparkles included
+static void unit_effect_pool(void) {
+    effect_pool_stats_t stats;
+    dl_damage_t damage;
+
+    effect_pool_init();
+    effect_id_t old = effect_spawn(EFFECT_DOT, 100, 100, 20, 0, 0xFFFFFF, 100, 0);
+    effect_cancel(old);
+    effect_id_t reused = effect_spawn(EFFECT_DOT, 100, 100, 20, 0, 0xFFFFFF, 100, 0);
+    effect_cancel(old);
+    if (effect_is_live(old) || !effect_is_live(reused)) {
+        check_failed("effect_pool: stale handle still accepted after its slot was reused");
+    }
+
+    // Effect i ends after 1000 + 10 * i ms; half a second in, the shortest
+    // ones are furthest along
+    effect_id_t ids[EFFECT_POOL_SIZE];
+    effect_pool_init();
+    for (int i = 0; i < EFFECT_POOL_SIZE; i++) {
+        ids[i] = effect_spawn(EFFECT_RING, 500, 500, 50, 2, 0xFFFFFF, 1000 + 10 * (uint32_t)i, 0);
+    }
+    host_advance_ms(500);
+    damage.count = 0;
+    effect_pool_update(&damage);
+    for (int i = 0; i < 5; i++) {
+        effect_spawn(EFFECT_DOT, 0, 0, 10, 0, 0xFFFFFF, 100, 0);
+    }
+    effect_pool_get_stats(&stats);
+    bool oldest_gone = true;
+    for (int i = 0; i < 5; i++) oldest_gone &= !effect_is_live(ids[i]);
+    if (stats.recycled != 5 || stats.live != EFFECT_POOL_SIZE || !oldest_gone || !effect_is_live(ids[5])) {
+        check_failed("effect_pool: full pool recycled %u, live %u, nearest-to-end %s", stats.recycled,
+                     stats.live, oldest_gone ? "gone" : "kept");
+    }
+
+    // A whole pool spawned in one frame still recycles
+    for (int i = 0; i < EFFECT_POOL_SIZE + 3; i++) {
+        effect_spawn(EFFECT_DOT, 0, 0, 10, 0, 0xFFFFFF, 100, 0);
+    }
+    effect_pool_get_stats(&stats);
+    if (stats.recycled != 5 + EFFECT_POOL_SIZE + 3 || stats.live != EFFECT_POOL_SIZE) {
+        check_failed("effect_pool: %u recycled after refilling in one frame", stats.recycled);
+    }
+
+    if (effect_fade_color(0xFFFFFF, 0) != 0 || effect_fade_color(0x808080, 64) != 0x202020) {
+        check_failed("effect_pool: fade color %06x at alpha 0", effect_fade_color(0xFFFFFF, 0));
+    }
+
+    // On its last millisecond a fading sparkle ring draws nothing but black
+    effect_pool_init();
+    effect_spawn(EFFECT_SPARKLE_RING, 800, 800, 100, 3, 0xFFFFFF, 1000, EFFECT_FADE_OUT);
+    host_advance_ms(999);
+    damage.count = 0;
+    effect_pool_update(&damage);
+    memset(host_framebuffer, 0, sizeof(host_framebuffer));
+    reset_clip_rect();
+    effect_pool_draw();
+    for (int i = 0; i < SCREEN_WIDTH * SCREEN_HEIGHT; i++) {
+        if (host_framebuffer[i] & 0xFFFFFF) {
+            check_failed("effect_pool: faded-out ring left %06x at %d,%d", host_framebuffer[i] & 0xFFFFFF,
+                         i % SCREEN_WIDTH, i / SCREEN_WIDTH);
+            break;
+        }
+    }
+    effect_pool_init();
+}
+
+// The ring holds exactly its size, wraps its indices, keeps each contact's
+// drag down to one move even with other fingers interleaved, and never pulls
+// a move ahead of a press or release
+static void unit_touch_input(void) {
+    touch_sample_t out[TOUCH_QUEUE_SIZE];
+    touch_queue_stats_t stats;
+
+    init_touch_input();
+    if (touch_input_drain(out, TOUCH_QUEUE_SIZE) != 0 || touch_input_pending() != 0) {
+        check_failed("touch_input: empty ring drained events");
+    }
+
+    // Fill it to the brim with presses, which never coalesce
+    int pushed = 0;
+    for (int i = 0; i < TOUCH_QUEUE_SIZE + 3; i++) {
+        pushed += touch_input_irq_push(0, (i & 1) ? TOUCH_UP : TOUCH_DOWN, i, 0);
+    }
+    touch_input_get_stats(&stats);
+    int drained = touch_input_drain(out, TOUCH_QUEUE_SIZE);
+    if (pushed != TOUCH_QUEUE_SIZE || stats.overflows != 3 || drained != TOUCH_QUEUE_SIZE ||
+        out[0].x != 0 || out[TOUCH_QUEUE_SIZE - 1].x != TOUCH_QUEUE_SIZE - 1) {
+        check_failed("touch_input: full ring took %d, lost %u, drained %d", pushed, stats.overflows, drained);
+    }
+
+    // Cycle a few ring lengths in small batches so the indices wrap, with
+    // drains that stop short of the queue
+    int next = 0, expect = 0;
+    bool in_order = true;
+    for (int round = 0; round < 3 * TOUCH_QUEUE_SIZE / 7; round++) {
+        for (int i = 0; i < 7; i++, next++) {
+            touch_input_irq_push(1, (next & 1) ? TOUCH_UP : TOUCH_DOWN, next, 0);
+        }
+        int n;
+        while ((n = touch_input_drain(out, 5)) > 0) {
+            for (int i = 0; i < n; i++) in_order &= out[i].x == expect++;
+        }
+    }
+    if (!in_order || expect != next || touch_input_pending() != 0) {
+        check_failed("touch_input: wrapped ring drained %d of %d in %s", expect, next,
+                     in_order ? "order" : "the wrong order");
+    }
+
+    // Two fingers dragging in lockstep: each ends up as one move at its
+    // latest position; the lift of one keeps the moves after it separate
+    init_touch_input();
+    touch_input_irq_push(0, TOUCH_DOWN, 0, 0);
+    touch_input_irq_push(1, TOUCH_DOWN, 0, 100);
+    for (int i = 1; i <= 40; i++) {
+        touch_input_irq_push(0, TOUCH_MOVE, i, 0);
+        touch_input_irq_push(1, TOUCH_MOVE, i, 100);
+        touch_input_irq_push(2, TOUCH_MOVE, i, 200);
+    }
+    touch_input_irq_push(1, TOUCH_UP, 40, 100);
+    touch_input_irq_push(0, TOUCH_MOVE, 50, 0);
+    touch_input_irq_push(0, TOUCH_MOVE, 60, 0);
+    drained = touch_input_drain(out, TOUCH_QUEUE_SIZE);
+    const struct { uint8_t id; touch_event_t type; int x; } want[] = {
+        { 0, TOUCH_DOWN, 0 }, { 1, TOUCH_DOWN, 0 },
+        { 0, TOUCH_MOVE, 40 }, { 1, TOUCH_MOVE, 40 }, { 2, TOUCH_MOVE, 40 },
+        { 1, TOUCH_UP, 40 }, { 0, TOUCH_MOVE, 60 },
+    };
+    bool match = drained == (int)(sizeof(want) / sizeof(want[0]));
+    for (int i = 0; match && i < drained; i++) {
+        match = out[i].id == want[i].id && out[i].type == want[i].type && out[i].x == want[i].x;
+    }
+    touch_input_get_stats(&stats);
+    if (!match || stats.coalesced != 3 * 39 + 1) {
+        check_failed("touch_input: interleaved drags drained to %d events, %u coalesced", drained, stats.coalesced);
+    }
+
+    // A pan that slides off the right edge and lifts there: the lift comes
+    // out on screen and ends the contact, so the next finger down is a tap,
+    // not the second half of a pinch
+    init_touch_input();
+    touch_input_irq_push(0, TOUCH_DOWN, SCREEN_WIDTH - 400, 1000);
+    host_advance_ms(16);
+    touch_input_irq_push(0, TOUCH_MOVE, SCREEN_WIDTH - 100, 1000);
+    host_advance_ms(16);
+    touch_input_irq_push(0, TOUCH_MOVE, SCREEN_WIDTH + 150, 1010);
+    host_advance_ms(16);
+    touch_input_irq_push(0, TOUCH_UP, SCREEN_WIDTH + 300, 1020);
+    host_advance_ms(200);
+    touch_input_irq_push(1, TOUCH_DOWN, 500, 500);
+    drained = touch_input_drain(out, TOUCH_QUEUE_SIZE);
+
+    gesture_recognizer_t rec;
+    gesture_event_t events[GESTURE_MAX_EVENTS];
+    bool on_screen = true, pinched = false;
+    int lifted_contacts = -1;
+    gesture_init(&rec);
+    for (int i = 0; i < drained; i++) {
+        on_screen &= out[i].x >= 0 && out[i].x < SCREEN_WIDTH;
+        int n = gesture_feed(&rec, &out[i], events);
+        for (int k = 0; k < n; k++) {
+            pinched |= events[k].type == GESTURE_PINCH_IN || events[k].type == GESTURE_PINCH_OUT;
+        }
+        if (out[i].type == TOUCH_UP) lifted_contacts = rec.contacts;
+    }
+    // The two moves merge into one
+    if (drained != 4 || !on_screen || lifted_contacts != 0 || pinched || rec.contacts != 1) {
+        check_failed("touch_input: lift past the edge drained %d events, left %d contacts down%s",
+                     drained, lifted_contacts, pinched ? ", and the next touch pinched" : "");
+    }
+    init_touch_input();
+}
+
+// Brute-force answer: the last added target containing the point, within
+// the grid's region
+static int hit_grid_expected(const hit_grid_t *grid, int x, int y) {
+    if (x < grid->x0 || y < grid->y0 || x >= grid->x0 + grid->width || y >= grid->y0 + grid->height) {
+        return -1;
+    }
+    for (int i = grid->count - 1; i >= 0; i--) {
+        const hit_item_t *item = &grid->items[i];
+        if (x >= item->x && x < item->x + item->width && y >= item->y && y < item->y + item->height) {
+            return item->id;
+        }
+    }
+    return -1;
+}
+
+// Probe random points plus every target's corners; returns the first
+// mismatching id pair through *got/*want, or false if all agree
+static bool hit_grid_mismatch(const hit_grid_t *grid, int *px, int *py, int *got, int *want) {
+    for (int i = 0; i < 4000 + 4 * grid->count; i++) {
+        int x, y;
+        if (i < 4000) {
+            x = prim_rand(grid->x0 - 50, grid->x0 + grid->width + 50);
+            y = prim_rand(grid->y0 - 50, grid->y0 + grid->height + 50);
+        } else {
+            const hit_item_t *item = &grid->items[(i - 4000) / 4];
+            x = item->x + ((i & 1) ? item->width - 1 : 0);
+            y = item->y + ((i & 2) ? item->height - 1 : 0);
+        }
+        *got = hit_grid_find(grid, x, y);
+        *want = hit_grid_expected(grid, x, y);
+        if (*got != *want) {
+            *px = x;
+            *py = y;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Overlapping targets resolve to the topmost, targets spanning many cells
+// (and enough of them to force coarser cells) are found everywhere, and a
+// full grid refuses one more
+static void unit_hit_grid(void) {
+    static hit_grid_t grid;
+    int x, y, got, want;
+
+    // A stack of overlapping targets over a small region
+    hit_grid_begin(&grid, 100, 200, 800, 600, 5);
+    hit_grid_add(&grid, 100, 200, 800, 600, 1);
+    hit_grid_add(&grid, 300, 300, 200, 200, 2);
+    hit_grid_add(&grid, 350, 350, 50, 50, 3);
+    hit_grid_add(&grid, 320, 320, 100, 100, 4);
+    hit_grid_build(&grid);
+    if (hit_grid_find(&grid, 360, 360) != 4 || hit_grid_find(&grid, 450, 450) != 2 ||
+        hit_grid_find(&grid, 150, 250) != 1 || hit_grid_find(&grid, 99, 250) != -1) {
+        check_failed("hit_grid: overlapping targets found %d at the top of the stack",
+                     hit_grid_find(&grid, 360, 360));
+    }
+
+    // Random overlapping layouts with targets from sliver to screen-sized,
+    // some hanging off the region
+    prim_seed = 41;
+    for (int layout = 0; layout < 20; layout++) {
+        hit_grid_begin(&grid, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, prim_rand(3, 8));
+        int n = prim_rand(1, 64);
+        for (int i = 0; i < n; i++) {
+            int w = prim_rand(1, 4) == 1 ? prim_rand(400, SCREEN_WIDTH) : prim_rand(1, 300);
+            int h = prim_rand(1, 4) == 1 ? prim_rand(400, SCREEN_HEIGHT) : prim_rand(1, 300);
+            hit_grid_add(&grid, prim_rand(-200, SCREEN_WIDTH), prim_rand(-200, SCREEN_HEIGHT), w, h, i);
+        }
+        hit_grid_build(&grid);
+        if (hit_grid_mismatch(&grid, &x, &y, &got, &want)) {
+            check_failed("hit_grid: layout %d found %d at %d,%d, expected %d", layout, got, x, y, want);
+            break;
+        }
+    }
+
+    // Fill every slot with large targets on fine cells: the references
+    // can't fit until the cells coarsen
+    hit_grid_begin(&grid, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 1);
+    for (int i = 0; i < HIT_GRID_MAX_ITEMS; i++) {
+        hit_grid_add(&grid, prim_rand(0, SCREEN_WIDTH - 600), prim_rand(0, SCREEN_HEIGHT - 600),
+                     prim_rand(300, 600), prim_rand(300, 600), 1000 + i);
+    }
+    int extra = hit_grid_add(&grid, 0, 0, 10, 10, 0);
+    int before_build = grid.cell_shift;
+    hit_grid_build(&grid);
+    if (extra != -1 || grid.count != HIT_GRID_MAX_ITEMS || grid.cell_shift <= before_build) {
+        check_failed("hit_grid: full grid added %d, cells 2^%d -> 2^%d", extra, before_build, grid.cell_shift);
+    }
+    if (hit_grid_mismatch(&grid, &x, &y, &got, &want)) {
+        check_failed("hit_grid: full grid found %d at %d,%d, expected %d", got, x, y, want);
+    }
+}
+
+// Positions between samples stay on the line between them however long the
+// finger rested, and motion before a long rest isn't extrapolated
+static void unit_touch_resampler(void) {
+    static const uint32_t gaps_ms[] = { 16, 600, 1000, 1500, 5000, 60000 };
+    static const int16_t ends[][2] = { { 100, 100 }, { 3800, 2100 }, { -300, 30000 } };
+    touch_resampler_t r;
+    int x, y;
+
+    for (int g = 0; g < (int)(sizeof(gaps_ms) / sizeof(gaps_ms[0])); g++) {
+        for (int e = 1; e < (int)(sizeof(ends) / sizeof(ends[0])); e++) {
+            uint32_t start = 1000000;
+            uint32_t gap_us = gaps_ms[g] * 1000;
+            touch_sample_t from = { start, ends[0][0], ends[0][1], 0, TOUCH_DOWN };
+            touch_sample_t to = { start + gap_us, ends[e][0], ends[e][1], 0, TOUCH_MOVE };
+
+            touch_resampler_reset(&r);
+            touch_resampler_add(&r, &from);
+            touch_resampler_add(&r, &to);
+            for (int q = 1; q < 4; q++) {
+                touch_resampler_sample(&r, start + gap_us / 4 * q, &x, &y);
+                int want_x = ends[0][0] + (ends[e][0] - ends[0][0]) * q / 4;
+                int want_y = ends[0][1] + (ends[e][1] - ends[0][1]) * q / 4;
+                if (abs(x - want_x) > 2 || abs(y - want_y) > 2) {
+                    check_failed("touch_resampler: %u ms gap at %d/4 gave %d,%d, expected %d,%d",
+                                 gaps_ms[g], q, x, y, want_x, want_y);
+                    return;
+                }
+            }
+
+            touch_resampler_sample(&r, start + gap_us + 8000, &x, &y);
+            bool stale = gap_us > RESAMPLE_STALE_US;
+            if (stale && (x != ends[e][0] || y != ends[e][1])) {
+                check_failed("touch_resampler: predicted %d,%d past a %u ms rest", x, y, gaps_ms[g]);
+                return;
+            }
+        }
+    }
+}
+
+// Run frames of the main loop's input work while a finger rests on (x, y)
+// for held frames: drain the touch queue into the keyboard, and poll
+// get_virtual_key() as any other caller may. Returns the keys typed, and
+// the number of frames the layout changed through *switches.
+static int keyboard_hold(int x, int y, int held, int *switches) {
+    touch_sample_t touches[TOUCH_QUEUE_SIZE];
+    int typed = 0;
+
+    *switches = 0;
+    for (int frame = 0; frame <= held; frame++) {
+        // Down, then a jitter of a pixel each frame, then up
+        set_simulated_touch(x + (frame & 1), y, frame < held);
+        keyboard_layout_id_t before = get_keyboard_layout();
+        int n = touch_input_drain(touches, TOUCH_QUEUE_SIZE);
+        for (int i = 0; i < n; i++) {
+            typed += virtual_keyboard_touch(&touches[i], NULL) != 0;
+        }
+        get_virtual_key();
+        *switches += get_keyboard_layout() != before;
+        host_advance_ms(16);
+    }
+    return typed;
+}
+
+// A key held across frames types once, and a held layout key switches the
+// layout once, when it lifts
+static void unit_virtual_keyboard(void) {
+    int switches;
+
+    init_touch_input();
+    init_virtual_keyboard();
+    show_virtual_keyboard(true);
+    char letter = detect_virtual_key(1000, 1950);
+    int typed = keyboard_hold(1000, 1950, 6, &switches);
+    if (letter == 0 || typed != 1 || switches != 0) {
+        check_failed("virtual_keyboard: '%c' held 6 frames typed %d times", letter, typed);
+    }
+
+    typed = keyboard_hold(200, 2100, 6, &switches);
+    if (typed != 0 || switches != 1 || get_keyboard_layout() != KB_LAYOUT_SYMBOLS) {
+        check_failed("virtual_keyboard: ?123 held 6 frames switched layout %d times", switches);
+    }
+
+    set_keyboard_layout(KB_LAYOUT_QWERTY);
+    show_virtual_keyboard(false);
+    init_touch_input();
+}
+
+static const struct {
+    const char *name;
+    void (*run)(void);
+} units[] = {
+    { "image_decoder",       unit_image_decoder },
+    { "wallpaper",           unit_wallpaper },
+    { "thumbnail_cache",     unit_thumbnail_cache },
+    { "thumbnail_bands",     unit_thumbnail_bands },
+    { "effect_pool",         unit_effect_pool },
+    { "app_suspend",         unit_app_suspend },
+    { "tile_raster",         unit_tile_raster },
+    { "touch_input",         unit_touch_input },
+    { "hit_grid",            unit_hit_grid },
+    { "touch_resampler",     unit_touch_resampler },
+    { "virtual_keyboard",    unit_virtual_keyboard },
+};
+
+#define UNIT_COUNT ((int)(sizeof(units) / sizeof(units[0])))
+
+// Returns the number of units with a failed check
+static int run_units(void) {
+    int failures = 0;
+
+    printf("%-20s %s\n", "unit", "result");
+    for (int i = 0; i < UNIT_COUNT; i++) {
+        int before = check_failures;
+        units[i].run();
+        bool failed = check_failures != before;
+        failures += failed;
+        printf("%-20s %s\n", units[i].name, failed ? "FAIL" : "ok");
+    }
+    printf("\n");
+    return failures;
+}
+
+// =============================================================================
+// Main
+// =============================================================================
+
+int main(int argc, char **argv) {
+    const char *golden_path = RENDER_GOLDEN_FILE;
+    bool update = false;
+    bool dump = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else if (strcmp(argv[i], "--dump") == 0) {
+            dump = true;
+        } else if (strcmp(argv[i], "--serial") == 0) {
+            host_serial_echo = true;
+        } else {
+            golden_path = argv[i];
+        }
+    }
+
+    crc32_init();
+    set_framebuffer(host_framebuffer);
+    init_display4k();
+
+    golden_entry_t golden[RENDER_MAX_SCENES];
+    int golden_count = load_golden(golden_path, golden, RENDER_MAX_SCENES);
+    if (golden_count < 0) {
+        printf("No golden file at %s, creating it\n", golden_path);
+        update = true;
+        golden_count = 0;
+    }
+
+    golden_entry_t results[SCENE_COUNT];
+    int trace_failures = run_traces();
+    int search_failures = run_searches();
+    int unit_failures = run_units();
+    int failures = 0;
+
+    printf("%-20s %10s %10s  %s\n", "scene", "median ms", "crc", "result");
+    for (int i = 0; i < SCENE_COUNT; i++) {
+        const render_scene_t *scene = &scenes[i];
+        golden_entry_t *result = &results[i];
+        const char *status = "ok";
+        bool failed = false;
+        int checks_before = check_failures;
+
+        if (!run_scene(scene, result)) {
+            status = "FAIL (output differs between runs)";
+            failed = true;
+        } else if (check_failures != checks_before) {
+            status = "FAIL (check failed)";
+            failed = true;
+        } else if (scene->same_as && (!find_golden(results, i, scene->same_as) ||
+                                      find_golden(results, i, scene->same_as)->crc != result->crc)) {
+            status = "FAIL (differs from reference scene)";
+            failed = true;
+        } else if (!update) {
+            const golden_entry_t *ref = find_golden(golden, golden_count, scene->name);
+            if (!ref) {
+                status = "FAIL (no golden entry)";
+                failed = true;
+            } else if (ref->crc != result->crc) {
+                status = "FAIL (image differs from golden)";
+                failed = true;
+            } else if (ref->ms > 0 && result->ms > ref->ms * RENDER_SLOWDOWN_WARN) {
+                status = "ok (slower than reference)";
+            }
+        }
+
+        if (failed || dump) {
+            dump_frame(scene->name);
+        }
+        failures += failed;
+        printf("%-20s %10.3f   %08x  %s\n", scene->name, result->ms, result->crc, status);
+    }
+
+    if (update) {
+        if (save_golden(golden_path, results, SCENE_COUNT) < 0) {
+            printf("Cannot write %s\n", golden_path);
+            return 1;
+        }
+        printf("Golden file %s updated\n", golden_path);
+        return failures || trace_failures || search_failures || unit_failures ? 1 : 0;
+    }
+
+    if (trace_failures) {
+        printf("%d gesture trace(s) failed\n", trace_failures);
+    }
+    if (search_failures) {
+        printf("%d search(es) failed\n", search_failures);
+    }
+    if (unit_failures) {
+        printf("%d unit(s) failed\n", unit_failures);
+    }
+    if (failures) {
+        printf("%d scene(s) failed; frames written to %s/\n", failures, RENDER_OUT_DIR);
+    }
+    return failures || trace_failures || search_failures || unit_failures ? 1 : 0;
+}
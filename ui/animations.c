@@ -1,150 +1,203 @@
 // animations.c
 #include "animations.h"
 #include "../drivers/display4k.h"
-#include <math.h>
+#include <stddef.h>
 
-#define MAX_ANIMATIONS 32
-static animation_t animations[MAX_ANIMATIONS];
-static int animation_count = 0;
-static int system_ticks = 0;
+// Easing curves sampled at 2^ANIM_EASE_BITS + 1 points, built on first use
+#define EASE_POINTS ((1 << ANIM_EASE_BITS) + 1)
+#define EASE_FRAC_BITS (ANIM_FIX_SHIFT - ANIM_EASE_BITS)
+static uint32_t ease_in_out_table[EASE_POINTS];
+static uint32_t ease_bounce_table[EASE_POINTS];
+static int ease_tables_ready = 0;
 
-void init_animation_system(void) {
-    for (int i = 0; i < MAX_ANIMATIONS; i++) {
-        animations[i].active = 0;
+// sin() over the first quarter turn, Q16, 64 segments
+static const int32_t sin_quarter_table[65] = {
+    0, 1608, 3216, 4821, 6424, 8022, 9616, 11204,
+    12785, 14359, 15924, 17479, 19024, 20557, 22078, 23586,
+    25080, 26558, 28020, 29466, 30893, 32303, 33692, 35062,
+    36410, 37736, 39040, 40320, 41576, 42806, 44011, 45190,
+    46341, 47464, 48559, 49624, 50660, 51665, 52639, 53581,
+    54491, 55368, 56212, 57022, 57798, 58538, 59244, 59914,
+    60547, 61145, 61705, 62228, 62714, 63162, 63572, 63944,
+    64277, 64571, 64827, 65043, 65220, 65358, 65457, 65516,
+    65536
+};
+
+// Q16 multiply
+static inline uint32_t fix_mul(uint32_t a, uint32_t b) {
+    return (uint32_t)(((uint64_t)a * b) >> ANIM_FIX_SHIFT);
+}
+
+// Quadratic ease-in-out: 2t^2, then 1 - 2(1-t)^2
+static uint32_t eval_ease_in_out(uint32_t t) {
+    if (t < ANIM_ONE / 2) {
+        return 2 * fix_mul(t, t);
     }
-    animation_count = 0;
-    system_ticks = 0;
+    uint32_t u = ANIM_ONE - t;
+    return ANIM_ONE - 2 * fix_mul(u, u);
 }
 
-animation_t* create_animation(animation_type_t type, int x, int y, int width, int height, int duration) {
-    if (animation_count >= MAX_ANIMATIONS) return NULL;
-    
-    for (int i = 0; i < MAX_ANIMATIONS; i++) {
-        if (!animations[i].active) {
-            animations[i].type = type;
-            animations[i].x = x;
-            animations[i].y = y;
-            animations[i].width = width;
-            animations[i].height = height;
-            animations[i].duration = duration;
-            animations[i].start_time = system_ticks;
-            animations[i].current_frame = 0;
-            animations[i].total_frames = duration;
-            animations[i].progress = 0.0f;
-            animations[i].active = 1;
-            animation_count++;
-            return &animations[i];
-        }
+// Piecewise-quadratic bounce (7.5625 = 121/16, breakpoints at n/11)
+static uint32_t eval_ease_bounce(uint32_t t) {
+    uint32_t offset, base;
+    if (t < ANIM_ONE * 4 / 11) {
+        offset = 0;
+        base = 0;
+    } else if (t < ANIM_ONE * 8 / 11) {
+        offset = ANIM_ONE * 6 / 11;
+        base = ANIM_ONE * 3 / 4;
+    } else if (t < ANIM_ONE * 10 / 11) {
+        offset = ANIM_ONE * 9 / 11;
+        base = ANIM_ONE * 15 / 16;
+    } else {
+        offset = ANIM_ONE * 21 / 22;
+        base = ANIM_ONE * 63 / 64;
     }
-    return NULL;
+    int32_t d = (int32_t)t - (int32_t)offset;
+    uint32_t d2 = fix_mul((uint32_t)(d < 0 ? -d : d), (uint32_t)(d < 0 ? -d : d));
+    uint32_t v = base + ((d2 * 121) >> 4);
+    return v > ANIM_ONE ? ANIM_ONE : v;
 }
 
-void destroy_animation(animation_t* anim) {
-    if (anim && anim->active) {
-        anim->active = 0;
-        animation_count--;
+static void init_ease_tables(void) {
+    for (int i = 0; i < EASE_POINTS; i++) {
+        uint32_t t = (uint32_t)i << EASE_FRAC_BITS;
+        ease_in_out_table[i] = eval_ease_in_out(t);
+        ease_bounce_table[i] = eval_ease_bounce(t);
     }
+    ease_tables_ready = 1;
 }
 
-float ease_in_out(float t) {
-    return t < 0.5f ? 2 * t * t : -1 + (4 - 2 * t) * t;
+// Look up t (Q16, clamped to 0..1) in an easing table
+static uint32_t ease_lookup(const uint32_t *table, uint32_t t) {
+    if (!ease_tables_ready) init_ease_tables();
+    if (t >= ANIM_ONE) return table[EASE_POINTS - 1];
+
+    uint32_t index = t >> EASE_FRAC_BITS;
+    uint32_t frac = t & ((1 << EASE_FRAC_BITS) - 1);
+    int32_t a = (int32_t)table[index];
+    int32_t b = (int32_t)table[index + 1];
+    return (uint32_t)(a + (((b - a) * (int32_t)frac) >> EASE_FRAC_BITS));
 }
 
-float ease_bounce(float t) {
-    if (t < 1.0f / 2.75f) {
-        return 7.5625f * t * t;
-    } else if (t < 2.0f / 2.75f) {
-        t -= 1.5f / 2.75f;
-        return 7.5625f * t * t + 0.75f;
-    } else if (t < 2.5f / 2.75f) {
-        t -= 2.25f / 2.75f;
-        return 7.5625f * t * t + 0.9375f;
-    } else {
-        t -= 2.625f / 2.75f;
-        return 7.5625f * t * t + 0.984375f;
-    }
+uint32_t ease_in_out(uint32_t t) {
+    return ease_lookup(ease_in_out_table, t);
 }
 
-void update_animations(void) {
-    system_ticks++;
-    
-    for (int i = 0; i < MAX_ANIMATIONS; i++) {
-        if (!animations[i].active) continue;
-        
-        animation_t* anim = &animations[i];
-        int elapsed = system_ticks - anim->start_time;
-        
-        if (elapsed >= anim->duration) {
-            destroy_animation(anim);
-            continue;
-        }
-        
-        anim->progress = (float)elapsed / (float)anim->duration;
-        anim->current_frame = elapsed;
-        
-        // Apply animation based on type
-        switch (anim->type) {
-            case ANIM_FADE_IN: {
-                float alpha = ease_in_out(anim->progress);
-                uint32_t fade_color = (anim->color & 0x00FFFFFF) | ((uint32_t)(alpha * 255) << 24);
-                draw_rect(anim->x, anim->y, anim->width, anim->height, fade_color);
-                break;
-            }
-            case ANIM_SCALE: {
-                float scale = ease_in_out(anim->progress);
-                int scaled_width = (int)(anim->width * scale);
-                int scaled_height = (int)(anim->height * scale);
-                int offset_x = (anim->width - scaled_width) / 2;
-                int offset_y = (anim->height - scaled_height) / 2;
-                draw_rect(anim->x + offset_x, anim->y + offset_y, scaled_width, scaled_height, anim->color);
-                break;
-            }
-            case ANIM_BOUNCE: {
-                float bounce = ease_bounce(anim->progress);
-                int offset_y = (int)(20 * (1.0f - bounce));
-                draw_rect(anim->x, anim->y - offset_y, anim->width, anim->height, anim->color);
-                break;
-            }
-            case ANIM_PULSE: {
-                float pulse = (sinf(anim->progress * 3.14159f * 4) + 1.0f) / 2.0f;
-                uint32_t pulse_color = (anim->color & 0x00FFFFFF) | ((uint32_t)(pulse * 255) << 24);
-                draw_circle(anim->x, anim->y, (int)(anim->width * pulse), pulse_color);
-                break;
-            }
-        }
+uint32_t ease_bounce(uint32_t t) {
+    return ease_lookup(ease_bounce_table, t);
+}
+
+int32_t sin_q16(uint32_t turns) {
+    turns &= ANIM_ONE - 1;
+    uint32_t quadrant = turns >> (ANIM_FIX_SHIFT - 2);
+    uint32_t pos = turns & ((ANIM_ONE >> 2) - 1);     // Position within the quadrant, 14 bits
+    if (quadrant & 1) pos = (ANIM_ONE >> 2) - pos;     // Falling half mirrors the rising one
+
+    uint32_t index = pos >> 8;
+    uint32_t frac = pos & 0xFF;
+    int32_t a = sin_quarter_table[index];
+    int32_t b = index < 64 ? sin_quarter_table[index + 1] : a;
+    int32_t v = a + (((b - a) * (int32_t)frac) >> 8);
+    return (quadrant & 2) ? -v : v;
+}
+
+void init_animation_system(void) {
+    effect_pool_init();
+    if (!ease_tables_ready) init_ease_tables();
+}
+
+// Animations live in the effect pool; kinds it can't draw just time a transition
+static effect_id_t spawn_animation(animation_type_t type, int x, int y, int width, int height,
+                                   uint32_t color, int duration_ms, uint8_t flags) {
+    effect_kind_t kind;
+    switch (type) {
+        case ANIM_FADE_IN: kind = EFFECT_FADE_IN; break;
+        case ANIM_SCALE:   kind = EFFECT_SCALE;   break;
+        case ANIM_BOUNCE:  kind = EFFECT_BOUNCE;  break;
+        case ANIM_PULSE:   kind = EFFECT_PULSE;   break;
+        default:           kind = EFFECT_TIMER;   break;
     }
+    if (duration_ms < 1) duration_ms = 1;
+    return effect_spawn(kind, x, y, width, height, color, (uint32_t)duration_ms, flags);
+}
+
+effect_id_t create_animation(animation_type_t type, int x, int y, int width, int height, int duration_ms) {
+    return spawn_animation(type, x, y, width, height, 0, duration_ms, 0);
+}
+
+void destroy_animation(effect_id_t anim) {
+    effect_cancel(anim);
+}
+
+// Advance every animation to the current time, so speed doesn't depend on frame rate
+void update_animations(dl_damage_t *damage) {
+    effect_pool_update(damage);
+}
+
+// Paint every animation as computed by the last update
+void draw_animations(void) {
+    effect_pool_draw();
 }
 
 void animate_icon_press(int x, int y, int width, int height) {
-    // Create shrink animation
-    for (int i = 0; i < 5; i++) {
-        draw_rounded_rect(x + i, y + i, width - 2 * i, height - 2 * i, 20, 0x999999);
-    }
-    
-    // Final pressed state
-    draw_rounded_rect(x + 2, y + 2, width - 4, height - 4, 18, 0x555555);
+    // Pressed highlight shrinks away while the icon bounces back
+    spawn_animation(ANIM_SCALE, x, y, width, height, 0x555555, 120, EFFECT_REVERSE);
     
     // Create bounce back animation
-    create_animation(ANIM_BOUNCE, x, y, width, height, 15);
+    create_animation(ANIM_BOUNCE, x, y, width, height, 250);
 }
 
 void animate_window_open(int x, int y, int width, int height) {
-    create_animation(ANIM_SCALE, x, y, width, height, 20);
-    create_animation(ANIM_FADE_IN, x, y, width, height, 20);
+    create_animation(ANIM_SCALE, x, y, width, height, 330);
+    create_animation(ANIM_FADE_IN, x, y, width, height, 330);
 }
 
 void animate_window_close(int x, int y, int width, int height) {
-    animation_t* scale_anim = create_animation(ANIM_SCALE, x, y, width, height, 15);
-    if (scale_anim) {
-        // Reverse scale animation for closing
-        scale_anim->progress = 1.0f;
+    // Shrink instead of grow when closing
+    spawn_animation(ANIM_SCALE, x, y, width, height, 0, 250, EFFECT_REVERSE);
+}
+
+void animate_fade_transition(int x, int y, int width, int height, uint32_t from_color, uint32_t to_color) {
+    (void)from_color;
+    spawn_animation(ANIM_FADE_IN, x, y, width, height, to_color, 330, 0);
+}
+
+void animate_slide_transition(int from_x, int from_y, int to_x, int to_y, int width, int height) {
+    animation_type_t type;
+    if (to_x != from_x) {
+        type = to_x < from_x ? ANIM_SLIDE_LEFT : ANIM_SLIDE_RIGHT;
+    } else {
+        type = to_y < from_y ? ANIM_SLIDE_UP : ANIM_SLIDE_DOWN;
     }
+    create_animation(type, to_x, to_y, width, height, 330);
 }
 
 void animate_bounce_icon(int x, int y, int width, int height) {
-    create_animation(ANIM_BOUNCE, x, y, width, height, 30);
+    create_animation(ANIM_BOUNCE, x, y, width, height, 500);
 }
 
 void animate_pulse_notification(int x, int y, int radius) {
-    create_animation(ANIM_PULSE, x, y, radius, radius, 60);
-}
\ No newline at end of file
+    create_animation(ANIM_PULSE, x, y, radius, radius, 1000);
+}
+void animate_touch_feedback(int x, int y) {
+    create_animation(ANIM_PULSE, x, y, 30, 30, 330);
+}
+
+// direction: 1 = next page (content moves left), -1 = previous page
+void animate_page_transition(int direction) {
+    create_animation(direction > 0 ? ANIM_SLIDE_LEFT : ANIM_SLIDE_RIGHT,
+                     0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 330);
+}
+
+void animate_app_launch(int x, int y) {
+    animate_window_open(x, y, 80, 80);
+}
+
+void animate_search_appear(void) {
+    create_animation(ANIM_SLIDE_DOWN, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 250);
+}
+
+void animate_search_disappear(void) {
+    create_animation(ANIM_SLIDE_UP, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 250);
+}
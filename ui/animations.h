@@ -3,6 +3,8 @@
 #define ANIMATIONS_H
 
 #include <stdint.h>
+#include "../drivers/display_list.h"
+#include "effect_pool.h"
 
 // Animation types
 typedef enum {
@@ -17,18 +19,15 @@ typedef enum {
     ANIM_PULSE
 } animation_type_t;
 
-// Animation state
-typedef struct {
-    int start_time;
-    int duration;
-    int current_frame;
-    int total_frames;
-    animation_type_t type;
-    int x, y, width, height;
-    uint32_t color;
-    float progress;
-    int active;
-} animation_t;
+// Fixed-point (Q16) progress and easing values: 0..ANIM_ONE maps to 0.0..1.0
+#define ANIM_FIX_SHIFT 16
+#define ANIM_ONE       (1 << ANIM_FIX_SHIFT)
+
+// Longest duration; keeps elapsed << ANIM_FIX_SHIFT within 32 bits
+#define ANIM_MAX_DURATION_MS 65535
+
+// Easing tables hold 2^ANIM_EASE_BITS segments, interpolated linearly
+#define ANIM_EASE_BITS 8
 
 // Animation functions
 void animate_icon_press(int x, int y, int width, int height);
@@ -38,11 +37,27 @@ void animate_fade_transition(int x, int y, int width, int height, uint32_t from_
 void animate_slide_transition(int from_x, int from_y, int to_x, int to_y, int width, int height);
 void animate_bounce_icon(int x, int y, int width, int height);
 void animate_pulse_notification(int x, int y, int radius);
+void animate_touch_feedback(int x, int y);
+void animate_page_transition(int direction);
+void animate_app_launch(int x, int y);
+void animate_search_appear(void);
+void animate_search_disappear(void);
 
 // Animation system
 void init_animation_system(void);
-void update_animations(void);
-animation_t* create_animation(animation_type_t type, int x, int y, int width, int height, int duration);
-void destroy_animation(animation_t* anim);
+// Advance animations to the current time and add the bounds they covered last
+// frame and will cover this frame to `damage`. The caller repaints that damage
+// (dl_invalidate_region + dl_submit) and then calls draw_animations() on top.
+void update_animations(dl_damage_t *damage);
+void draw_animations(void);
+// Animations are effects in the shared pool; the returned handle stays safe
+// to pass to destroy_animation() after the animation has finished
+effect_id_t create_animation(animation_type_t type, int x, int y, int width, int height, int duration_ms);
+
+// Easing curves and sine on Q16 values; no floating point
+uint32_t ease_in_out(uint32_t t);
+uint32_t ease_bounce(uint32_t t);
+int32_t sin_q16(uint32_t turns);   // turns: Q16 fraction of a full circle, wraps
+void destroy_animation(effect_id_t anim);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,311 @@
+// app_search.c - incremental app search over a hashed gram index
+//
+// Every entry is indexed under the trigrams of its text and under the first
+// one and two characters of each word. Posting lists are stored CSR-style,
+// one run of entry numbers per hash bucket. Queries shorter than three
+// characters read one word-prefix list; longer ones count, per entry, how
+// many of the query's trigrams it contains. Typing a character only adds one
+// trigram, so the counts carry over and just that list is read.
+#include "app_search.h"
+#include <string.h>
+
+// Fuzzy matches need this many query trigrams, and half of them present
+#define SEARCH_FUZZY_MIN_TRIGRAMS 3
+
+// Grams one entry can produce: its trigrams plus two prefixes per word
+#define SEARCH_MAX_ENTRY_GRAMS (SEARCH_TEXT_MAX * 2)
+
+typedef struct {
+    int id;
+    uint8_t len;
+    uint8_t name_len;               // text[0 .. name_len) is the name
+    char text[SEARCH_TEXT_MAX];     // Lowercase "name keywords"
+} search_entry_t;
+
+static search_entry_t entries[SEARCH_MAX_ENTRIES];
+static int entry_count = 0;
+static uint32_t posting_total = 0;
+static bool index_dirty = true;
+
+// Bucket b owns postings[bucket_start[b] .. bucket_start[b + 1])
+static uint32_t bucket_start[SEARCH_BUCKETS + 1];
+static uint16_t postings[SEARCH_MAX_POSTINGS];
+
+// Trigram counts for the current query; an entry's count is only valid
+// while its stamp matches, so a new query doesn't have to clear them
+static char session_query[SEARCH_QUERY_MAX];
+static int session_len = 0;
+static bool session_valid = false;
+static uint16_t stamp = 0;
+static uint16_t hit_stamp[SEARCH_MAX_ENTRIES];
+static uint8_t hits[SEARCH_MAX_ENTRIES];
+static uint16_t touched[SEARCH_MAX_ENTRIES];    // Entries with a count this session
+static int touched_count = 0;
+static uint16_t walked[SEARCH_QUERY_MAX];       // Buckets already counted this session
+static int walked_count = 0;
+
+static app_search_stats_t stats;
+
+static char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+static bool is_word_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+}
+
+// Bucket of a gram; a zero first character marks a word prefix
+static uint16_t gram_bucket(char a, char b, char c) {
+    uint32_t key = ((uint32_t)(unsigned char)a << 16) | ((uint32_t)(unsigned char)b << 8) | (unsigned char)c;
+    return (uint16_t)(((key * 2654435761u) >> 16) & (SEARCH_BUCKETS - 1));
+}
+
+static int add_gram(uint16_t *grams, int count, uint16_t bucket) {
+    for (int i = 0; i < count; i++) {
+        if (grams[i] == bucket) return count;
+    }
+    grams[count] = bucket;
+    return count + 1;
+}
+
+// Distinct buckets an entry is listed under
+static int entry_grams(const search_entry_t *e, uint16_t *grams) {
+    int count = 0;
+    for (int i = 0; i < e->len; i++) {
+        if (!is_word_char(e->text[i]) || (i > 0 && is_word_char(e->text[i - 1]))) continue;
+        count = add_gram(grams, count, gram_bucket(0, 0, e->text[i]));
+        if (i + 1 < e->len && is_word_char(e->text[i + 1])) {
+            count = add_gram(grams, count, gram_bucket(0, e->text[i], e->text[i + 1]));
+        }
+    }
+    for (int i = 0; i + 2 < e->len; i++) {
+        count = add_gram(grams, count, gram_bucket(e->text[i], e->text[i + 1], e->text[i + 2]));
+    }
+    return count;
+}
+
+void app_search_clear(void) {
+    entry_count = 0;
+    posting_total = 0;
+    index_dirty = true;
+    session_valid = false;
+}
+
+// Append folded src to the entry text, space-separated
+static void append_text(search_entry_t *e, const char *src) {
+    if (e->len > 0 && e->len < SEARCH_TEXT_MAX - 1) {
+        e->text[e->len++] = ' ';
+    }
+    while (*src && e->len < SEARCH_TEXT_MAX - 1) {
+        e->text[e->len++] = fold(*src++);
+    }
+    e->text[e->len] = '\0';
+}
+
+int app_search_add(int id, const char *name, const char *keywords) {
+    if (entry_count >= SEARCH_MAX_ENTRIES) return -1;
+
+    search_entry_t *e = &entries[entry_count];
+    e->id = id;
+    e->len = 0;
+    append_text(e, name);
+    e->name_len = e->len;
+    if (keywords && *keywords) {
+        append_text(e, keywords);
+    }
+
+    uint16_t grams[SEARCH_MAX_ENTRY_GRAMS];
+    uint32_t count = (uint32_t)entry_grams(e, grams);
+    if (posting_total + count > SEARCH_MAX_POSTINGS) return -1;
+
+    posting_total += count;
+    entry_count++;
+    index_dirty = true;
+    return 0;
+}
+
+// Bucket the entries, in entry order within each bucket
+static void build_index(void) {
+    uint16_t grams[SEARCH_MAX_ENTRY_GRAMS];
+
+    memset(bucket_start, 0, sizeof(bucket_start));
+    for (int i = 0; i < entry_count; i++) {
+        int n = entry_grams(&entries[i], grams);
+        for (int g = 0; g < n; g++) {
+            bucket_start[grams[g] + 1]++;
+        }
+    }
+    for (int b = 0; b < SEARCH_BUCKETS; b++) {
+        bucket_start[b + 1] += bucket_start[b];
+    }
+
+    // Each bucket's start doubles as its write cursor, then shifts back
+    for (int i = 0; i < entry_count; i++) {
+        int n = entry_grams(&entries[i], grams);
+        for (int g = 0; g < n; g++) {
+            postings[bucket_start[grams[g]]++] = (uint16_t)i;
+        }
+    }
+    for (int b = SEARCH_BUCKETS; b > 0; b--) {
+        bucket_start[b] = bucket_start[b - 1];
+    }
+    bucket_start[0] = 0;
+
+    index_dirty = false;
+    session_valid = false;
+    stats.builds++;
+}
+
+static void new_session(void) {
+    if (++stamp == 0) {
+        memset(hit_stamp, 0, sizeof(hit_stamp));
+        stamp = 1;
+    }
+    touched_count = 0;
+    walked_count = 0;
+    session_len = 0;
+    session_valid = true;
+}
+
+// Count one query trigram's bucket toward every entry listed under it
+static void walk_bucket(uint16_t bucket) {
+    for (int i = 0; i < walked_count; i++) {
+        if (walked[i] == bucket) return;
+    }
+    walked[walked_count++] = bucket;
+    stats.lists_walked++;
+
+    for (uint32_t p = bucket_start[bucket]; p < bucket_start[bucket + 1]; p++) {
+        uint16_t e = postings[p];
+        if (hit_stamp[e] != stamp) {
+            hit_stamp[e] = stamp;
+            hits[e] = 0;
+            touched[touched_count++] = e;
+        }
+        hits[e]++;
+    }
+}
+
+static bool word_prefix_at(const search_entry_t *e, const char *q, int len) {
+    for (int i = 0; i + len <= e->len; i++) {
+        if ((i == 0 || !is_word_char(e->text[i - 1])) && memcmp(&e->text[i], q, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool substring_at(const search_entry_t *e, const char *q, int len) {
+    for (int i = 0; i + len <= e->len; i++) {
+        if (memcmp(&e->text[i], q, len) == 0) return true;
+    }
+    return false;
+}
+
+// Exact tiers, best first; 0 if the query isn't in the text as typed
+static int exact_score(const search_entry_t *e, const char *q, int len) {
+    if (len <= e->name_len && memcmp(e->text, q, len) == 0) return SEARCH_SCORE_NAME_PREFIX;
+    if (word_prefix_at(e, q, len)) return SEARCH_SCORE_WORD_PREFIX;
+    if (substring_at(e, q, len)) return SEARCH_SCORE_SUBSTRING;
+    return 0;
+}
+
+// Keep out[] sorted best first: higher score, then shorter name, then entry order
+static int insert_result(search_result_t *out, uint16_t *order, int count, int max, int entry, int score) {
+    const search_entry_t *e = &entries[entry];
+    int pos = count;
+    while (pos > 0) {
+        const search_entry_t *prev = &entries[order[pos - 1]];
+        int prev_score = out[pos - 1].score;
+        if (prev_score > score || (prev_score == score &&
+            (prev->name_len < e->name_len || (prev->name_len == e->name_len && order[pos - 1] < entry)))) {
+            break;
+        }
+        pos--;
+    }
+    if (pos >= max) return count;
+
+    int last = count < max ? count : max - 1;
+    for (int i = last; i > pos; i--) {
+        out[i] = out[i - 1];
+        order[i] = order[i - 1];
+    }
+    out[pos].id = e->id;
+    out[pos].score = score;
+    order[pos] = (uint16_t)entry;
+    return count < max ? count + 1 : count;
+}
+
+int app_search_query(const char *query, search_result_t *out, int max) {
+    char q[SEARCH_QUERY_MAX];
+    int len = 0;
+    while (query[len] && len < SEARCH_QUERY_MAX - 1) {
+        q[len] = fold(query[len]);
+        len++;
+    }
+    q[len] = '\0';
+
+    if (index_dirty) build_index();
+    stats.queries++;
+    stats.candidates = 0;
+    if (max > SEARCH_MAX_RESULTS) max = SEARCH_MAX_RESULTS;
+    if (len == 0 || max <= 0) {
+        session_valid = false;
+        return 0;
+    }
+
+    uint16_t order[SEARCH_MAX_RESULTS];
+    int count = 0;
+
+    // Too short for trigrams: everything with a word starting this way
+    if (len < 3) {
+        session_valid = false;
+        uint16_t bucket = len == 1 ? gram_bucket(0, 0, q[0]) : gram_bucket(0, q[0], q[1]);
+        stats.lists_walked++;
+        for (uint32_t p = bucket_start[bucket]; p < bucket_start[bucket + 1]; p++) {
+            int entry = postings[p];
+            int score = exact_score(&entries[entry], q, len);
+            stats.candidates++;
+            if (score >= SEARCH_SCORE_WORD_PREFIX) {
+                count = insert_result(out, order, count, max, entry, score);
+            }
+        }
+        return count;
+    }
+
+    // Typing onto the previous query keeps its counts; anything else starts over
+    int from = 0;
+    if (session_valid && session_len >= 3 && len > session_len && memcmp(q, session_query, session_len) == 0) {
+        from = session_len - 2;
+        stats.incremental++;
+    } else {
+        new_session();
+    }
+    for (int k = from; k + 2 < len; k++) {
+        walk_bucket(gram_bucket(q[k], q[k + 1], q[k + 2]));
+    }
+    memcpy(session_query, q, len);
+    session_len = len;
+
+    int trigrams = walked_count;
+    int need = (trigrams + 1) / 2;
+    for (int i = 0; i < touched_count; i++) {
+        int entry = touched[i];
+        if (hits[entry] < need) continue;
+        stats.candidates++;
+
+        int score = exact_score(&entries[entry], q, len);
+        if (score == 0) {
+            if (trigrams < SEARCH_FUZZY_MIN_TRIGRAMS) continue;
+            score = hits[entry] * SEARCH_SCORE_FUZZY_MAX / trigrams;
+        }
+        count = insert_result(out, order, count, max, entry, score);
+    }
+    return count;
+}
+
+void app_search_get_stats(app_search_stats_t *out) {
+    *out = stats;
+    out->entries = (uint32_t)entry_count;
+    out->postings = posting_total;
+}
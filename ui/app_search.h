@@ -0,0 +1,51 @@
+#ifndef APP_SEARCH_H
+#define APP_SEARCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Index capacity; ids and postings are 16-bit
+#define SEARCH_MAX_ENTRIES      4096
+#define SEARCH_TEXT_MAX         64          // Searchable text kept per entry (name + keywords)
+#define SEARCH_QUERY_MAX        64
+#define SEARCH_BUCKETS          4096        // Hashed gram buckets; must be a power of two
+#define SEARCH_MAX_POSTINGS     (SEARCH_MAX_ENTRIES * 40)
+#define SEARCH_MAX_RESULTS      16
+
+// Ranking tiers; fuzzy matches score below SEARCH_SCORE_SUBSTRING by how
+// many of the query's trigrams they share
+#define SEARCH_SCORE_NAME_PREFIX 1000
+#define SEARCH_SCORE_WORD_PREFIX 800
+#define SEARCH_SCORE_SUBSTRING   600
+#define SEARCH_SCORE_FUZZY_MAX   500
+
+typedef struct {
+    int id;                 // As passed to app_search_add()
+    int score;
+} search_result_t;
+
+typedef struct {
+    uint32_t entries;
+    uint32_t postings;
+    uint32_t builds;
+    uint32_t queries;
+    uint32_t incremental;   // Queries answered by extending the previous one
+    uint32_t lists_walked;  // Posting lists read by queries
+    uint32_t candidates;    // Entries scored by the last query
+} app_search_stats_t;
+
+// Drop every entry
+void app_search_clear(void);
+
+// Index an entry under its name and extra keywords (may be NULL). The index
+// is rebuilt on the next query. Returns -1 when the index is full.
+int app_search_add(int id, const char *name, const char *keywords);
+
+// Ranked matches for query, best first; returns how many were written.
+// Case-insensitive. Calling it with the previous query plus more characters
+// (typing) only reads the posting lists of the new trigrams.
+int app_search_query(const char *query, search_result_t *out, int max);
+
+void app_search_get_stats(app_search_stats_t *stats);
+
+#endif // APP_SEARCH_H
@@ -0,0 +1,386 @@
+// effect_pool.c - one pooled engine for animations and touch feedback
+#include "effect_pool.h"
+#include "animations.h"
+#include "../drivers/display4k.h"
+#include "../kernel/timer.h"
+#include <string.h>
+
+// Ripples start this large and grow to the effect's width
+#define RING_START_RADIUS 5
+
+// Handles are (generation << 8) | slot
+#define ID_SLOT_BITS 8
+#define ID_SLOT_MASK ((1 << ID_SLOT_BITS) - 1)
+
+// Live effects are packed into [0, live_count) of these arrays, so the update
+// pass walks contiguous memory field by field. Removal swaps the last live
+// effect into the hole; handles go through the slot table to find them.
+static struct {
+    int16_t x[EFFECT_POOL_SIZE];
+    int16_t y[EFFECT_POOL_SIZE];
+    int16_t width[EFFECT_POOL_SIZE];
+    int16_t height[EFFECT_POOL_SIZE];
+    uint32_t color[EFFECT_POOL_SIZE];
+    uint32_t start[EFFECT_POOL_SIZE];
+    uint32_t duration[EFFECT_POOL_SIZE];
+    uint32_t progress[EFFECT_POOL_SIZE];    // Q16, ANIM_ONE once finished
+    uint8_t kind[EFFECT_POOL_SIZE];
+    uint8_t flags[EFFECT_POOL_SIZE];
+    uint8_t slot[EFFECT_POOL_SIZE];         // Owning handle slot
+
+    // Shape computed by the last update
+    int16_t draw_x[EFFECT_POOL_SIZE];
+    int16_t draw_y[EFFECT_POOL_SIZE];
+    int16_t draw_w[EFFECT_POOL_SIZE];       // Radius for circles and rings
+    int16_t draw_h[EFFECT_POOL_SIZE];
+    uint32_t draw_color[EFFECT_POOL_SIZE];
+    clip_rect_t bounds[EFFECT_POOL_SIZE];   // Pixels the next draw touches
+    clip_rect_t drawn[EFFECT_POOL_SIZE];    // Pixels the previous draw touched
+} fx;
+
+static int live_count = 0;
+
+// Handle slots: free list of unused slots, dense index of used ones
+static int16_t slot_dense[EFFECT_POOL_SIZE];
+static int16_t slot_next_free[EFFECT_POOL_SIZE];
+static uint16_t slot_generation[EFFECT_POOL_SIZE];
+static int16_t free_head = -1;
+
+// Pixels of effects removed outside the update pass, erased by the next update
+static dl_damage_t orphan_damage;
+
+// Handles of live effects, nearest to finishing first. Built by the first
+// spawn into a full pool after an update; later ones in the same frame pop
+// from it instead of scanning the pool again.
+static effect_id_t recycle_order[EFFECT_POOL_SIZE];
+static int recycle_count = 0;
+static int recycle_next = 0;
+
+static effect_pool_stats_t stats;
+
+static const clip_rect_t no_rect = { 0, 0, 0, 0 };
+
+void effect_pool_init(void) {
+    live_count = 0;
+    orphan_damage.count = 0;
+    recycle_count = recycle_next = 0;
+    memset(&stats, 0, sizeof(stats));
+
+    free_head = -1;
+    for (int i = EFFECT_POOL_SIZE - 1; i >= 0; i--) {
+        slot_dense[i] = -1;
+        slot_next_free[i] = free_head;
+        free_head = (int16_t)i;
+    }
+}
+
+// Drop dense entry i, keeping [0, live_count) packed
+static void remove_dense(int i) {
+    int slot = fx.slot[i];
+    slot_dense[slot] = -1;
+    slot_generation[slot]++;
+    slot_next_free[slot] = free_head;
+    free_head = (int16_t)slot;
+
+    int last = --live_count;
+    if (i != last) {
+        fx.x[i] = fx.x[last];
+        fx.y[i] = fx.y[last];
+        fx.width[i] = fx.width[last];
+        fx.height[i] = fx.height[last];
+        fx.color[i] = fx.color[last];
+        fx.start[i] = fx.start[last];
+        fx.duration[i] = fx.duration[last];
+        fx.progress[i] = fx.progress[last];
+        fx.kind[i] = fx.kind[last];
+        fx.flags[i] = fx.flags[last];
+        fx.slot[i] = fx.slot[last];
+        fx.draw_x[i] = fx.draw_x[last];
+        fx.draw_y[i] = fx.draw_y[last];
+        fx.draw_w[i] = fx.draw_w[last];
+        fx.draw_h[i] = fx.draw_h[last];
+        fx.draw_color[i] = fx.draw_color[last];
+        fx.bounds[i] = fx.bounds[last];
+        fx.drawn[i] = fx.drawn[last];
+        slot_dense[fx.slot[i]] = (int16_t)i;
+    }
+    stats.live = (uint32_t)live_count;
+}
+
+static effect_id_t handle_of(int i) {
+    int slot = fx.slot[i];
+    return (effect_id_t)((slot_generation[slot] << ID_SLOT_BITS) | slot);
+}
+
+static int lookup(effect_id_t id);
+
+// Order the live effects by progress, furthest along first
+static void build_recycle_order(void) {
+    int order[EFFECT_POOL_SIZE];
+    for (int i = 0; i < live_count; i++) {
+        int k = i;
+        while (k > 0 && fx.progress[order[k - 1]] < fx.progress[i]) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = i;
+    }
+    for (int k = 0; k < live_count; k++) {
+        recycle_order[k] = handle_of(order[k]);
+    }
+    recycle_count = live_count;
+    recycle_next = 0;
+}
+
+// Make room when every slot is taken: retire the effect nearest its end.
+// Effects cancelled or recycled since the order was built are skipped; once
+// it runs out (everything left was spawned this frame) it is rebuilt.
+static void recycle_one(void) {
+    int victim = -1;
+    while (victim < 0) {
+        if (recycle_next >= recycle_count) build_recycle_order();
+        victim = lookup(recycle_order[recycle_next++]);
+    }
+    dl_damage_add(&orphan_damage, &fx.drawn[victim]);
+    remove_dense(victim);
+    stats.recycled++;
+}
+
+effect_id_t effect_spawn(effect_kind_t kind, int x, int y, int width, int height,
+                         uint32_t color, uint32_t duration_ms, uint8_t flags) {
+    if (free_head < 0) recycle_one();
+
+    int slot = free_head;
+    free_head = slot_next_free[slot];
+
+    int i = live_count++;
+    slot_dense[slot] = (int16_t)i;
+
+    if (duration_ms < 1) duration_ms = 1;
+    if (duration_ms > ANIM_MAX_DURATION_MS) duration_ms = ANIM_MAX_DURATION_MS;
+
+    fx.x[i] = (int16_t)x;
+    fx.y[i] = (int16_t)y;
+    fx.width[i] = (int16_t)width;
+    fx.height[i] = (int16_t)height;
+    fx.color[i] = color;
+    fx.start[i] = timer_now_ms();
+    fx.duration[i] = duration_ms;
+    fx.progress[i] = 0;
+    fx.kind[i] = (uint8_t)kind;
+    fx.flags[i] = flags;
+    fx.slot[i] = (uint8_t)slot;
+    fx.bounds[i] = no_rect;
+    fx.drawn[i] = no_rect;
+
+    stats.spawned++;
+    stats.live = (uint32_t)live_count;
+    if (stats.live > stats.peak) stats.peak = stats.live;
+
+    return handle_of(i);
+}
+
+// Dense index of a live handle, or -1
+static int lookup(effect_id_t id) {
+    if (id < 0) return -1;
+    int slot = id & ID_SLOT_MASK;
+    if (slot >= EFFECT_POOL_SIZE) return -1;
+    if (slot_generation[slot] != (uint16_t)(id >> ID_SLOT_BITS)) return -1;
+    return slot_dense[slot];
+}
+
+bool effect_is_live(effect_id_t id) {
+    return lookup(id) >= 0;
+}
+
+void effect_cancel(effect_id_t id) {
+    int i = lookup(id);
+    if (i < 0) return;
+    dl_damage_add(&orphan_damage, &fx.drawn[i]);
+    remove_dense(i);
+}
+
+uint32_t effect_fade_color(uint32_t color, int alpha) {
+    if (alpha >= 128) return color;
+    uint32_t r = ((color >> 16) & 0xFF) * (uint32_t)alpha / 255;
+    uint32_t g = ((color >> 8) & 0xFF) * (uint32_t)alpha / 255;
+    uint32_t b = (color & 0xFF) * (uint32_t)alpha / 255;
+    return (r << 16) | (g << 8) | b;
+}
+
+static inline int fix_scale(int v, uint32_t q16) {
+    return (int)(((int64_t)v * q16) >> ANIM_FIX_SHIFT);
+}
+
+static void set_box(int i, int x, int y, int w, int h) {
+    fx.draw_x[i] = (int16_t)x;
+    fx.draw_y[i] = (int16_t)y;
+    fx.draw_w[i] = (int16_t)w;
+    fx.draw_h[i] = (int16_t)h;
+    fx.bounds[i].x0 = x;
+    fx.bounds[i].y0 = y;
+    fx.bounds[i].x1 = x + w;
+    fx.bounds[i].y1 = y + h;
+}
+
+static void set_circle(int i, int radius, int extent) {
+    fx.draw_x[i] = fx.x[i];
+    fx.draw_y[i] = fx.y[i];
+    fx.draw_w[i] = (int16_t)radius;
+    fx.bounds[i].x0 = fx.x[i] - extent;
+    fx.bounds[i].y0 = fx.y[i] - extent;
+    fx.bounds[i].x1 = fx.x[i] + extent + 1;
+    fx.bounds[i].y1 = fx.y[i] + extent + 1;
+}
+
+// Work out where and how effect i is drawn at eased time t
+static void compute_frame(int i, uint32_t t, uint32_t elapsed) {
+    uint32_t color = fx.color[i];
+    fx.bounds[i] = no_rect;
+
+    if (fx.flags[i] & EFFECT_FADE_OUT) {
+        uint32_t alpha = ((ANIM_ONE - t) * 255 * 3 / 2) >> ANIM_FIX_SHIFT;
+        color = effect_fade_color(color, alpha > 255 ? 255 : (int)alpha);
+    }
+
+    switch (fx.kind[i]) {
+        case EFFECT_FADE_IN: {
+            uint32_t alpha = ease_in_out(t);
+            color = (color & 0x00FFFFFF) | (((alpha * 255) >> ANIM_FIX_SHIFT) << 24);
+            set_box(i, fx.x[i], fx.y[i], fx.width[i], fx.height[i]);
+            break;
+        }
+        case EFFECT_SCALE: {
+            uint32_t scale = ease_in_out(t);
+            int w = fix_scale(fx.width[i], scale);
+            int h = fix_scale(fx.height[i], scale);
+            set_box(i, fx.x[i] + (fx.width[i] - w) / 2, fx.y[i] + (fx.height[i] - h) / 2, w, h);
+            break;
+        }
+        case EFFECT_BOUNCE: {
+            int offset_y = fix_scale(20, ANIM_ONE - ease_bounce(t));
+            set_box(i, fx.x[i], fx.y[i] - offset_y, fx.width[i], fx.height[i]);
+            break;
+        }
+        case EFFECT_PULSE: {
+            // Two full sine periods over the effect, mapped to 0..1
+            uint32_t pulse = (uint32_t)(sin_q16(t * 2) + ANIM_ONE) >> 1;
+            int radius = fix_scale(fx.width[i], pulse);
+            color = (color & 0x00FFFFFF) | (((pulse * 255) >> ANIM_FIX_SHIFT) << 24);
+            set_circle(i, radius, radius);
+            break;
+        }
+        case EFFECT_RING:
+        case EFFECT_DOUBLE_RING:
+        case EFFECT_DOT:
+        case EFFECT_JITTER_RING:
+        case EFFECT_SPARKLE_RING: {
+            int radius = RING_START_RADIUS + fix_scale(fx.width[i] - RING_START_RADIUS, t);
+            if (fx.kind[i] == EFFECT_DOT) {
+                radius /= 2;
+            } else if (fx.kind[i] == EFFECT_JITTER_RING) {
+                radius += (int)((elapsed >> 4) % 6) - 3;     // Shakes every 16 ms
+            }
+            fx.draw_h[i] = fx.height[i];
+            // Sparkles sit up to two pixels outside the ring
+            set_circle(i, radius, radius + 2);
+            break;
+        }
+        default:
+            break;
+    }
+    fx.draw_color[i] = color;
+}
+
+void effect_pool_update(dl_damage_t *damage) {
+    uint32_t now = timer_now_ms();
+
+    for (int i = 0; i < orphan_damage.count; i++) {
+        dl_damage_add(damage, &orphan_damage.rects[i]);
+    }
+    orphan_damage.count = 0;
+
+    // Progress is about to change: the next overflow reorders
+    recycle_count = recycle_next = 0;
+
+    // Progress for every live effect; ANIM_ONE marks a finished one
+    for (int i = 0; i < live_count; i++) {
+        int32_t elapsed = timer_diff(now, fx.start[i]);
+        if (elapsed < 0) elapsed = 0;
+        fx.progress[i] = (uint32_t)elapsed >= fx.duration[i]
+            ? ANIM_ONE
+            : ((uint32_t)elapsed << ANIM_FIX_SHIFT) / fx.duration[i];
+    }
+
+    // Shapes and damage. Walking backwards lets remove_dense() swap in an
+    // effect that has already been handled.
+    for (int i = live_count - 1; i >= 0; i--) {
+        // Whatever was drawn last frame has to be erased either way
+        dl_damage_add(damage, &fx.drawn[i]);
+
+        if (fx.progress[i] >= ANIM_ONE) {
+            remove_dense(i);
+            continue;
+        }
+
+        uint32_t t = (fx.flags[i] & EFFECT_REVERSE) ? ANIM_ONE - fx.progress[i] : fx.progress[i];
+        compute_frame(i, t, (uint32_t)timer_diff(now, fx.start[i]));
+        dl_damage_add(damage, &fx.bounds[i]);
+    }
+}
+
+static void draw_ring(int cx, int cy, int radius, uint32_t color, int thickness) {
+    for (int k = 0; k < thickness && radius - k > 0; k++) {
+        draw_circle_border(cx, cy, radius - k, color);
+    }
+}
+
+static void draw_sparkles(int cx, int cy, int radius, uint32_t color) {
+    for (int k = 0; k < 8; k++) {
+        uint32_t turns = (uint32_t)k * (ANIM_ONE / 8);
+        int sx = cx + (radius * sin_q16(turns + ANIM_ONE / 4)) / ANIM_ONE;
+        int sy = cy + (radius * sin_q16(turns)) / ANIM_ONE;
+        draw_pixel(sx, sy, color);
+        draw_pixel(sx + 1, sy, color);
+        draw_pixel(sx, sy + 1, color);
+    }
+}
+
+void effect_pool_draw(void) {
+    for (int i = 0; i < live_count; i++) {
+        int x = fx.draw_x[i], y = fx.draw_y[i];
+        int w = fx.draw_w[i], h = fx.draw_h[i];
+        uint32_t color = fx.draw_color[i];
+
+        switch (fx.kind[i]) {
+            case EFFECT_FADE_IN:
+            case EFFECT_SCALE:
+            case EFFECT_BOUNCE:
+                draw_rect(x, y, w, h, color);
+                break;
+            case EFFECT_PULSE:
+            case EFFECT_DOT:
+                draw_circle(x, y, w, color);
+                break;
+            case EFFECT_RING:
+            case EFFECT_JITTER_RING:
+                draw_ring(x, y, w, color, h);
+                break;
+            case EFFECT_DOUBLE_RING:
+                draw_ring(x, y, w, color, h);
+                draw_ring(x, y, w - 10, color, h);
+                break;
+            case EFFECT_SPARKLE_RING:
+                draw_ring(x, y, w, color, h);
+                draw_sparkles(x, y, w, color);
+                break;
+            default:
+                break;
+        }
+        fx.drawn[i] = fx.bounds[i];
+    }
+}
+
+void effect_pool_get_stats(effect_pool_stats_t *out) {
+    *out = stats;
+}
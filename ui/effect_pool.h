@@ -0,0 +1,63 @@
+#ifndef EFFECT_POOL_H
+#define EFFECT_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../drivers/display_list.h"
+
+// Shared by animations and touch feedback
+#define EFFECT_POOL_SIZE 64
+
+// Handle to a spawned effect; stale handles are detected, not reused
+typedef int32_t effect_id_t;
+#define EFFECT_NONE (-1)
+
+// What an effect draws. Rings use width as the final radius and height as
+// the stroke thickness; everything else uses the box as given.
+typedef enum {
+    EFFECT_TIMER = 0,       // Times a transition, draws nothing
+    EFFECT_FADE_IN,         // Rect whose alpha eases in
+    EFFECT_SCALE,           // Rect growing from its center
+    EFFECT_BOUNCE,          // Rect dropping into place with a bounce
+    EFFECT_PULSE,           // Filled circle pulsing twice
+    EFFECT_RING,            // Ripple ring expanding from the touch point
+    EFFECT_DOUBLE_RING,     // Two concentric ripples
+    EFFECT_DOT,             // Small filled circle
+    EFFECT_JITTER_RING,     // Ripple whose radius shakes
+    EFFECT_SPARKLE_RING,    // Ripple with eight sparkles on its edge
+    EFFECT_KIND_COUNT
+} effect_kind_t;
+
+// Spawn flags
+#define EFFECT_REVERSE   0x01   // Run the curve from end to start
+#define EFFECT_FADE_OUT  0x02   // Darken over the last two thirds
+
+typedef struct {
+    uint32_t spawned;
+    uint32_t recycled;      // Live effects replaced because the pool was full
+    uint32_t live;
+    uint32_t peak;
+} effect_pool_stats_t;
+
+void effect_pool_init(void);
+
+// Start an effect now. Never fails: when the pool is full the effect closest
+// to finishing is replaced (and its pixels erased on the next update).
+effect_id_t effect_spawn(effect_kind_t kind, int x, int y, int width, int height,
+                         uint32_t color, uint32_t duration_ms, uint8_t flags);
+void effect_cancel(effect_id_t id);
+bool effect_is_live(effect_id_t id);
+
+// Advance every effect to the current time in one pass and add the pixels
+// they covered last frame and will cover now to `damage`
+void effect_pool_update(dl_damage_t *damage);
+
+// Paint every live effect as computed by the last update
+void effect_pool_draw(void);
+
+// Darken a color for alpha < 128 (the framebuffer has no blending)
+uint32_t effect_fade_color(uint32_t color, int alpha);
+
+void effect_pool_get_stats(effect_pool_stats_t *stats);
+
+#endif // EFFECT_POOL_H
@@ -1,8 +1,13 @@
-/ file_explorer.c
+// file_explorer.c
 #include "file_explorer.h"
 #include "../drivers/display4k.h"
-#include "../filesystem/filesystem.h"
+#include "../drivers/font_render.h"
 #include "animations.h"
+#include "thumbnail_cache.h"
+#include "frame_pacer.h"
+#include "../kernel/timer.h"
+#include "../kernel/dircache.h"
+#include "../kernel/app_manager.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -10,6 +15,31 @@ static file_explorer_state_t explorer_state;
 static int context_menu_open = 0;
 static int context_menu_x = 0, context_menu_y = 0;
 
+// Retained display lists for the file area and the surrounding chrome
+static display_list_t content_list;
+static display_list_t chrome_list;
+static int needs_full_redraw = 1;
+static int shown_scroll_offset = 0;  // scroll_offset of the rows on screen
+
+// Change watch on the directory on screen, if its source can identify it
+static int dir_watch = -1;
+static uint32_t watched_inode = 0;
+
+// List view geometry
+#define LIST_TOP        120
+#define LIST_ROW_HEIGHT 50
+#define LIST_VISIBLE_ROWS ((SCREEN_HEIGHT - 200) / LIST_ROW_HEIGHT)
+
+// Background work (directory sorting, then thumbnails): leave this much of
+// each frame for presenting, and spend this much per scheduler tick while in
+// the background
+#define THUMB_PRESENT_MARGIN_US   2000
+#define THUMB_BACKGROUND_US       4000
+
+// Enumeration done up front when a directory opens, so small ones show up
+// already sorted; bigger ones are listed as they are and sorted in the background
+#define LIST_OPEN_BUDGET_US       2000
+
 // File type icons (Unicode emojis)
 static const char* file_icons[] = {
     "📁", // Folder
@@ -21,101 +51,211 @@ static const char* file_icons[] = {
     "📋"  // Unknown
 };
 
+// Stand-in directory contents until the explorer reads a real filesystem;
+// every directory shows the same entries. Each path is still its own
+// directory to the directory cache: its inode is a hash of the path, and its
+// generation never moves, as nothing changes it.
+static const struct {
+    const char* name;
+    file_type_t type;
+    uint64_t size;
+} sample_files[] = {
+    { "..",            FILE_TYPE_FOLDER, 0 },
+    { "Documents",     FILE_TYPE_FOLDER, 0 },
+    { "Pictures",      FILE_TYPE_FOLDER, 0 },
+    { "readme.txt",    FILE_TYPE_TEXT,   1024 },
+    { "wallpaper.png", FILE_TYPE_IMAGE,  2048576 },
+};
+
+#define SAMPLE_FILE_COUNT ((int)(sizeof(sample_files) / sizeof(sample_files[0])))
+
+static uint32_t sample_inode = 0;
+
+static int sample_open(const char* path, void** dir) {
+    uint32_t h = 2166136261u;
+    while (*path) {
+        h ^= (uint8_t)*path++;
+        h *= 16777619u;
+    }
+    sample_inode = h;
+    *dir = (void*)sample_files;
+    return 0;
+}
+
+static int sample_count(void* dir) {
+    (void)dir;
+    return SAMPLE_FILE_COUNT;
+}
+
+static int sample_read(void* dir, int index, file_entry_t* out) {
+    (void)dir;
+    if (index < 0 || index >= SAMPLE_FILE_COUNT) return -1;
+    out->name = sample_files[index].name;
+    out->type = sample_files[index].type;
+    out->size = sample_files[index].size;
+    out->modified_time = 0;
+    return 0;
+}
+
+static int sample_identify(void* dir, uint32_t* inode, uint32_t* generation) {
+    (void)dir;
+    *inode = sample_inode;
+    *generation = 1;
+    return 0;
+}
+
+static const dir_source_t sample_source = { sample_open, sample_count, sample_read, NULL, sample_identify };
+
+static void reset_display_lists(void) {
+    dl_init(&content_list, 0x111111);
+    dl_init(&chrome_list, 0x111111);
+    dl_set_bounds(&content_list, 0, 60, SCREEN_WIDTH, SCREEN_HEIGHT - 100);
+    needs_full_redraw = 1;
+}
+
 void file_explorer_init(void) {
     memset(&explorer_state, 0, sizeof(file_explorer_state_t));
     strcpy(explorer_state.current_path, "/");
     explorer_state.view_mode = 0; // List view
     explorer_state.sort_mode = 0; // Sort by name
+    reset_display_lists();
+    thumbnail_cache_init();
+    dircache_unwatch(dir_watch);
+    dir_watch = -1;
+    file_list_set_sort((file_sort_t)explorer_state.sort_mode);
+    file_list_set_source(&sample_source);
     file_explorer_refresh();
 }
 
+void file_explorer_set_source(const dir_source_t* source) {
+    file_list_set_source(source);
+    file_explorer_refresh();
+}
+
+// Track the list's entry count, which grows while a directory is enumerated
+static void sync_file_count(void) {
+    explorer_state.file_count = file_list_count();
+    if (explorer_state.selected_file >= explorer_state.file_count) {
+        explorer_state.selected_file = 0;
+        explorer_state.scroll_offset = 0;
+    }
+}
+
+// Keep one watch, on the directory the list has open
+static void watch_current_dir(void) {
+    uint32_t inode = 0;
+    bool known = file_list_identity(&inode);
+    if (known && dir_watch >= 0 && inode == watched_inode) return;
+
+    dircache_unwatch(dir_watch);
+    dir_watch = known ? dircache_watch(inode) : -1;
+    watched_inode = inode;
+}
+
+// Reopen the current directory, cancelling any enumeration of the previous
+// one. Rows are fetched a page at a time as they scroll into view; sorting
+// finishes in the background if it doesn't fit in LIST_OPEN_BUDGET_US.
 void file_explorer_refresh(void) {
-    // Simulate loading files (in real implementation, use filesystem API)
-    explorer_state.file_count = 0;
-    
-    // Add some sample files
-    strcpy(explorer_state.files[0].name, "..");
-    strcpy(explorer_state.files[0].path, "/");
-    explorer_state.files[0].type = FILE_TYPE_FOLDER;
-    explorer_state.files[0].size = 0;
-    explorer_state.file_count++;
-    
-    strcpy(explorer_state.files[1].name, "Documents");
-    strcpy(explorer_state.files[1].path, "/Documents");
-    explorer_state.files[1].type = FILE_TYPE_FOLDER;
-    explorer_state.files[1].size = 0;
-    explorer_state.file_count++;
-    
-    strcpy(explorer_state.files[2].name, "Pictures");
-    strcpy(explorer_state.files[2].path, "/Pictures");
-    explorer_state.files[2].type = FILE_TYPE_FOLDER;
-    explorer_state.files[2].size = 0;
-    explorer_state.file_count++;
+    file_list_open(explorer_state.current_path);
+    file_list_pump(LIST_OPEN_BUDGET_US);
+    sync_file_count();
+    watch_current_dir();
+}
+
+// Reopen the directory when it changes. The filesystem patches its cached
+// listing as it goes, so this reads nothing from the source.
+static void poll_dir_changes(void) {
+    dircache_event_t event;
+    bool changed = false;
+    while (dircache_poll(dir_watch, &event)) {
+        changed = true;
+    }
+    if (changed) file_explorer_refresh();
+}
+
+// Full path of an entry of the current directory ("..": its parent); NULL
+// when it would be too long to navigate to
+static const char* entry_path(const char* name) {
+    static char path[MAX_PATH_LEN + MAX_FILENAME_LEN + 1];
+    const char* dir = explorer_state.current_path;
+    size_t dir_len = strlen(dir);
     
-    strcpy(explorer_state.files[3].name, "readme.txt");
-    strcpy(explorer_state.files[3].path, "/readme.txt");
-    explorer_state.files[3].type = FILE_TYPE_TEXT;
-    explorer_state.files[3].size = 1024;
-    explorer_state.file_count++;
+    if (strcmp(name, "..") == 0) {
+        snprintf(path, sizeof(path), "%s", dir);
+        char* slash = strrchr(path, '/');
+        if (slash && slash != path && slash[1] == '\0') {
+            *slash = '\0';                 // Trailing slash
+            slash = strrchr(path, '/');
+        }
+        if (slash) slash[slash == path ? 1 : 0] = '\0';
+        return path;
+    }
     
-    strcpy(explorer_state.files[4].name, "wallpaper.png");
-    strcpy(explorer_state.files[4].path, "/wallpaper.png");
-    explorer_state.files[4].type = FILE_TYPE_IMAGE;
-    explorer_state.files[4].size = 2048576;
-    explorer_state.file_count++;
+    bool has_slash = dir_len > 0 && dir[dir_len - 1] == '/';
+    int len = snprintf(path, sizeof(path), "%s%s%s", dir, has_slash ? "" : "/", name);
+    return len >= 0 && len < MAX_PATH_LEN ? path : NULL;
 }
 
-void draw_file_icon(int x, int y, file_type_t type, int selected) {
+void draw_file_icon(display_list_t* dl, int x, int y, const file_entry_t* file, int selected) {
     uint32_t bg_color = selected ? 0x0066CC : 0x333333;
     uint32_t text_color = selected ? 0xFFFFFF : 0xCCCCCC;
     
     if (selected) {
-        draw_rounded_rect(x - 5, y - 5, 70, 70, 10, bg_color);
-        animate_pulse_notification(x + 30, y + 30, 35);
+        dl_rounded_rect(dl, x - 5, y - 5, 70, 70, 10, bg_color);
+    }
+    
+    // Images show their thumbnail once the cache has one; until then the
+    // placeholder below is drawn and the file is queued for generation
+    if (file->type == FILE_TYPE_IMAGE) {
+        thumbnail_t thumb;
+        const char* path = entry_path(file->name);
+        if (path && thumbnail_cache_get(path, file->modified_time, &thumb)) {
+            dl_image(dl, x, y, THUMB_SIZE, THUMB_SIZE, thumb.pixels, thumb.stamp);
+            return;
+        }
     }
     
     // Draw icon background
-    draw_rounded_rect(x, y, 60, 60, 8, selected ? 0x0088FF : 0x555555);
+    dl_rounded_rect(dl, x, y, 60, 60, 8, selected ? 0x0088FF : 0x555555);
     
     // Draw file type icon (simplified - in real implementation use actual icons)
-    const char* icon = file_icons[type];
-    draw_string(x + 20, y + 20, icon, text_color);
+    const char* icon = file_icons[file->type];
+    dl_text(dl, x + 20, y + 20, icon, text_color);
 }
 
 void draw_file_list(void) {
-    int y_offset = 120;
-    int visible_files = (SCREEN_HEIGHT - 200) / 50;
-    
     for (int i = explorer_state.scroll_offset; 
-         i < explorer_state.file_count && i < explorer_state.scroll_offset + visible_files; 
+         i < explorer_state.file_count && i < explorer_state.scroll_offset + LIST_VISIBLE_ROWS; 
          i++) {
         
-        int y = y_offset + (i - explorer_state.scroll_offset) * 50;
+        file_entry_t file;
+        if (!file_list_get(i, &file)) continue;
+        
+        int y = LIST_TOP + (i - explorer_state.scroll_offset) * LIST_ROW_HEIGHT;
         int selected = (i == explorer_state.selected_file);
         
         if (selected) {
-            draw_rect(50, y - 5, SCREEN_WIDTH - 100, 40, 0x0066CC);
-            animate_bounce_icon(60, y, 30, 30);
+            dl_rect(&content_list, 50, y - 5, SCREEN_WIDTH - 100, 40, 0x0066CC);
         }
         
         // Draw file icon
-        draw_file_icon(60, y, explorer_state.files[i].type, selected);
+        draw_file_icon(&content_list, 60, y, &file, selected);
         
         // Draw file name
         uint32_t text_color = selected ? 0xFFFFFF : 0xCCCCCC;
-        draw_string(130, y + 15, explorer_state.files[i].name, text_color);
+        dl_text(&content_list, 130, y + 15, file.name, text_color);
         
         // Draw file size for non-folders
-        if (explorer_state.files[i].type != FILE_TYPE_FOLDER) {
+        if (file.type != FILE_TYPE_FOLDER) {
             char size_str[32];
-            if (explorer_state.files[i].size > 1024 * 1024) {
-                sprintf(size_str, "%.1f MB", explorer_state.files[i].size / (1024.0 * 1024.0));
-            } else if (explorer_state.files[i].size > 1024) {
-                sprintf(size_str, "%.1f KB", explorer_state.files[i].size / 1024.0);
+            if (file.size > 1024 * 1024) {
+                sprintf(size_str, "%.1f MB", file.size / (1024.0 * 1024.0));
+            } else if (file.size > 1024) {
+                sprintf(size_str, "%.1f KB", file.size / 1024.0);
             } else {
-                sprintf(size_str, "%llu bytes", explorer_state.files[i].size);
+                sprintf(size_str, "%llu bytes", (unsigned long long)file.size);
             }
-            draw_string(SCREEN_WIDTH - 200, y + 15, size_str, 0x888888);
+            dl_text(&content_list, SCREEN_WIDTH - 200, y + 15, size_str, 0x888888);
         }
     }
 }
@@ -134,43 +274,55 @@ void draw_file_grid(void) {
         
         if (y > SCREEN_HEIGHT - 150) break;
         
+        file_entry_t file;
+        if (!file_list_get(i, &file)) continue;
+        
         int selected = (i == explorer_state.selected_file);
         
         // Draw file icon
-        draw_file_icon(x, y, explorer_state.files[i].type, selected);
+        draw_file_icon(&content_list, x, y, &file, selected);
         
         // Draw file name (truncated if necessary)
         char display_name[20];
-        strncpy(display_name, explorer_state.files[i].name, 15);
-        if (strlen(explorer_state.files[i].name) > 15) {
+        strncpy(display_name, file.name, 15);
+        display_name[15] = '\0';
+        if (strlen(file.name) > 15) {
             strcpy(display_name + 12, "...");
         }
         
         uint32_t text_color = selected ? 0xFFFFFF : 0xCCCCCC;
-        draw_string(x, y + 65, display_name, text_color);
+        dl_text(&content_list, x, y + 65, display_name, text_color);
     }
 }
 
 void draw_breadcrumb_nav(void) {
-    draw_rect(0, 0, SCREEN_WIDTH, 60, 0x222222);
-    draw_string(20, 20, "📍 Path:", 0xFFFFFF);
-    draw_string(100, 20, explorer_state.current_path, 0x00AAFF);
+    dl_rect(&chrome_list, 0, 0, SCREEN_WIDTH, 60, 0x222222);
+    dl_text(&chrome_list, 20, 20, "📍 Path:", 0xFFFFFF);
+    dl_text(&chrome_list, 100, 20, explorer_state.current_path, 0x00AAFF);
     
     // View mode toggle
     const char* view_text = explorer_state.view_mode ? "Grid View" : "List View";
-    draw_string(SCREEN_WIDTH - 150, 20, view_text, 0xFFFFFF);
+    dl_text(&chrome_list, SCREEN_WIDTH - 150, 20, view_text, 0xFFFFFF);
 }
 
 void draw_status_bar(void) {
-    draw_rect(0, SCREEN_HEIGHT - 40, SCREEN_WIDTH, 40, 0x222222);
+    dl_rect(&chrome_list, 0, SCREEN_HEIGHT - 40, SCREEN_WIDTH, 40, 0x222222);
     
     char status[128];
-    sprintf(status, "%d items", explorer_state.file_count);
-    draw_string(20, SCREEN_HEIGHT - 25, status, 0xCCCCCC);
+    sprintf(status, "%d items%s", explorer_state.file_count,
+            file_list_enumerating() ? ", loading" : file_list_busy() ? ", sorting" :
+            file_list_unsorted() ? ", unsorted" : "");
+    dl_text(&chrome_list, 20, SCREEN_HEIGHT - 25, status, 0xCCCCCC);
     
-    if (explorer_state.selected_file >= 0 && explorer_state.selected_file < explorer_state.file_count) {
-        sprintf(status, "Selected: %s", explorer_state.files[explorer_state.selected_file].name);
-        draw_string(200, SCREEN_HEIGHT - 25, status, 0x00AAFF);
+    // A long count ("102401 items, unsorted") pushes the selection along
+    int status_width;
+    measure_string(status, 1, &status_width, NULL);
+    int selected_x = 20 + status_width + 20 > 200 ? 20 + status_width + 20 : 200;
+
+    file_entry_t file;
+    if (file_list_get(explorer_state.selected_file, &file)) {
+        snprintf(status, sizeof(status), "Selected: %s", file.name);
+        dl_text(&chrome_list, selected_x, SCREEN_HEIGHT - 25, status, 0x00AAFF);
     }
 }
 
@@ -188,9 +340,6 @@ void draw_context_menu(int x, int y) {
     int menu_width = 120;
     int menu_height = item_count * 30;
     
-    // Animate menu opening
-    animate_window_open(x, y, menu_width, menu_height);
-    
     draw_rounded_rect(x, y, menu_width, menu_height, 5, 0x333333);
     draw_rect(x + 1, y + 1, menu_width - 2, menu_height - 2, 0x444444);
     
@@ -201,38 +350,147 @@ void draw_context_menu(int x, int y) {
 }
 
 void file_explorer_ui_loop(void) {
-    // Clear screen with dark background
-    clear_screen(0x111111);
+    poll_dir_changes();
+    sync_file_count();
+
+    // Clear screen only when the retained lists no longer match it
+    if (needs_full_redraw) {
+        clear_screen(0x111111);
+        dl_invalidate(&content_list);
+        dl_invalidate(&chrome_list);
+        needs_full_redraw = 0;
+    }
+    
+    // Recompose only where animations were and will be. The chrome list spans
+    // the screen, but whatever it erases over the content area is replayed by
+    // the content list right after.
+    dl_damage_t anim_damage;
+    anim_damage.count = 0;
+    update_animations(&anim_damage);
+    dl_invalidate_region(&chrome_list, &anim_damage);
+    dl_invalidate_region(&content_list, &anim_damage);
     
-    // Draw UI components
+    // Record UI components; submit repaints only what changed
+    dl_begin(&chrome_list);
     draw_breadcrumb_nav();
+    draw_status_bar();
+    dl_end(&chrome_list);
+    dl_submit(&chrome_list);
+    
+    // Shift the rows already on screen instead of redrawing them
+    if (explorer_state.view_mode == 0 && explorer_state.scroll_offset != shown_scroll_offset) {
+        clip_rect_t list_region = { 0, 60, SCREEN_WIDTH, SCREEN_HEIGHT - 40 };
+        dl_scroll(&content_list, &list_region, 0,
+                  (shown_scroll_offset - explorer_state.scroll_offset) * LIST_ROW_HEIGHT);
+    }
+    shown_scroll_offset = explorer_state.scroll_offset;
     
+    dl_begin(&content_list);
     if (explorer_state.view_mode == 0) {
         draw_file_list();
     } else {
         draw_file_grid();
     }
+    dl_end(&content_list);
+    dl_submit(&content_list);
     
-    draw_status_bar();
-    draw_context_menu(context_menu_x, context_menu_y);
+    draw_animations();
+    
+    // The context menu is immediate-mode and overlaps the lists
+    if (context_menu_open) {
+        draw_context_menu(context_menu_x, context_menu_y);
+        needs_full_redraw = 1;
+    }
     
-    // Update animations
-    update_animations();
+    // Spend what is left of the frame on sorting, then on thumbnails
+    int32_t remaining = timer_diff(frame_pacer_next_present_us(), timer_now_us()) - THUMB_PRESENT_MARGIN_US;
+    if (remaining > 0 && !file_list_pump((uint32_t)remaining)) {
+        remaining = timer_diff(frame_pacer_next_present_us(), timer_now_us()) - THUMB_PRESENT_MARGIN_US;
+        if (remaining > 0) {
+            thumbnail_cache_pump((uint32_t)remaining);
+        }
+    }
+}
+
+// Keep sorting and generating thumbnails while another app is in front
+void file_explorer_background_loop(void) {
+    if (!file_list_pump(THUMB_BACKGROUND_US)) {
+        thumbnail_cache_pump(THUMB_BACKGROUND_US);
+    }
+}
+
+// Suspension: the snapshot is the explorer state (where it was, how it was
+// looking at it); the directory, its thumbnails and the retained lists are
+// all rebuilt on resume
+static uint32_t suspend_resident_bytes(void) {
+    return (uint32_t)(sizeof(content_list) + sizeof(chrome_list) +
+                      THUMB_CACHE_SLOTS * THUMB_SIZE * THUMB_SIZE * sizeof(uint32_t));
+}
+
+static int suspend_save(app_write_fn write, void* ctx) {
+    int bytes = (int)sizeof(explorer_state);
+    return write(ctx, (const uint8_t*)&explorer_state, bytes) == bytes ? 0 : -1;
+}
+
+static void suspend_drop(void) {
+    file_list_close();
+    thumbnail_cache_init();
+    dircache_unwatch(dir_watch);
+    dir_watch = -1;
+    context_menu_open = 0;
+    reset_display_lists();
+}
+
+static int suspend_restore(app_read_fn read, void* ctx) {
+    int bytes = (int)sizeof(explorer_state);
+    if (read(ctx, (uint8_t*)&explorer_state, bytes) != bytes) {
+        file_explorer_init();
+        return -1;
+    }
+
+    // The lists start out empty, so there is nothing on screen to scroll
+    shown_scroll_offset = explorer_state.scroll_offset;
+    file_list_set_sort((file_sort_t)explorer_state.sort_mode);
+    file_explorer_refresh();
+    return 0;
+}
+
+// Still sorting or making thumbnails in the background
+static bool suspend_busy(void) {
+    thumbnail_cache_stats_t thumbs;
+    thumbnail_cache_get_stats(&thumbs);
+    return file_list_busy() || thumbs.queued > 0;
+}
+
+const app_suspend_ops_t file_explorer_suspend_ops = {
+    suspend_resident_bytes, suspend_save, suspend_drop, suspend_restore, suspend_busy
+};
+
+// Scroll the list just far enough to keep the selection on screen
+static void scroll_to_selection(void) {
+    if (explorer_state.selected_file < explorer_state.scroll_offset) {
+        explorer_state.scroll_offset = explorer_state.selected_file;
+    } else if (explorer_state.selected_file >= explorer_state.scroll_offset + LIST_VISIBLE_ROWS) {
+        explorer_state.scroll_offset = explorer_state.selected_file - LIST_VISIBLE_ROWS + 1;
+    }
 }
 
 void file_explorer_handle_input(int key, int x, int y) {
+    sync_file_count();
     switch (key) {
         case 1: // Up arrow
             if (explorer_state.selected_file > 0) {
                 explorer_state.selected_file--;
-                animate_bounce_icon(60, 120 + explorer_state.selected_file * 50, 30, 30);
+                scroll_to_selection();
+                animate_bounce_icon(60, LIST_TOP + (explorer_state.selected_file - explorer_state.scroll_offset) * LIST_ROW_HEIGHT, 30, 30);
             }
             break;
             
         case 2: // Down arrow
             if (explorer_state.selected_file < explorer_state.file_count - 1) {
                 explorer_state.selected_file++;
-                animate_bounce_icon(60, 120 + explorer_state.selected_file * 50, 30, 30);
+                scroll_to_selection();
+                animate_bounce_icon(60, LIST_TOP + (explorer_state.selected_file - explorer_state.scroll_offset) * LIST_ROW_HEIGHT, 30, 30);
             }
             break;
             
@@ -245,22 +503,46 @@ void file_explorer_handle_input(int key, int x, int y) {
             animate_fade_transition(0, 60, SCREEN_WIDTH, SCREEN_HEIGHT - 100, 0x111111, 0x111111);
             break;
             
+        case 6: // Page down
+        case 7: // Page up
+        case 8: // Home
+        case 9: { // End
+            // Jumps cost the same in any size of directory: only the rows
+            // that land on screen get read
+            int target = key == 6 ? explorer_state.selected_file + LIST_VISIBLE_ROWS :
+                         key == 7 ? explorer_state.selected_file - LIST_VISIBLE_ROWS :
+                         key == 8 ? 0 : explorer_state.file_count - 1;
+            if (target > explorer_state.file_count - 1) target = explorer_state.file_count - 1;
+            if (target < 0) target = 0;
+            explorer_state.selected_file = target;
+            scroll_to_selection();
+            break;
+        }
+            
+        case 10: // Cycle sort order: name, size, date
+            explorer_state.sort_mode = (explorer_state.sort_mode + 1) % 3;
+            file_list_set_sort((file_sort_t)explorer_state.sort_mode);
+            file_list_pump(LIST_OPEN_BUDGET_US);
+            break;
+            
         case 5: // Right click (context menu)
             context_menu_open = 1;
             context_menu_x = x;
             context_menu_y = y;
+            animate_window_open(x, y, 120, 5 * 30);
             break;
     }
 }
 
 void file_explorer_open_file(int index) {
-    if (index < 0 || index >= explorer_state.file_count) return;
-    
-    file_entry_t* file = &explorer_state.files[index];
+    file_entry_t file;
+    if (!file_list_get(index, &file)) return;
     
-    if (file->type == FILE_TYPE_FOLDER) {
+    if (file.type == FILE_TYPE_FOLDER) {
         // Navigate to folder
-        file_explorer_navigate_to(file->path);
+        const char* path = entry_path(file.name);
+        if (!path) return;
+        file_explorer_navigate_to(path);
         animate_slide_transition(0, 0, -SCREEN_WIDTH, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
     } else {
         // Open file with appropriate application
@@ -270,7 +552,8 @@ void file_explorer_open_file(int index) {
 }
 
 void file_explorer_navigate_to(const char* path) {
-    strcpy(explorer_state.current_path, path);
+    // path may be entry_path()'s buffer
+    snprintf(explorer_state.current_path, sizeof(explorer_state.current_path), "%s", path);
     explorer_state.selected_file = 0;
     explorer_state.scroll_offset = 0;
     file_explorer_refresh();
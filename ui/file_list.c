@@ -0,0 +1,490 @@
+// file_list.c - virtualized directory listing, materialized a page at a time
+//
+// Sorting runs in the background, from file_list_pump(): entries are read
+// once in source order and boiled down to an 8-byte record each (the top 32
+// bits of the entry's key plus its source index), then merge sorted in
+// bounded steps. The rest of the key, which only key ties look at, is kept
+// once per entry beside the records rather than moved around with them. Records are
+// sorted into runs with insertion sort and merged pass by pass between two
+// arrays, so every step walks memory in order. Only the records are kept:
+// rows are still read a page at a time, through the sorted order.
+//
+// Directories the source can identify are copied into the directory cache as
+// they are enumerated, and reopening one at the same generation reads it from
+// there instead of the source.
+#include "file_list.h"
+#include "../kernel/timer.h"
+#include "../kernel/dircache.h"
+#include <string.h>
+
+// Name bytes packed into a record's key, below the folder bit
+#define SORT_KEY_CHARS  3
+#define SORT_FILE_BIT   ((uint32_t)1 << 31)     // Set for files: folders sort first
+#define SORT_VALUE_MAX  (((uint64_t)1 << 63) - 1)   // Size and date keys: 31 + 32 bits
+#define SORT_RUN        32      // Records per insertion-sorted run
+#define SORT_MERGE_STEP 4096    // Records merged between budget checks
+
+// A run of FILE_LIST_PAGE_SIZE rows; names are packed into its own arena
+typedef struct {
+    uint64_t size;
+    uint64_t modified_time;
+    uint16_t name;              // Offset in the page arena
+    uint8_t type;
+} file_row_t;
+
+typedef struct {
+    int first;                  // Index of rows[0]; -1 when the slot is free
+    int count;
+    uint32_t last_used;
+    int arena_used;
+    file_row_t rows[FILE_LIST_PAGE_SIZE];
+    char arena[FILE_LIST_ARENA_BYTES];
+} file_page_t;
+
+// Ties on key are broken by sort_rest[index], then source order
+typedef struct {
+    uint32_t key;
+    uint32_t index;             // Source index
+} sort_rec_t;
+
+typedef enum {
+    JOB_IDLE,
+    JOB_ENUMERATE,              // Reading entries into records
+    JOB_RUNS,                   // Insertion-sorting runs of SORT_RUN
+    JOB_MERGE                   // Merging runs, one pass per width
+} job_phase_t;
+
+static const dir_source_t *source = NULL;
+static void *dir = NULL;
+static int entry_count = 0;
+static bool count_known = false;
+static bool identified = false;
+static uint32_t dir_inode = 0;
+static uint32_t dir_generation = 0;
+static int cached = -1;                 // Directory cache listing rows come from
+static int filling = -1;                // Listing being filled by the enumeration
+static file_page_t pages[FILE_LIST_PAGES];
+static uint32_t use_clock = 0;
+static file_list_stats_t stats;
+
+static file_sort_t sort_mode = FILE_SORT_NAME;
+static sort_rec_t sort_recs[2][FILE_LIST_MAX_SORTED];
+// By source index: the folded name past the key's characters (an offset in
+// sort_arena; 0 is the empty string), or the low 32 bits of a size or date
+static uint32_t sort_rest[FILE_LIST_MAX_SORTED];
+static char sort_arena[FILE_LIST_SORT_ARENA];
+static uint32_t sort_arena_used = 0;
+static const sort_rec_t *order = NULL;         // Sorted rows; NULL lists in source order
+
+static struct {
+    job_phase_t phase;
+    int next;                   // Next source index, or next run to sort
+    int keyed;                  // Entries with a record
+    bool sortable;              // False once the directory outgrew the records
+    file_sort_t mode;           // The order the records were keyed for
+    int src;                    // Merging sort_recs[src] into the other array
+    int width;
+    int mid, hi;                // Current pair: [k's start, mid) and [mid, hi)
+    int i, j, k;                // Merge cursors: left, right, output
+} job;
+
+void file_list_set_source(const dir_source_t *src) {
+    file_list_close();
+    source = src;
+}
+
+static void drop_pages(void) {
+    for (int i = 0; i < FILE_LIST_PAGES; i++) {
+        pages[i].first = -1;
+    }
+}
+
+static void stop_filling(void) {
+    if (filling >= 0) dircache_release(filling);
+    filling = -1;
+}
+
+static void start_job(void) {
+    // A restarted enumeration would append everything again
+    stop_filling();
+    order = NULL;
+    drop_pages();
+    job.next = 0;
+    job.keyed = 0;
+    job.mode = sort_mode;
+    sort_arena[0] = '\0';
+    sort_arena_used = 1;
+
+    // Too big to sort: nothing left to learn by reading it ahead
+    job.sortable = !count_known || entry_count <= FILE_LIST_MAX_SORTED;
+    job.phase = job.sortable ? JOB_ENUMERATE : JOB_IDLE;
+
+    // Copy it into the directory cache on the way, if it could fit
+    if (identified && cached < 0 && job.phase == JOB_ENUMERATE &&
+        (!count_known || entry_count <= DIRCACHE_MAX_ENTRIES)) {
+        filling = dircache_begin(dir_inode, dir_generation);
+    }
+}
+
+void file_list_close(void) {
+    if (job.phase != JOB_IDLE) stats.cancelled++;
+    job.phase = JOB_IDLE;
+    order = NULL;
+    stop_filling();
+    if (cached >= 0) dircache_release(cached);
+    cached = -1;
+    identified = false;
+
+    if (dir && source && source->close) {
+        source->close(dir);
+    }
+    dir = NULL;
+    entry_count = 0;
+    drop_pages();
+}
+
+int file_list_open(const char *path) {
+    file_list_close();
+    if (!source || source->open(path, &dir) != 0) {
+        dir = NULL;
+        return -1;
+    }
+    identified = source->identify && source->identify(dir, &dir_inode, &dir_generation) == 0;
+    if (identified) cached = dircache_find(dir_inode, dir_generation);
+
+    if (cached >= 0) {
+        entry_count = dircache_count(cached);
+        stats.cached_opens++;
+    } else {
+        entry_count = source->count ? source->count(dir) : -1;
+    }
+    count_known = entry_count >= 0;
+    if (!count_known) entry_count = 0;
+
+    start_job();
+    return entry_count;
+}
+
+bool file_list_identity(uint32_t *inode) {
+    if (!identified) return false;
+    *inode = dir_inode;
+    return true;
+}
+
+// Entry index of the open directory, from the cache when it has it
+static int read_entry(int index, file_entry_t *out) {
+    if (cached < 0) return source->read(dir, index, out);
+
+    dircache_entry_t entry;
+    if (!dircache_get(cached, index, &entry)) return -1;
+    out->name = entry.name;
+    out->type = (file_type_t)entry.type;
+    out->size = entry.size;
+    out->modified_time = entry.modified_time;
+    return 0;
+}
+
+// Copy an enumerated entry into the listing being filled
+static void fill_cache(const file_entry_t *entry) {
+    dircache_entry_t cached_entry = { entry->name, (uint8_t)entry->type, entry->size, entry->modified_time };
+    if (!dircache_append(filling, &cached_entry)) stop_filling();
+}
+
+// Enumeration reached the end: later reads come from the finished listing
+static void finish_filling(void) {
+    if (filling < 0) return;
+    if (dircache_commit(filling)) {
+        cached = filling;
+        filling = -1;
+    } else {
+        stop_filling();
+    }
+}
+
+void file_list_set_sort(file_sort_t mode) {
+    sort_mode = mode;
+    if (dir) start_job();
+}
+
+int file_list_count(void) {
+    return entry_count;
+}
+
+bool file_list_enumerating(void) {
+    return job.phase == JOB_ENUMERATE;
+}
+
+bool file_list_busy(void) {
+    return job.phase != JOB_IDLE;
+}
+
+bool file_list_unsorted(void) {
+    return dir && !job.sortable;
+}
+
+static char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+}
+
+// Folded copy of a name's tail; 0 (the empty string) if the arena is full
+static uint32_t intern_tail(const char *tail) {
+    uint32_t len = (uint32_t)strlen(tail);
+    if (sort_arena_used + len + 1 > FILE_LIST_SORT_ARENA) {
+        stats.truncated++;
+        return 0;
+    }
+
+    uint32_t offset = sort_arena_used;
+    for (uint32_t i = 0; i < len; i++) {
+        sort_arena[offset + i] = fold(tail[i]);
+    }
+    sort_arena[offset + len] = '\0';
+    sort_arena_used += len + 1;
+    return offset;
+}
+
+static void add_record(int index, const file_entry_t *entry) {
+    sort_rec_t *rec = &sort_recs[0][job.keyed++];
+    uint32_t key = 0, rest = 0;
+    uint64_t value = 0;
+
+    switch (job.mode) {
+        case FILE_SORT_NAME: {
+            const char *name = entry->name ? entry->name : "";
+            int i = 0;
+            for (; i < SORT_KEY_CHARS && name[i]; i++) {
+                key |= (uint32_t)(unsigned char)fold(name[i]) << (8 * (SORT_KEY_CHARS - 1 - i));
+            }
+            if (name[i]) rest = intern_tail(&name[i]);
+            break;
+        }
+        case FILE_SORT_SIZE:
+            value = entry->size < SORT_VALUE_MAX ? entry->size : SORT_VALUE_MAX;
+            break;
+        case FILE_SORT_DATE:
+            value = ~entry->modified_time & SORT_VALUE_MAX;
+            break;
+    }
+    if (job.mode != FILE_SORT_NAME) {
+        key = (uint32_t)(value >> 32);
+        rest = (uint32_t)value;
+    }
+    if (entry->type != FILE_TYPE_FOLDER) key |= SORT_FILE_BIT;
+
+    rec->key = key;
+    rec->index = (uint32_t)index;
+    sort_rest[index] = rest;
+}
+
+static bool rec_before(const sort_rec_t *a, const sort_rec_t *b) {
+    if (a->key != b->key) return a->key < b->key;
+
+    uint32_t rest_a = sort_rest[a->index], rest_b = sort_rest[b->index];
+    if (rest_a != rest_b) {
+        if (job.mode != FILE_SORT_NAME) return rest_a < rest_b;
+        int c = strcmp(&sort_arena[rest_a], &sort_arena[rest_b]);
+        if (c != 0) return c < 0;
+    }
+    return a->index < b->index;
+}
+
+// Rows switch to the sorted order in one go
+static void publish(const sort_rec_t *recs) {
+    order = job.sortable ? recs : NULL;
+    if (order) stats.sorts++;
+    drop_pages();
+    job.phase = JOB_IDLE;
+}
+
+static void start_pair(int lo) {
+    job.i = job.k = lo;
+    job.mid = job.j = lo + job.width < job.keyed ? lo + job.width : job.keyed;
+    job.hi = lo + 2 * job.width < job.keyed ? lo + 2 * job.width : job.keyed;
+}
+
+static void enumerate_step(void) {
+    for (int n = 0; n < FILE_LIST_PAGE_SIZE; n++) {
+        file_entry_t entry;
+        if ((count_known && job.next >= entry_count) || read_entry(job.next, &entry) != 0) {
+            entry_count = job.next;
+            finish_filling();
+            job.phase = JOB_RUNS;
+            job.next = 0;
+            return;
+        }
+
+        if (filling >= 0) fill_cache(&entry);
+        if (job.next < FILE_LIST_MAX_SORTED) {
+            add_record(job.next, &entry);
+        } else {
+            job.sortable = false;
+        }
+        job.next++;
+        if (job.next > entry_count) entry_count = job.next;
+    }
+}
+
+static void runs_step(void) {
+    if (!job.sortable) {
+        publish(NULL);
+        return;
+    }
+
+    sort_rec_t *recs = sort_recs[0];
+    int end = job.next + SORT_RUN < job.keyed ? job.next + SORT_RUN : job.keyed;
+    for (int i = job.next + 1; i < end; i++) {
+        sort_rec_t rec = recs[i];
+        int j = i;
+        while (j > job.next && rec_before(&rec, &recs[j - 1])) {
+            recs[j] = recs[j - 1];
+            j--;
+        }
+        recs[j] = rec;
+    }
+    job.next = end;
+
+    if (job.next >= job.keyed) {
+        job.src = 0;
+        job.width = SORT_RUN;
+        if (job.width >= job.keyed) {
+            publish(sort_recs[0]);
+        } else {
+            job.phase = JOB_MERGE;
+            start_pair(0);
+        }
+    }
+}
+
+static void merge_step(void) {
+    const sort_rec_t *in = sort_recs[job.src];
+    sort_rec_t *out = sort_recs[!job.src];
+
+    // Taking from the left on ties keeps the merge stable
+    for (int n = 0; n < SORT_MERGE_STEP && job.k < job.hi; n++) {
+        if (job.j >= job.hi || (job.i < job.mid && !rec_before(&in[job.j], &in[job.i]))) {
+            out[job.k++] = in[job.i++];
+        } else {
+            out[job.k++] = in[job.j++];
+        }
+    }
+    if (job.k < job.hi) return;
+
+    if (job.hi < job.keyed) {
+        start_pair(job.hi);
+        return;
+    }
+
+    // End of a pass: the output becomes the next pass's input
+    job.src = !job.src;
+    job.width *= 2;
+    if (job.width >= job.keyed) {
+        publish(sort_recs[job.src]);
+    } else {
+        start_pair(0);
+    }
+}
+
+bool file_list_pump(uint32_t budget_us) {
+    if (budget_us == 0 || !dir) return file_list_busy();
+
+    uint32_t start = timer_now_us();
+    while (job.phase != JOB_IDLE && timer_diff(timer_now_us(), start) < (int32_t)budget_us) {
+        switch (job.phase) {
+            case JOB_ENUMERATE: enumerate_step(); break;
+            case JOB_RUNS:      runs_step(); break;
+            case JOB_MERGE:     merge_step(); break;
+            case JOB_IDLE:      break;
+        }
+    }
+    return file_list_busy();
+}
+
+// Copy a name into the page arena, cutting it short if the arena is full
+static uint16_t intern_name(file_page_t *page, const char *name) {
+    int room = FILE_LIST_ARENA_BYTES - page->arena_used - 1;
+    int len = name ? (int)strlen(name) : 0;
+    if (len > room) {
+        len = room > 0 ? room : 0;
+        stats.truncated++;
+    }
+    if (room < 0) {
+        // Not even a terminator left; share the last one
+        return (uint16_t)(FILE_LIST_ARENA_BYTES - 1);
+    }
+
+    uint16_t offset = (uint16_t)page->arena_used;
+    memcpy(&page->arena[offset], name, len);
+    page->arena[offset + len] = '\0';
+    page->arena_used += len + 1;
+    return offset;
+}
+
+// The least recently used slot, or a free one
+static file_page_t *free_page(void) {
+    file_page_t *page = &pages[0];
+    for (int i = 0; i < FILE_LIST_PAGES; i++) {
+        if (pages[i].first < 0) {
+            page = &pages[i];
+            break;
+        }
+        if (pages[i].last_used < page->last_used) page = &pages[i];
+    }
+    if (page->first >= 0) stats.evictions++;
+    return page;
+}
+
+// Read the rows starting at first into page, through the sorted order if any
+static void fill_page(file_page_t *page, int first) {
+    page->first = first;
+    page->count = 0;
+    page->arena_used = 0;
+    int end = first + FILE_LIST_PAGE_SIZE < entry_count ? first + FILE_LIST_PAGE_SIZE : entry_count;
+    for (int i = first; i < end; i++) {
+        file_entry_t entry;
+        int index = order ? (int)order[i].index : i;
+        if (read_entry(index, &entry) != 0) break;
+
+        file_row_t *row = &page->rows[page->count++];
+        row->name = intern_name(page, entry.name);
+        row->type = (uint8_t)entry.type;
+        row->size = entry.size;
+        row->modified_time = entry.modified_time;
+    }
+    stats.fetches++;
+    stats.rows_read += (uint32_t)page->count;
+}
+
+bool file_list_get(int index, file_entry_t *out) {
+    if (!dir || index < 0 || index >= entry_count) return false;
+
+    int first = index - index % FILE_LIST_PAGE_SIZE;
+    file_page_t *page = NULL;
+    for (int i = 0; i < FILE_LIST_PAGES; i++) {
+        if (pages[i].first == first) {
+            page = &pages[i];
+            stats.hits++;
+            break;
+        }
+    }
+    int slot = index - first;
+    if (!page) {
+        page = free_page();
+        fill_page(page, first);
+    } else if (slot >= page->count && page->count < FILE_LIST_PAGE_SIZE) {
+        fill_page(page, first);                 // Rows enumerated since it was read
+    }
+    page->last_used = ++use_clock;
+
+    if (slot >= page->count) return false;     // The source came up short
+
+    const file_row_t *row = &page->rows[slot];
+    out->name = &page->arena[row->name];
+    out->type = (file_type_t)row->type;
+    out->size = row->size;
+    out->modified_time = row->modified_time;
+    return true;
+}
+
+void file_list_get_stats(file_list_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,102 @@
+#ifndef FILE_LIST_H
+#define FILE_LIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Rows are fetched from the source a page at a time; only FILE_LIST_PAGES
+// pages are kept, least recently used first out
+#define FILE_LIST_PAGE_SIZE     64
+#define FILE_LIST_PAGES         8
+#define FILE_LIST_ARENA_BYTES   4096    // Name bytes per page; longer names get cut short
+
+// Sorting keeps an 8-byte record per entry, twice over for the merge, plus a
+// 4-byte tie-breaker and the folded name tail: about 3.1MB of BSS, whatever
+// the directory's size. Bigger directories are listed in the order the source
+// returns them, and file_list_unsorted() says so.
+#define FILE_LIST_MAX_SORTED    (100 * 1024)
+#define FILE_LIST_SORT_ARENA    (12 * FILE_LIST_MAX_SORTED)     // Name tails; longer ones sort by key alone
+
+typedef enum {
+    FILE_TYPE_FOLDER = 0,
+    FILE_TYPE_TEXT = 1,
+    FILE_TYPE_IMAGE = 2,
+    FILE_TYPE_VIDEO = 3,
+    FILE_TYPE_AUDIO = 4,
+    FILE_TYPE_EXECUTABLE = 5,
+    FILE_TYPE_UNKNOWN = 6
+} file_type_t;
+
+// One directory entry. name points into the list's page cache and stays
+// valid until the next file_list_get() or file_list_open().
+typedef struct {
+    const char *name;
+    file_type_t type;
+    uint64_t size;
+    uint64_t modified_time;
+} file_entry_t;
+
+typedef enum {
+    FILE_SORT_NAME = 0,         // Folders first, then case-insensitive name
+    FILE_SORT_SIZE = 1,         // Folders first, then smallest first
+    FILE_SORT_DATE = 2          // Folders first, then newest first
+} file_sort_t;
+
+// Where directory entries come from. read() fills out for entry index of an
+// open directory; out->name only needs to last until the next call. count
+// may be NULL or return -1 when the size isn't known up front: entries are
+// then read until read() fails. identify() is optional too: directories it
+// names by inode and generation are kept in the directory cache, and served
+// from there until they change.
+typedef struct {
+    int (*open)(const char *path, void **dir);      // 0 on success
+    int (*count)(void *dir);
+    int (*read)(void *dir, int index, file_entry_t *out);   // 0 on success
+    void (*close)(void *dir);
+    int (*identify)(void *dir, uint32_t *inode, uint32_t *generation);     // 0 on success
+} dir_source_t;
+
+typedef struct {
+    uint32_t hits;          // Rows served from a cached page
+    uint32_t fetches;       // Pages read from the source
+    uint32_t evictions;
+    uint32_t rows_read;
+    uint32_t truncated;     // Names cut short by a full page or sort arena
+    uint32_t sorts;         // Sorted orders published
+    uint32_t cancelled;     // Enumerations dropped by opening another directory
+    uint32_t cached_opens;  // Directories served from the directory cache
+} file_list_stats_t;
+
+void file_list_set_source(const dir_source_t *source);
+
+// Open a directory and return its entry count so far (-1 on error). Opening
+// reads no entries: enumerating and sorting them is left to file_list_pump(),
+// and rows are listed in source order until the sorted order is ready.
+// Opening another directory cancels whatever work was left.
+int file_list_open(const char *path);
+void file_list_close(void);
+
+// Sort order for the open directory and the ones after it; restarts the sort
+void file_list_set_sort(file_sort_t mode);
+
+// Enumerate and sort for about budget_us. Returns true while work remains.
+bool file_list_pump(uint32_t budget_us);
+
+// True while entries are still being read (count may grow) or sorted
+bool file_list_enumerating(void);
+bool file_list_busy(void);
+
+// True when the open directory is too big to sort and stays in source order
+bool file_list_unsorted(void);
+
+int file_list_count(void);
+
+// Inode of the open directory, for watching it; false if the source has none
+bool file_list_identity(uint32_t *inode);
+
+// Row index of the open directory; reads its page from the source on a miss
+bool file_list_get(int index, file_entry_t *out);
+
+void file_list_get_stats(file_list_stats_t *stats);
+
+#endif // FILE_LIST_H
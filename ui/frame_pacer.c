@@ -0,0 +1,160 @@
+// frame_pacer.c - Vsync-paced frame loop with frame time statistics
+#include "frame_pacer.h"
+#include "latency.h"
+#include "../drivers/display4k.h"
+#include "../kernel/timer.h"
+#include "../kernel/io.h"
+#include <stdio.h>
+#include <string.h>
+
+// VGA input status register 1; bit 3 is set during vertical retrace
+#define VGA_STATUS_PORT   0x3DA
+#define VGA_RETRACE_BIT   0x08
+#define RETRACE_PROBE_US  50000
+
+#define HUD_WIDTH   360
+#define HUD_HEIGHT  48
+#define HUD_BG      0x000000
+#define HUD_TEXT    0x00FF00
+#define HUD_WARN    0xFFAA00
+
+static uint32_t frame_times[FRAME_STATS_WINDOW];
+static uint32_t frame_index = 0;
+static uint32_t frame_total = 0;
+static uint32_t frames_dropped = 0;
+
+static uint32_t period_us = 16667;
+static uint32_t next_present_us = 0;
+static uint32_t frame_start_us = 0;
+static bool pacing_enabled = true;
+static bool hardware_vsync = false;
+static bool hud_visible = false;
+
+// Check whether the retrace bit toggles at all (absent on non-VGA displays)
+static bool probe_vga_retrace(void) {
+    uint8_t first = inb(VGA_STATUS_PORT) & VGA_RETRACE_BIT;
+    uint32_t start = timer_now_us();
+
+    while ((uint32_t)(timer_now_us() - start) < RETRACE_PROBE_US) {
+        if ((inb(VGA_STATUS_PORT) & VGA_RETRACE_BIT) != first) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Wait for the leading edge of the next vertical retrace
+static void wait_vga_retrace(void) {
+    while (inb(VGA_STATUS_PORT) & VGA_RETRACE_BIT) {
+        cpu_relax();
+    }
+    while (!(inb(VGA_STATUS_PORT) & VGA_RETRACE_BIT)) {
+        cpu_relax();
+    }
+}
+
+void frame_pacer_init(int refresh_rate, bool vsync) {
+    if (refresh_rate <= 0) refresh_rate = 60;
+
+    period_us = 1000000 / (uint32_t)refresh_rate;
+    pacing_enabled = vsync;
+    hardware_vsync = vsync && probe_vga_retrace();
+
+    memset(frame_times, 0, sizeof(frame_times));
+    frame_index = 0;
+    frame_total = 0;
+    frames_dropped = 0;
+    next_present_us = timer_now_us() + period_us;
+}
+
+void frame_pacer_begin_frame(void) {
+    frame_start_us = timer_now_us();
+}
+
+void frame_pacer_end_frame(void) {
+    uint32_t now = timer_now_us();
+
+    frame_times[frame_index] = now - frame_start_us;
+    frame_index = (frame_index + 1) % FRAME_STATS_WINDOW;
+    frame_total++;
+
+    if (!pacing_enabled) {
+        next_present_us = now;
+        latency_frame_presented(now);
+        return;
+    }
+
+    int32_t late = timer_diff(now, next_present_us);
+    if (late > 0) {
+        // Behind: skip the missed intervals and present at the next one
+        // instead of queueing stale frames.
+        uint32_t missed = (uint32_t)late / period_us + 1;
+        frames_dropped += missed - 1;
+        next_present_us += missed * period_us;
+    }
+
+    if (hardware_vsync) {
+        wait_vga_retrace();
+    } else {
+        while (timer_diff(timer_now_us(), next_present_us) < 0) {
+            cpu_relax();
+        }
+    }
+
+    // The frame is on screen now; close out the inputs it handled
+    latency_frame_presented(timer_now_us());
+    next_present_us += period_us;
+}
+
+uint32_t frame_pacer_next_present_us(void) {
+    return next_present_us;
+}
+
+void frame_pacer_get_stats(frame_stats_t *stats) {
+    if (!stats) return;
+
+    uint32_t count = frame_total < FRAME_STATS_WINDOW ? frame_total : FRAME_STATS_WINDOW;
+    uint32_t sorted[FRAME_STATS_WINDOW];
+
+    // Insertion sort: the window is small and this only runs for the HUD
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t v = frame_times[i];
+        uint32_t j = i;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+    }
+
+    stats->frames = frame_total;
+    stats->dropped = frames_dropped;
+    stats->period_us = period_us;
+    stats->hardware_vsync = hardware_vsync;
+    stats->p50_us = count ? sorted[count / 2] : 0;
+    stats->p99_us = count ? sorted[(count * 99) / 100] : 0;
+    stats->max_us = count ? sorted[count - 1] : 0;
+}
+
+void frame_pacer_set_hud(bool visible) {
+    hud_visible = visible;
+}
+
+void draw_frame_stats_hud(int x, int y) {
+    if (!hud_visible) return;
+
+    frame_stats_t stats;
+    frame_pacer_get_stats(&stats);
+
+    char line[64];
+    draw_filled_rect(x, y, HUD_WIDTH, HUD_HEIGHT, HUD_BG);
+
+    snprintf(line, sizeof(line), "cpu p50 %u.%02ums  p99 %u.%02ums",
+             stats.p50_us / 1000, (stats.p50_us % 1000) / 10,
+             stats.p99_us / 1000, (stats.p99_us % 1000) / 10);
+    draw_string(x + 8, y + 8, line, stats.p99_us > stats.period_us ? HUD_WARN : HUD_TEXT);
+
+    snprintf(line, sizeof(line), "frames %u  dropped %u  %s",
+             stats.frames, stats.dropped, stats.hardware_vsync ? "vga" : "timer");
+    draw_string(x + 8, y + 26, line, HUD_TEXT);
+}
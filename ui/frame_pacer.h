@@ -0,0 +1,39 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Number of recent frames kept for percentile statistics
+#define FRAME_STATS_WINDOW 128
+
+typedef struct {
+    uint32_t frames;          // Frames presented since init
+    uint32_t dropped;         // Refresh intervals missed while behind
+    uint32_t p50_us;          // Median CPU time per frame
+    uint32_t p99_us;          // 99th percentile CPU time per frame
+    uint32_t max_us;          // Worst frame in the window
+    uint32_t period_us;       // Target refresh period
+    bool hardware_vsync;      // Waiting on VGA retrace rather than the timer
+} frame_stats_t;
+
+// Configure pacing; vsync probes the VGA retrace bit and falls back to the timer
+void frame_pacer_init(int refresh_rate, bool vsync);
+
+// Mark the start of CPU work for a frame
+void frame_pacer_begin_frame(void);
+
+// Record CPU time and wait for the next retrace; late frames are coalesced
+void frame_pacer_end_frame(void);
+
+// Expected present time (timer_now_us) of the frame being built
+uint32_t frame_pacer_next_present_us(void);
+
+// Statistics over the last FRAME_STATS_WINDOW frames
+void frame_pacer_get_stats(frame_stats_t *stats);
+
+// On-screen frame time overlay
+void frame_pacer_set_hud(bool visible);
+void draw_frame_stats_hud(int x, int y);
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,262 @@
+// gesture.c - tap, long-press, pan, fling and pinch from timestamped touches
+#include "gesture.h"
+#include "../kernel/timer.h"
+#include <string.h>
+
+// Q16 one, for pinch scales
+#define SCALE_ONE (1 << 16)
+
+static int iabs(int v) {
+    return v < 0 ? -v : v;
+}
+
+static uint32_t isqrt(uint32_t n) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > n) bit >>= 2;
+    while (bit) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+void gesture_init(gesture_recognizer_t *rec) {
+    memset(rec, 0, sizeof(*rec));
+    rec->pinch_scale = SCALE_ONE;
+}
+
+static gesture_event_t *emit(gesture_event_t *ev, gesture_t type, int x, int y, uint32_t time_us) {
+    memset(ev, 0, sizeof(*ev));
+    ev->type = type;
+    ev->x = x;
+    ev->y = y;
+    ev->time_us = time_us;
+    return ev;
+}
+
+static void history_reset(gesture_recognizer_t *rec) {
+    rec->hist_count = 0;
+    rec->hist_next = 0;
+}
+
+static void history_add(gesture_recognizer_t *rec, int x, int y, uint32_t time_us) {
+    rec->hist_x[rec->hist_next] = (int16_t)x;
+    rec->hist_y[rec->hist_next] = (int16_t)y;
+    rec->hist_us[rec->hist_next] = time_us;
+    rec->hist_next = (rec->hist_next + 1) % GESTURE_HISTORY;
+    if (rec->hist_count < GESTURE_HISTORY) rec->hist_count++;
+}
+
+// Velocity between the newest sample and the oldest one still inside the
+// window; a finger that stopped before lifting has none
+static void history_velocity(const gesture_recognizer_t *rec, int *vx, int *vy) {
+    *vx = *vy = 0;
+    if (rec->hist_count < 2) return;
+
+    int newest = (rec->hist_next + GESTURE_HISTORY - 1) % GESTURE_HISTORY;
+    int oldest = newest;
+    for (int k = 1; k < rec->hist_count; k++) {
+        int i = (newest + GESTURE_HISTORY - k) % GESTURE_HISTORY;
+        if (timer_diff(rec->hist_us[newest], rec->hist_us[i]) > GESTURE_VELOCITY_WINDOW_US) break;
+        oldest = i;
+    }
+
+    // Tenths of a millisecond keep dx * 10000 within 32 bits
+    int32_t dt = timer_diff(rec->hist_us[newest], rec->hist_us[oldest]) / 100;
+    if (dt <= 0) return;
+    *vx = (rec->hist_x[newest] - rec->hist_x[oldest]) * 10000 / dt;
+    *vy = (rec->hist_y[newest] - rec->hist_y[oldest]) * 10000 / dt;
+}
+
+static uint32_t finger_distance(const gesture_recognizer_t *rec) {
+    int dx = rec->second_x - rec->x;
+    int dy = rec->second_y - rec->y;
+    return isqrt((uint32_t)(dx * dx + dy * dy));
+}
+
+static gesture_event_t *emit_pinch(gesture_recognizer_t *rec, gesture_event_t *out, gesture_t type, uint32_t time_us) {
+    gesture_event_t *ev = emit(out, type, (rec->x + rec->second_x) / 2, (rec->y + rec->second_y) / 2, time_us);
+    ev->scale = rec->pinch_scale;
+    return ev;
+}
+
+// A second finger turns whatever the first was doing into a pinch
+static int begin_pinch(gesture_recognizer_t *rec, const touch_sample_t *touch) {
+    rec->second_id = touch->id;
+    rec->second_x = touch->x;
+    rec->second_y = touch->y;
+    rec->contacts = 2;
+    rec->pinching = true;
+    rec->consumed = true;
+    rec->pinch_start_dist = finger_distance(rec);
+    if (rec->pinch_start_dist == 0) rec->pinch_start_dist = 1;
+    rec->pinch_scale = SCALE_ONE;
+    return 0;
+}
+
+static int end_pinch(gesture_recognizer_t *rec, gesture_event_t *out, uint32_t time_us) {
+    rec->pinching = false;
+    if (rec->pinch_scale >= SCALE_ONE + GESTURE_PINCH_THRESHOLD) {
+        emit_pinch(rec, out, GESTURE_PINCH_OUT, time_us);
+        return 1;
+    }
+    if (rec->pinch_scale + GESTURE_PINCH_THRESHOLD <= SCALE_ONE) {
+        emit_pinch(rec, out, GESTURE_PINCH_IN, time_us);
+        return 1;
+    }
+    return 0;
+}
+
+static int primary_down(gesture_recognizer_t *rec, const touch_sample_t *touch) {
+    rec->contacts = 1;
+    rec->primary_id = touch->id;
+    rec->x = rec->start_x = touch->x;
+    rec->y = rec->start_y = touch->y;
+    rec->down_us = touch->time_us;
+    rec->panning = false;
+    rec->long_pressed = false;
+    rec->pinching = false;
+    rec->consumed = false;
+    history_reset(rec);
+    history_add(rec, touch->x, touch->y, touch->time_us);
+    return 0;
+}
+
+static int primary_move(gesture_recognizer_t *rec, const touch_sample_t *touch, gesture_event_t *out) {
+    rec->x = touch->x;
+    rec->y = touch->y;
+    history_add(rec, touch->x, touch->y, touch->time_us);
+    if (rec->consumed) return 0;
+
+    int dx = touch->x - rec->start_x;
+    int dy = touch->y - rec->start_y;
+    if (!rec->panning && iabs(dx) <= GESTURE_SLOP_PX && iabs(dy) <= GESTURE_SLOP_PX) {
+        return 0;
+    }
+
+    rec->panning = true;
+    gesture_event_t *ev = emit(out, GESTURE_PAN, touch->x, touch->y, touch->time_us);
+    ev->dx = dx;
+    ev->dy = dy;
+    return 1;
+}
+
+static int primary_up(gesture_recognizer_t *rec, const touch_sample_t *touch, gesture_event_t *out) {
+    rec->x = touch->x;
+    rec->y = touch->y;
+    history_add(rec, touch->x, touch->y, touch->time_us);
+    if (rec->consumed) return 0;
+
+    int dx = touch->x - rec->start_x;
+    int dy = touch->y - rec->start_y;
+
+    if (!rec->panning) {
+        if (rec->long_pressed) return 0;
+        // Held long enough but nobody polled in between
+        if (timer_diff(touch->time_us, rec->down_us) >= GESTURE_LONG_PRESS_US) {
+            emit(out, GESTURE_LONG_PRESS, rec->start_x, rec->start_y, touch->time_us);
+        } else {
+            emit(out, GESTURE_TAP, rec->start_x, rec->start_y, touch->time_us);
+        }
+        return 1;
+    }
+
+    int vx, vy;
+    history_velocity(rec, &vx, &vy);
+    gesture_event_t *ev;
+    if (!rec->long_pressed && (iabs(vx) >= GESTURE_FLING_MIN_PX_S || iabs(vy) >= GESTURE_FLING_MIN_PX_S)) {
+        gesture_t type;
+        if (iabs(vx) >= iabs(vy)) {
+            type = vx < 0 ? GESTURE_SWIPE_LEFT : GESTURE_SWIPE_RIGHT;
+        } else {
+            type = vy < 0 ? GESTURE_SWIPE_UP : GESTURE_SWIPE_DOWN;
+        }
+        ev = emit(out, type, touch->x, touch->y, touch->time_us);
+        ev->vx = vx;
+        ev->vy = vy;
+    } else {
+        ev = emit(out, GESTURE_PAN_END, touch->x, touch->y, touch->time_us);
+    }
+    ev->dx = dx;
+    ev->dy = dy;
+    return 1;
+}
+
+int gesture_feed(gesture_recognizer_t *rec, const touch_sample_t *touch, gesture_event_t *out) {
+    bool is_primary = rec->contacts > 0 && touch->id == rec->primary_id;
+    bool is_second = rec->contacts > 1 && touch->id == rec->second_id;
+
+    // A long press can come due just before the next sample arrives
+    int n = gesture_poll(rec, touch->time_us, out);
+
+    switch (touch->type) {
+        case TOUCH_DOWN:
+            if (rec->contacts == 0) {
+                n += primary_down(rec, touch);
+            } else if (rec->contacts == 1 && !is_primary) {
+                n += begin_pinch(rec, touch);
+            }
+            break;
+
+        case TOUCH_MOVE:
+            if (rec->pinching && (is_primary || is_second)) {
+                if (is_primary) {
+                    rec->x = touch->x;
+                    rec->y = touch->y;
+                } else {
+                    rec->second_x = touch->x;
+                    rec->second_y = touch->y;
+                }
+                uint32_t scale = (finger_distance(rec) << 16) / rec->pinch_start_dist;
+                if (scale != rec->pinch_scale) {
+                    rec->pinch_scale = scale;
+                    emit_pinch(rec, &out[n++], GESTURE_PINCH, touch->time_us);
+                }
+            } else if (is_primary) {
+                n += primary_move(rec, touch, &out[n]);
+            }
+            break;
+
+        case TOUCH_UP:
+            if (!is_primary && !is_second) break;
+            if (rec->pinching) {
+                n += end_pinch(rec, &out[n], touch->time_us);
+            } else if (is_primary && rec->contacts == 1) {
+                n += primary_up(rec, touch, &out[n]);
+            }
+            if (is_primary && rec->contacts == 2) {
+                // The remaining finger takes over, but only to finish the gesture
+                rec->primary_id = rec->second_id;
+                rec->x = rec->second_x;
+                rec->y = rec->second_y;
+            }
+            rec->contacts--;
+            if (rec->contacts == 0) rec->consumed = false;
+            break;
+    }
+    return n;
+}
+
+int gesture_poll(gesture_recognizer_t *rec, uint32_t now_us, gesture_event_t *out) {
+    if (rec->contacts != 1 || rec->consumed || rec->panning || rec->long_pressed) return 0;
+    if (timer_diff(now_us, rec->down_us) < GESTURE_LONG_PRESS_US) return 0;
+
+    rec->long_pressed = true;
+    emit(out, GESTURE_LONG_PRESS, rec->start_x, rec->start_y, now_us);
+    return 1;
+}
+
+const char *gesture_name(gesture_t type) {
+    static const char *const names[] = {
+        "NONE", "SWIPE_UP", "SWIPE_DOWN", "SWIPE_LEFT", "SWIPE_RIGHT",
+        "PINCH_IN", "PINCH_OUT", "TAP", "LONG_PRESS", "PAN", "PAN_END", "PINCH"
+    };
+    if ((unsigned)type >= sizeof(names) / sizeof(names[0])) return "?";
+    return names[type];
+}
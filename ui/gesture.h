@@ -0,0 +1,64 @@
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../input/touch.h"
+
+// Recognizer tuning (screen pixels, microseconds)
+#define GESTURE_SLOP_PX             10          // Movement that still counts as holding still
+#define GESTURE_LONG_PRESS_US       500000
+#define GESTURE_FLING_MIN_PX_S      1200        // Release speed that turns a pan into a fling
+#define GESTURE_VELOCITY_WINDOW_US  100000      // Samples older than this don't count toward velocity
+#define GESTURE_PINCH_THRESHOLD     (65536 / 8) // Q16 scale change a lifted pinch needs
+#define GESTURE_HISTORY             8           // Samples kept for velocity
+
+// Most events one touch sample (or poll) can produce
+#define GESTURE_MAX_EVENTS 2
+
+typedef struct {
+    gesture_t type;
+    int x, y;               // Where it happened; the midpoint for pinches
+    int dx, dy;             // Pans: offset from where the finger went down
+    int vx, vy;             // Flings: release velocity in pixels per second
+    uint32_t scale;         // Pinches: Q16 finger distance relative to its start
+    uint32_t time_us;       // Timestamp of the touch sample (or poll) behind it
+} gesture_event_t;
+
+// Recognizer state; one per screen that wants gestures
+typedef struct {
+    int contacts;                       // Fingers currently down
+    uint8_t primary_id;
+    uint8_t second_id;
+    int x, y;                           // Primary contact
+    int second_x, second_y;
+    int start_x, start_y;
+    uint32_t down_us;
+    bool panning;                       // Moved past the slop
+    bool long_pressed;
+    bool pinching;
+    bool consumed;                      // Ignore the rest until every finger is up
+    uint32_t pinch_start_dist;
+    uint32_t pinch_scale;               // Q16
+    // Recent primary positions for velocity, a ring of GESTURE_HISTORY
+    int16_t hist_x[GESTURE_HISTORY];
+    int16_t hist_y[GESTURE_HISTORY];
+    uint32_t hist_us[GESTURE_HISTORY];
+    int hist_count;
+    int hist_next;
+} gesture_recognizer_t;
+
+void gesture_init(gesture_recognizer_t *rec);
+
+// Feed one touch sample, in timestamp order. Writes up to GESTURE_MAX_EVENTS
+// events to out and returns how many.
+int gesture_feed(gesture_recognizer_t *rec, const touch_sample_t *touch, gesture_event_t *out);
+
+// Long presses fire while the finger holds still, when no samples arrive, so
+// call this once per frame. Returns 1 and fills out when one fires.
+int gesture_poll(gesture_recognizer_t *rec, uint32_t now_us, gesture_event_t *out);
+
+// Printable name of a gesture type
+const char *gesture_name(gesture_t type);
+
+#endif // GESTURE_H
@@ -0,0 +1,153 @@
+// latency.c - touch-to-photon latency histograms
+#include "latency.h"
+#include "../drivers/display4k.h"
+#include "../drivers/serial.h"
+#include "../kernel/timer.h"
+#include <stdio.h>
+#include <string.h>
+
+#define HUD_WIDTH       360
+#define HUD_HEIGHT      96
+#define HUD_BAR_HEIGHT  40
+#define HUD_BG          0x000000
+#define HUD_TEXT        0x00FF00
+#define HUD_WARN        0xFFAA00
+
+// Latencies from this bucket up span more than two 60 Hz frames
+#define WARN_BUCKET     15
+
+static latency_histogram_t histograms[LATENCY_KIND_COUNT];
+
+// Arrival times of the inputs handled by the frame being built
+static uint32_t pending[LATENCY_MAX_PENDING];
+static int pending_count = 0;
+
+static uint32_t serial_interval_ms = 0;
+static uint32_t last_dump_ms = 0;
+static bool hud_visible = false;
+
+static const char *const kind_names[LATENCY_KIND_COUNT] = { "dispatch", "touch>photon" };
+
+void latency_init(void) {
+    memset(histograms, 0, sizeof(histograms));
+    pending_count = 0;
+    last_dump_ms = timer_now_ms();
+}
+
+static int bucket_of(uint32_t us) {
+    if (us < 2) return 0;
+    int k = 31 - __builtin_clz(us);
+    return k < LATENCY_BUCKETS ? k : LATENCY_BUCKETS - 1;
+}
+
+static void record(latency_kind_t kind, int32_t us) {
+    latency_histogram_t *hist = &histograms[kind];
+    if (us < 0) us = 0;
+    hist->buckets[bucket_of((uint32_t)us)]++;
+    hist->count++;
+    if ((uint32_t)us > hist->max_us) hist->max_us = (uint32_t)us;
+}
+
+void latency_input_dispatched(uint32_t input_us) {
+    record(LATENCY_DISPATCH, timer_diff(timer_now_us(), input_us));
+
+    // Inputs past the limit in one frame still count toward dispatch latency
+    if (pending_count < LATENCY_MAX_PENDING) {
+        pending[pending_count++] = input_us;
+    }
+}
+
+void latency_frame_presented(uint32_t present_us) {
+    for (int i = 0; i < pending_count; i++) {
+        record(LATENCY_PRESENT, timer_diff(present_us, pending[i]));
+    }
+    pending_count = 0;
+
+    if (serial_interval_ms &&
+        timer_diff(timer_now_ms(), last_dump_ms) >= (int32_t)serial_interval_ms) {
+        latency_dump_serial();
+    }
+}
+
+void latency_get_histogram(latency_kind_t kind, latency_histogram_t *hist) {
+    *hist = histograms[kind];
+}
+
+uint32_t latency_percentile_us(const latency_histogram_t *hist, int percent) {
+    if (!hist->count) return 0;
+
+    uint64_t target = (uint64_t)hist->count * (uint32_t)percent;
+    uint64_t seen = 0;
+    for (int k = 0; k < LATENCY_BUCKETS; k++) {
+        seen += hist->buckets[k];
+        if (seen * 100 >= target) {
+            uint32_t edge = k < LATENCY_BUCKETS - 1 ? 1u << (k + 1) : hist->max_us;
+            return edge < hist->max_us ? edge : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+void latency_dump_serial(void) {
+    char line[96];
+    last_dump_ms = timer_now_ms();
+
+    for (int kind = 0; kind < LATENCY_KIND_COUNT; kind++) {
+        const latency_histogram_t *hist = &histograms[kind];
+        snprintf(line, sizeof(line), "latency %s n=%u p50<=%uus p99<=%uus max=%uus\r\n",
+                 kind_names[kind], hist->count, latency_percentile_us(hist, 50),
+                 latency_percentile_us(hist, 99), hist->max_us);
+        serial_write(SERIAL_COM1, line);
+
+        for (int k = 0; k < LATENCY_BUCKETS; k++) {
+            if (!hist->buckets[k]) continue;
+            snprintf(line, sizeof(line), "  %7uus+ %u\r\n", k ? 1u << k : 0u, hist->buckets[k]);
+            serial_write(SERIAL_COM1, line);
+        }
+    }
+}
+
+void latency_set_serial_interval_ms(uint32_t interval_ms) {
+    serial_interval_ms = interval_ms;
+}
+
+void latency_set_hud(bool visible) {
+    hud_visible = visible;
+}
+
+// "12.34ms" from microseconds
+static void format_ms(char *buf, int size, uint32_t us) {
+    snprintf(buf, size, "%u.%02ums", us / 1000, (us % 1000) / 10);
+}
+
+void draw_latency_hud(int x, int y) {
+    if (!hud_visible) return;
+
+    char line[64], p50[16], p99[16];
+    draw_filled_rect(x, y, HUD_WIDTH, HUD_HEIGHT, HUD_BG);
+
+    for (int kind = 0; kind < LATENCY_KIND_COUNT; kind++) {
+        const latency_histogram_t *hist = &histograms[kind];
+        format_ms(p50, sizeof(p50), latency_percentile_us(hist, 50));
+        format_ms(p99, sizeof(p99), latency_percentile_us(hist, 99));
+        snprintf(line, sizeof(line), "%s p50 %s p99 %s", kind_names[kind], p50, p99);
+        draw_string(x + 8, y + 8 + kind * 18, line, HUD_TEXT);
+    }
+
+    // Touch-to-photon distribution, one bar per bucket
+    const latency_histogram_t *hist = &histograms[LATENCY_PRESENT];
+    uint32_t peak = 0;
+    for (int k = 0; k < LATENCY_BUCKETS; k++) {
+        if (hist->buckets[k] > peak) peak = hist->buckets[k];
+    }
+    // Scale counts down so count * HUD_BAR_HEIGHT stays within 32 bits
+    int shift = 0;
+    while ((peak >> shift) > 0xFFFFFF) shift++;
+    
+    int base_y = y + HUD_HEIGHT - 8;
+    for (int k = 0; k < LATENCY_BUCKETS && peak; k++) {
+        int h = (int)(((hist->buckets[k] >> shift) * HUD_BAR_HEIGHT) / (peak >> shift));
+        if (hist->buckets[k] && h == 0) h = 1;
+        draw_filled_rect(x + 8 + k * 16, base_y - h, 12, h, k >= WARN_BUCKET ? HUD_WARN : HUD_TEXT);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// log2 buckets: bucket k holds [2^k, 2^(k+1)) us, the last one everything
+// from about a second up
+#define LATENCY_BUCKETS 21
+
+// Inputs dispatched in one frame that still get a present timestamp
+#define LATENCY_MAX_PENDING 32
+
+typedef enum {
+    LATENCY_DISPATCH,       // Touch arrival to handle_touch_event()
+    LATENCY_PRESENT,        // Touch arrival to the present of the frame that handled it
+    LATENCY_KIND_COUNT
+} latency_kind_t;
+
+typedef struct {
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} latency_histogram_t;
+
+void latency_init(void);
+
+// An input that arrived at input_us (timer_now_us) is being dispatched now
+void latency_input_dispatched(uint32_t input_us);
+
+// The frame built since the last call was presented at present_us
+void latency_frame_presented(uint32_t present_us);
+
+void latency_get_histogram(latency_kind_t kind, latency_histogram_t *hist);
+
+// Upper edge of the bucket holding the given percentile (capped at the max)
+uint32_t latency_percentile_us(const latency_histogram_t *hist, int percent);
+
+// Write both histograms to COM1; with an interval, also every interval_ms
+// from latency_frame_presented() (0 turns that off)
+void latency_dump_serial(void);
+void latency_set_serial_interval_ms(uint32_t interval_ms);
+
+// On-screen latency overlay
+void latency_set_hud(bool visible);
+void draw_latency_hud(int x, int y);
+
+#endif // LATENCY_H
@@ -1,11 +1,20 @@
 #include "launcher.h"
 #include "../drivers/display.h"
+#include "../drivers/font_render.h"
+#include "../drivers/display_list.h"
+#include "../drivers/hit_grid.h"
+#include "wallpapers.h"
 #include "../kernel/app_manager.h"
 #include "../input/touch.h"
 #include "animations.h"
+#include "gesture.h"
+#include "touch_resampler.h"
+#include "frame_pacer.h"
+#include "app_search.h"
+#include "../kernel/timer.h"
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
+#include <stdlib.h>
 
 // Mobile-specific constants
 #define MOBILE_ICON_SIZE 80
@@ -16,11 +25,19 @@
 #define MOBILE_STATUS_BAR_HEIGHT 30
 #define MOBILE_SEARCH_HEIGHT 50
 #define MOBILE_PAGE_INDICATOR_HEIGHT 20
+#define MOBILE_SEARCH_ROW_HEIGHT 60
+#define MOBILE_SEARCH_RESULTS 8
 
-// Touch sensitivity
-#define TOUCH_THRESHOLD 10
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+// Icon scale while long-pressed (Q16)
+#define ICON_PRESS_SCALE (ANIM_ONE + ANIM_ONE / 10)
+
+// A slow drag still turns the page once it has moved this far
 #define SWIPE_THRESHOLD 100
-#define LONG_PRESS_DURATION 500
+
+// Hit-test cells; icons are 80px, so a touch lands among at most four
+#define ICON_HIT_CELL_SHIFT 7
 
 // Colors optimized for mobile displays
 #define COLOR_BG_PRIMARY 0x000000
@@ -34,13 +51,32 @@
 #define COLOR_ACCENT 0x007AFF
 
 static launcher_state_t launcher_state;
-static touch_state_t last_touch;
+static gesture_recognizer_t gestures;
+static touch_resampler_t drag_finger;     // Primary finger, for drawing the drag where it will be
 static int current_page = 0;
 static int total_pages = 0;
 static int drag_offset_x = 0;
 static bool is_dragging = false;
-static bool is_long_pressing = false;
-static int long_press_timer = 0;
+static bool is_long_pressing = false;     // Finger resting on the selected icon
+
+// Icons on screen by position; rebuilt on the first touch after the layout changes
+static hit_grid_t icon_hits;
+static bool icon_hits_dirty = true;
+
+// Retained display lists; each owns a disjoint screen region
+static display_list_t status_list;
+static display_list_t grid_list;
+static display_list_t dock_list;
+static bool needs_full_redraw = true;
+static bool status_recorded = false;    // The status bar's content is fixed; record it once
+static int shown_drag_offset_x = 0;  // drag_offset_x the grid on screen was drawn with
+static uint32_t shown_wallpaper_generation = 0;
+
+// Search results for launcher_state.search_query, best first; the index is
+// rebuilt on the next search after the app list changes
+static search_result_t search_results[MOBILE_SEARCH_RESULTS];
+static int search_result_count = 0;
+static bool search_index_dirty = true;
 
 void launcher_init(void) {
     memset(&launcher_state, 0, sizeof(launcher_state_t));
@@ -71,6 +107,25 @@ void launcher_init(void) {
     // Calculate total pages
     int apps_per_page = MOBILE_GRID_COLS * MOBILE_GRID_ROWS;
     total_pages = (launcher_state.app_count + apps_per_page - 1) / apps_per_page;
+    
+    dl_init(&status_list, COLOR_BG_PRIMARY);
+    status_recorded = false;
+    dl_init(&grid_list, COLOR_BG_PRIMARY);
+    dl_init(&dock_list, COLOR_BG_PRIMARY);
+    dl_set_bounds(&status_list, 0, 0, SCREEN_WIDTH, MOBILE_STATUS_BAR_HEIGHT);
+    dl_set_bounds(&grid_list, 0, MOBILE_STATUS_BAR_HEIGHT, SCREEN_WIDTH,
+                  SCREEN_HEIGHT - MOBILE_STATUS_BAR_HEIGHT - MOBILE_DOCK_HEIGHT);
+    dl_set_bounds(&dock_list, 0, SCREEN_HEIGHT - MOBILE_DOCK_HEIGHT, SCREEN_WIDTH, MOBILE_DOCK_HEIGHT);
+    needs_full_redraw = true;
+    
+    gesture_init(&gestures);
+    touch_resampler_reset(&drag_finger);
+    icon_hits_dirty = true;
+    search_index_dirty = true;
+    search_result_count = 0;
+    drag_offset_x = 0;
+    is_dragging = false;
+    is_long_pressing = false;
 }
 
 int launcher_add_app(const char* name, const char* icon_path, const char* executable_path) {
@@ -98,85 +153,115 @@ int launcher_add_app(const char* name, const char* icon_path, const char* execut
     app->icon_color = colors[launcher_state.app_count % 6];
     
     launcher_state.app_count++;
+    icon_hits_dirty = true;
+    search_index_dirty = true;
     return launcher_state.app_count - 1;
 }
 
-void draw_status_bar(void) {
+void draw_mobile_status_bar(void) {
+    // The retained frame repaints it after invalidation; only new content needs recording
+    if (status_recorded) return;
+    status_recorded = true;
+    
+    dl_begin(&status_list);
+    
     // Draw status bar background
-    draw_rect(0, 0, SCREEN_WIDTH, MOBILE_STATUS_BAR_HEIGHT, COLOR_BG_SECONDARY);
+    dl_rect(&status_list, 0, 0, SCREEN_WIDTH, MOBILE_STATUS_BAR_HEIGHT, COLOR_BG_SECONDARY);
     
     // Draw time (placeholder)
-    draw_string(20, 8, "9:41", COLOR_TEXT_PRIMARY);
+    dl_text(&status_list, 20, 8, "9:41", COLOR_TEXT_PRIMARY);
     
     // Draw battery and signal indicators
-    draw_string(SCREEN_WIDTH - 80, 8, "100%", COLOR_TEXT_PRIMARY);
-    draw_string(SCREEN_WIDTH - 40, 8, "📶", COLOR_TEXT_PRIMARY);
+    dl_text(&status_list, SCREEN_WIDTH - 80, 8, "100%", COLOR_TEXT_PRIMARY);
+    dl_text(&status_list, SCREEN_WIDTH - 40, 8, "📶", COLOR_TEXT_PRIMARY);
+    
+    dl_end(&status_list);
 }
 
-void draw_mobile_app_icon(int index, int x, int y, int selected, float scale) {
+void draw_mobile_app_icon(display_list_t* dl, int index, int x, int y, int selected, uint32_t scale) {
     if (index >= launcher_state.app_count) return;
     
     launcher_app_t* app = &launcher_state.apps[index];
     
-    int icon_size = (int)(MOBILE_ICON_SIZE * scale);
+    int icon_size = (int)((MOBILE_ICON_SIZE * scale + ANIM_ONE / 2) >> ANIM_FIX_SHIFT);
     int icon_x = x + (MOBILE_ICON_SIZE - icon_size) / 2;
     int icon_y = y + (MOBILE_ICON_SIZE - icon_size) / 2;
     
     // Draw icon shadow for depth
-    draw_rounded_rect(icon_x + 2, icon_y + 2, icon_size, icon_size, 
-                     icon_size / 4, 0x000000AA);
+    dl_rounded_rect(dl, icon_x + 2, icon_y + 2, icon_size, icon_size, 
+                    icon_size / 4, 0x000000AA);
     
     // Draw icon background
     uint32_t bg_color = selected ? COLOR_ICON_SELECTED : app->icon_color;
-    draw_rounded_rect(icon_x, icon_y, icon_size, icon_size, 
-                     icon_size / 4, bg_color);
+    dl_rounded_rect(dl, icon_x, icon_y, icon_size, icon_size, 
+                    icon_size / 4, bg_color);
     
     // Draw icon highlight
-    draw_rounded_rect(icon_x + 2, icon_y + 2, icon_size - 4, icon_size / 3, 
-                     icon_size / 4, 0xFFFFFF40);
+    dl_rounded_rect(dl, icon_x + 2, icon_y + 2, icon_size - 4, icon_size / 3, 
+                    icon_size / 4, 0xFFFFFF40);
     
     // Draw app name below icon
     int text_y = y + MOBILE_ICON_SIZE + 5;
     uint32_t text_color = selected ? COLOR_ACCENT : COLOR_TEXT_PRIMARY;
     
     // Center text under icon
-    int text_width = strlen(app->name) * 6; // Approximate text width
+    int text_width;
+    measure_string(app->name, 1, &text_width, NULL);
     int text_x = x + (MOBILE_ICON_SIZE - text_width) / 2;
-    draw_string(text_x, text_y, app->name, text_color);
+    dl_text(dl, text_x, text_y, app->name, text_color);
     
     // Store position for touch handling
     app->x = x;
     app->y = y;
 }
 
-void draw_mobile_grid(void) {
+// Where app i sits on the current page right now; false if it isn't shown
+static bool grid_icon_position(int i, int* x, int* y) {
     int start_x = (SCREEN_WIDTH - (MOBILE_GRID_COLS * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING) - MOBILE_ICON_SPACING)) / 2;
     int start_y = MOBILE_STATUS_BAR_HEIGHT + 40;
-    
     int apps_per_page = MOBILE_GRID_COLS * MOBILE_GRID_ROWS;
     int page_start = current_page * apps_per_page;
-    int page_end = MIN(page_start + apps_per_page, launcher_state.app_count);
+    
+    if (i < page_start || i >= page_start + apps_per_page || i >= launcher_state.app_count) return false;
+    if (!launcher_state.apps[i].visible) return false;
+    
+    int app_index = i - page_start;
+    int col = app_index % MOBILE_GRID_COLS;
+    int row = app_index / MOBILE_GRID_COLS;
     
     // Apply page transition offset
-    int page_offset = drag_offset_x;
+    *x = start_x + col * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING) + drag_offset_x;
+    *y = start_y + row * (MOBILE_ICON_SIZE + 30);
+    
+    // Skip icons that are off-screen during page transitions
+    return *x >= -MOBILE_ICON_SIZE && *x <= SCREEN_WIDTH;
+}
+
+// Where dock slot i sits (the first apps are pinned to the dock)
+static int dock_app_count(void) {
+    return MIN(4, launcher_state.app_count);
+}
+
+static void dock_icon_position(int i, int* x, int* y) {
+    int dock_apps = dock_app_count();
+    int dock_start_x = (SCREEN_WIDTH - (dock_apps * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING) - MOBILE_ICON_SPACING)) / 2;
+    *x = dock_start_x + i * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING);
+    *y = SCREEN_HEIGHT - MOBILE_DOCK_HEIGHT + (MOBILE_DOCK_HEIGHT - MOBILE_ICON_SIZE) / 2;
+}
+
+void draw_mobile_grid(void) {
+    int apps_per_page = MOBILE_GRID_COLS * MOBILE_GRID_ROWS;
+    int page_start = current_page * apps_per_page;
+    int page_end = MIN(page_start + apps_per_page, launcher_state.app_count);
     
     for (int i = page_start; i < page_end; i++) {
-        if (!launcher_state.apps[i].visible) continue;
-        
-        int app_index = i - page_start;
-        int col = app_index % MOBILE_GRID_COLS;
-        int row = app_index / MOBILE_GRID_COLS;
-        
-        int x = start_x + col * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING) + page_offset;
-        int y = start_y + row * (MOBILE_ICON_SIZE + 30);
-        
-        // Skip icons that are off-screen during page transitions
-        if (x < -MOBILE_ICON_SIZE || x > SCREEN_WIDTH) continue;
+        int x, y;
+        if (!grid_icon_position(i, &x, &y)) continue;
         
         int selected = (i == launcher_state.selected_app);
-        float scale = selected && is_long_pressing ? 1.1f : 1.0f;
+        uint32_t scale = selected && is_long_pressing ? ICON_PRESS_SCALE : ANIM_ONE;
         
-        draw_mobile_app_icon(i, x, y, selected, scale);
+        draw_mobile_app_icon(&grid_list, i, x, y, selected, scale);
     }
 }
 
@@ -192,29 +277,43 @@ void draw_page_indicators(void) {
     for (int i = 0; i < total_pages; i++) {
         int x = start_x + i * indicator_spacing;
         uint32_t color = (i == current_page) ? COLOR_ACCENT : COLOR_TEXT_SECONDARY;
-        draw_circle(x + indicator_size/2, y + indicator_size/2, indicator_size/2, color);
+        dl_circle(&grid_list, x + indicator_size/2, y + indicator_size/2, indicator_size/2, color);
     }
 }
 
 void draw_dock(void) {
     int dock_y = SCREEN_HEIGHT - MOBILE_DOCK_HEIGHT;
     
+    dl_begin(&dock_list);
+    
     // Draw dock background with blur effect
-    draw_rounded_rect(0, dock_y, SCREEN_WIDTH, MOBILE_DOCK_HEIGHT, 0, COLOR_DOCK_BG);
+    dl_rounded_rect(&dock_list, 0, dock_y, SCREEN_WIDTH, MOBILE_DOCK_HEIGHT, 0, COLOR_DOCK_BG);
     
-    // Draw dock separator line
-    draw_line(0, dock_y, SCREEN_WIDTH, dock_y, COLOR_TEXT_SECONDARY);
+    // Draw dock separator line (above the background in paint order)
+    dl_set_layer(&dock_list, 1);
+    dl_line(&dock_list, 0, dock_y, SCREEN_WIDTH, dock_y, COLOR_TEXT_SECONDARY);
     
     // Draw dock apps (first 4 apps are pinned to dock)
-    int dock_apps = MIN(4, launcher_state.app_count);
-    int dock_start_x = (SCREEN_WIDTH - (dock_apps * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING) - MOBILE_ICON_SPACING)) / 2;
-    int dock_icon_y = dock_y + (MOBILE_DOCK_HEIGHT - MOBILE_ICON_SIZE) / 2;
-    
-    for (int i = 0; i < dock_apps; i++) {
-        int x = dock_start_x + i * (MOBILE_ICON_SIZE + MOBILE_ICON_SPACING);
+    for (int i = 0; i < dock_app_count(); i++) {
+        int x, y;
+        dock_icon_position(i, &x, &y);
         int selected = (i == launcher_state.selected_app && current_page == 0);
-        draw_mobile_app_icon(i, x, dock_icon_y, selected, 1.0f);
+        draw_mobile_app_icon(&dock_list, i, x, y, selected, ANIM_ONE);
     }
+    
+    dl_end(&dock_list);
+}
+
+// Top of search result row i
+static int search_row_y(int i) {
+    return MOBILE_STATUS_BAR_HEIGHT + 20 + MOBILE_SEARCH_HEIGHT + 20 + i * MOBILE_SEARCH_ROW_HEIGHT;
+}
+
+// Index of the search result row under (x, y), or -1
+static int search_result_at(int x, int y) {
+    if (x < 20 || x >= SCREEN_WIDTH - 20 || y < search_row_y(0)) return -1;
+    int row = (y - search_row_y(0)) / MOBILE_SEARCH_ROW_HEIGHT;
+    return row < search_result_count ? row : -1;
 }
 
 void draw_search_interface(void) {
@@ -232,119 +331,234 @@ void draw_search_interface(void) {
     draw_string(40, search_y + 15, "🔍", COLOR_TEXT_PRIMARY);
     draw_string(70, search_y + 15, launcher_state.search_query, COLOR_TEXT_PRIMARY);
     
-    // Draw search results
-    // TODO: Implement search results display
+    // Draw search results, best match first
+    if (launcher_state.search_query[0] && search_result_count == 0) {
+        draw_string(40, search_row_y(0) + 20, "No results", COLOR_TEXT_SECONDARY);
+    }
+    for (int i = 0; i < search_result_count; i++) {
+        const launcher_app_t* app = &launcher_state.apps[search_results[i].id];
+        int row_y = search_row_y(i);
+        int icon_size = MOBILE_SEARCH_ROW_HEIGHT - 20;
+        draw_rounded_rect(40, row_y + 10, icon_size, icon_size, icon_size / 4, app->icon_color);
+        draw_string(40 + icon_size + 20, row_y + 15, app->name, COLOR_TEXT_PRIMARY);
+        draw_string(40 + icon_size + 20, row_y + 15 + FONT_LINE_HEIGHT, app->executable_path, COLOR_TEXT_SECONDARY);
+    }
+}
+
+// Move the page with the finger, at most half a screen either way
+static void set_drag_offset(int offset) {
+    if (offset > SCREEN_WIDTH / 2) offset = SCREEN_WIDTH / 2;
+    if (offset < -SCREEN_WIDTH / 2) offset = -SCREEN_WIDTH / 2;
+    if (offset != drag_offset_x) {
+        drag_offset_x = offset;
+        icon_hits_dirty = true;
+    }
 }
 
 void launcher_ui_loop(void) {
-    // Clear screen
-    clear_screen(COLOR_BG_PRIMARY);
+    // Lists erase through the cached wallpaper when one is loaded. Its buffer
+    // is reused by every load, so a new one shows up as a new generation.
+    const uint32_t* wallpaper = wallpaper_get_pixels();
+    if (wallpaper_generation() != shown_wallpaper_generation) {
+        dl_set_background_image(&status_list, wallpaper);
+        dl_set_background_image(&grid_list, wallpaper);
+        dl_set_background_image(&dock_list, wallpaper);
+        shown_wallpaper_generation = wallpaper_generation();
+        needs_full_redraw = true;
+    }
+    
+    // Clear screen only when the retained lists no longer match it
+    if (needs_full_redraw) {
+        if (wallpaper) {
+            reset_clip_rect();
+            draw_wallpaper();
+        } else {
+            clear_screen(COLOR_BG_PRIMARY);
+        }
+        dl_invalidate(&status_list);
+        dl_invalidate(&grid_list);
+        dl_invalidate(&dock_list);
+        needs_full_redraw = false;
+    }
+    
+    // Recompose only where animations were and will be; they paint on top afterwards
+    dl_damage_t anim_damage;
+    anim_damage.count = 0;
+    update_animations(&anim_damage);
+    dl_invalidate_region(&status_list, &anim_damage);
+    dl_invalidate_region(&grid_list, &anim_damage);
+    dl_invalidate_region(&dock_list, &anim_damage);
     
     // Draw status bar
-    draw_status_bar();
+    draw_mobile_status_bar();
+    dl_submit(&status_list);
     
     // Draw search interface if active
     if (launcher_state.search_mode) {
         draw_search_interface();
+        // The overlay is immediate-mode; repaint the home screen once it closes
+        needs_full_redraw = true;
         return;
     }
     
-    // Draw app grid
-    draw_mobile_grid();
+    // Draw the drag where the finger will be when this frame is presented,
+    // not where it was at the last touch sample
+    int finger_x, finger_y;
+    if (is_dragging && touch_resampler_sample(&drag_finger, frame_pacer_next_present_us(), &finger_x, &finger_y)) {
+        set_drag_offset(finger_x - gestures.start_x);
+    }
+    
+    // Slide the icons already on screen with the drag instead of re-rasterizing them
+    if (drag_offset_x != shown_drag_offset_x) {
+        clip_rect_t grid_region = { 0, MOBILE_STATUS_BAR_HEIGHT, SCREEN_WIDTH,
+                                    SCREEN_HEIGHT - MOBILE_DOCK_HEIGHT - MOBILE_PAGE_INDICATOR_HEIGHT };
+        dl_scroll(&grid_list, &grid_region, drag_offset_x - shown_drag_offset_x, 0);
+        shown_drag_offset_x = drag_offset_x;
+    }
     
-    // Draw page indicators
+    // Draw app grid and page indicators; only changed icons are repainted
+    dl_begin(&grid_list);
+    draw_mobile_grid();
     draw_page_indicators();
+    dl_end(&grid_list);
+    dl_submit(&grid_list);
     
     // Draw dock
     draw_dock();
+    dl_submit(&dock_list);
     
-    // Update animations
-    update_animations();
+    draw_animations();
     
-    // Handle long press timing
-    if (is_long_pressing) {
-        long_press_timer++;
-        if (long_press_timer > LONG_PRESS_DURATION) {
-            // Enter edit mode
-            launcher_state.edit_mode = 1;
+    // Long presses fire on time, not on touch events
+    gesture_event_t gesture;
+    if (gesture_poll(&gestures, timer_now_us(), &gesture)) {
+        launcher_handle_gesture(&gesture);
+    }
+}
+
+// Index every icon on screen (page grid and dock) by its app
+static void rebuild_icon_hits(void) {
+    int apps_per_page = MOBILE_GRID_COLS * MOBILE_GRID_ROWS;
+    int page_start = current_page * apps_per_page;
+    int page_end = MIN(page_start + apps_per_page, launcher_state.app_count);
+    
+    hit_grid_begin(&icon_hits, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, ICON_HIT_CELL_SHIFT);
+    for (int i = page_start; i < page_end; i++) {
+        int x, y;
+        if (grid_icon_position(i, &x, &y)) {
+            hit_grid_add(&icon_hits, x, y, MOBILE_ICON_SIZE, MOBILE_ICON_SIZE, i);
         }
     }
+    for (int i = 0; i < dock_app_count(); i++) {
+        int x, y;
+        dock_icon_position(i, &x, &y);
+        hit_grid_add(&icon_hits, x, y, MOBILE_ICON_SIZE, MOBILE_ICON_SIZE, i);
+    }
+    hit_grid_build(&icon_hits);
+    icon_hits_dirty = false;
 }
 
-void handle_launcher_touch(int x, int y, touch_event_t event) {
-    switch (event) {
-        case TOUCH_DOWN:
-            last_touch.x = x;
-            last_touch.y = y;
-            is_dragging = false;
-            is_long_pressing = true;
-            long_press_timer = 0;
-            
-            // Check if touch is on an app icon
-            for (int i = 0; i < launcher_state.app_count; i++) {
-                launcher_app_t* app = &launcher_state.apps[i];
-                if (x >= app->x && x <= app->x + MOBILE_ICON_SIZE &&
-                    y >= app->y && y <= app->y + MOBILE_ICON_SIZE) {
-                    launcher_state.selected_app = i;
-                    animate_touch_feedback(x, y);
-                    break;
+void handle_launcher_touch(const touch_sample_t* touch) {
+    if (touch->type == TOUCH_DOWN && gestures.contacts == 0) {
+        is_dragging = false;
+        is_long_pressing = true;
+        touch_resampler_reset(&drag_finger);
+        touch_resampler_add(&drag_finger, touch);
+        
+        // Check if touch is on an app icon
+        if (icon_hits_dirty) {
+            rebuild_icon_hits();
+        }
+        int hit = hit_grid_find(&icon_hits, touch->x, touch->y);
+        if (hit >= 0) {
+            launcher_state.selected_app = hit;
+            animate_touch_feedback(touch->x, touch->y);
+        }
+    }
+    
+    if (touch->type == TOUCH_MOVE && touch->id == gestures.primary_id) {
+        touch_resampler_add(&drag_finger, touch);
+    }
+    
+    gesture_event_t events[GESTURE_MAX_EVENTS];
+    int count = gesture_feed(&gestures, touch, events);
+    for (int i = 0; i < count; i++) {
+        launcher_handle_gesture(&events[i]);
+    }
+    
+    if (touch->type == TOUCH_UP && gestures.contacts == 0) {
+        is_long_pressing = false;
+        is_dragging = false;
+        if (drag_offset_x != 0) {
+            drag_offset_x = 0;
+            icon_hits_dirty = true;
+        }
+    }
+}
+
+// Turn the page the drag was heading for
+static void finish_page_drag(int direction) {
+    icon_hits_dirty = true;
+    if (direction > 0 && current_page < total_pages - 1) {
+        current_page++;
+        animate_page_transition(1);
+    } else if (direction < 0 && current_page > 0) {
+        current_page--;
+        animate_page_transition(-1);
+    }
+}
+
+void launcher_handle_gesture(const gesture_event_t* gesture) {
+    switch (gesture->type) {
+        case GESTURE_TAP:
+            // Launch a search result, or the tapped icon
+            if (launcher_state.search_mode) {
+                int row = search_result_at(gesture->x, gesture->y);
+                if (row >= 0) {
+                    app_manager_launch(launcher_state.apps[search_results[row].id].executable_path);
                 }
+            } else if (launcher_state.selected_app >= 0) {
+                launcher_app_t* app = &launcher_state.apps[launcher_state.selected_app];
+                app_manager_launch(app->executable_path);
+                animate_app_launch(app->x, app->y);
             }
             break;
             
-        case TOUCH_MOVE:
-            if (abs(x - last_touch.x) > TOUCH_THRESHOLD || 
-                abs(y - last_touch.y) > TOUCH_THRESHOLD) {
-                is_long_pressing = false;
-                
-                // Handle horizontal swipe for page navigation
-                if (abs(x - last_touch.x) > abs(y - last_touch.y)) {
-                    is_dragging = true;
-                    drag_offset_x = x - last_touch.x;
-                    
-                    // Limit drag offset
-                    if (drag_offset_x > SCREEN_WIDTH / 2) drag_offset_x = SCREEN_WIDTH / 2;
-                    if (drag_offset_x < -SCREEN_WIDTH / 2) drag_offset_x = -SCREEN_WIDTH / 2;
-                }
-            }
+        case GESTURE_LONG_PRESS:
+            // Enter edit mode
+            launcher_state.edit_mode = 1;
             break;
             
-        case TOUCH_UP:
+        case GESTURE_PAN:
             is_long_pressing = false;
             
+            // Handle horizontal drag for page navigation
+            if (is_dragging || abs(gesture->dx) > abs(gesture->dy)) {
+                is_dragging = true;
+                set_drag_offset(gesture->dx);
+            }
+            break;
+            
+        case GESTURE_PAN_END:
+            if (is_dragging && abs(drag_offset_x) > SWIPE_THRESHOLD) {
+                finish_page_drag(drag_offset_x < 0 ? 1 : -1);
+            }
+            break;
+            
+        case GESTURE_SWIPE_LEFT:
+        case GESTURE_SWIPE_RIGHT:
+            // A fling turns the page however short the drag was
             if (is_dragging) {
-                // Handle page swipe
-                if (abs(drag_offset_x) > SWIPE_THRESHOLD) {
-                    if (drag_offset_x > 0 && current_page > 0) {
-                        current_page--;
-                        animate_page_transition(-1);
-                    } else if (drag_offset_x < 0 && current_page < total_pages - 1) {
-                        current_page++;
-                        animate_page_transition(1);
-                    }
-                }
-                
-                // Reset drag state
-                is_dragging = false;
-                drag_offset_x = 0;
-            } else {
-                // Handle app launch
-                if (launcher_state.selected_app >= 0) {
-                    launcher_app_t* app = &launcher_state.apps[launcher_state.selected_app];
-                    app_manager_launch(app->executable_path);
-                    animate_app_launch(app->x, app->y);
-                }
+                finish_page_drag(gesture->type == GESTURE_SWIPE_LEFT ? 1 : -1);
             }
             break;
-    }
-}
-
-void launcher_handle_gesture(gesture_t gesture) {
-    switch (gesture) {
+            
         case GESTURE_SWIPE_DOWN:
             // Show search
-            launcher_state.search_mode = 1;
-            animate_search_appear();
+            if (!is_dragging) {
+                launcher_state.search_mode = 1;
+                animate_search_appear();
+            }
             break;
             
         case GESTURE_SWIPE_UP:
@@ -364,20 +578,32 @@ void launcher_handle_gesture(gesture_t gesture) {
             // Hide overview
             launcher_state.overview_mode = 0;
             break;
+            
+        default:
+            break;
     }
 }
 
+// Index every app under its name, with its executable's file name as a keyword
+static void rebuild_search_index(void) {
+    app_search_clear();
+    for (int i = 0; i < launcher_state.app_count; i++) {
+        const launcher_app_t* app = &launcher_state.apps[i];
+        const char* file = strrchr(app->executable_path, '/');
+        app_search_add(i, app->name, file ? file + 1 : app->executable_path);
+    }
+    search_index_dirty = false;
+}
+
+// Call on every keystroke with the whole query; typing onto the previous
+// query only narrows its matches, so this stays within a frame however many
+// apps are installed
 void launcher_update_search(const char* query) {
     strncpy(launcher_state.search_query, query, MAX_SEARCH_LENGTH - 1);
     launcher_state.search_query[MAX_SEARCH_LENGTH - 1] = '\0';
     
-    // Filter apps based on search query
-    for (int i = 0; i < launcher_state.app_count; i++) {
-        launcher_app_t* app = &launcher_state.apps[i];
-        if (strlen(query) == 0) {
-            app->visible = 1;
-        } else {
-            app->visible = (strstr(app->name, query) != NULL);
-        }
+    if (search_index_dirty) {
+        rebuild_search_index();
     }
-}
\ No newline at end of file
+    search_result_count = app_search_query(launcher_state.search_query, search_results, MOBILE_SEARCH_RESULTS);
+}
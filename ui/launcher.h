@@ -2,15 +2,19 @@
 #define LAUNCHER_H
 
 #include <stdint.h>
+#include "gesture.h"
 
 #define MAX_LAUNCHER_APPS 32
 #define LAUNCHER_COLS 4
 #define LAUNCHER_ROWS 8
+#define MAX_APP_NAME_LENGTH 64
+#define MAX_PATH_LENGTH 256
+#define MAX_SEARCH_LENGTH 128
 
 typedef struct {
-    char name[64];
-    char icon_path[256];
-    char executable_path[256];
+    char name[MAX_APP_NAME_LENGTH];
+    char icon_path[MAX_PATH_LENGTH];
+    char executable_path[MAX_PATH_LENGTH];
     uint32_t icon_color;
     int x, y;
     int width, height;
@@ -24,24 +28,31 @@ typedef struct {
     int selected_app;
     int scroll_offset;
     int search_mode;
-    char search_query[128];
+    char search_query[MAX_SEARCH_LENGTH];
     int animation_frame;
+    int grid_cols;
+    int grid_rows;
+    int icon_size;
+    int edit_mode;
+    int overview_mode;
 } launcher_state_t;
 
 // Launcher functions
 void launcher_init(void);
 void launcher_ui_loop(void);
 void launcher_handle_input(int key, int x, int y);
-void launcher_add_app(const char* name, const char* icon_path, const char* executable_path);
+int launcher_add_app(const char* name, const char* icon_path, const char* executable_path);
 void launcher_remove_app(int index);
 void launcher_launch_app(int index);
 void launcher_search_apps(const char* query);
+void launcher_update_search(const char* query);
+void launcher_handle_gesture(const gesture_event_t* gesture);
 
 // UI functions
 void draw_launcher_grid(void);
 void draw_launcher_dock(void);
 void draw_search_bar(void);
 void draw_app_icon(int index, int x, int y, int selected);
-void handle_launcher_touch(int x, int y);
+void handle_launcher_touch(const touch_sample_t* touch);
 
 #endif
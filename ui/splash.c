@@ -1,6 +1,9 @@
 #include "splash.h"
 #include "../drivers/display4k.h"
+#include "../drivers/font_render.h"
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
 // Animation state variables
 static int animation_frame = 0;
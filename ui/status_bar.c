@@ -1,6 +1,8 @@
 #include "status_bar.h"
 #include "../drivers/display4k.h"
+#include "../drivers/font_render.h"
 #include <stdio.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -13,8 +15,13 @@
 #define WARNING_COLOR       0xFFAA00
 #define CRITICAL_COLOR      0xFF0000
 
+// draw_text() cell size, for the rects fields erase
+#define TEXT_ADVANCE        (FONT_SIZE_DEFAULT * FONT_CHAR_ADVANCE)
+#define TEXT_HEIGHT         (FONT_SIZE_DEFAULT * FONT_GLYPH_HEIGHT)
+#define STATUS_FIELD_COUNT  6
+
 // System status structure
-typedef struct {
+struct SystemStatus {
     int battery_level;      // 0-100%
     bool is_charging;
     bool wifi_connected;
@@ -28,7 +35,7 @@ typedef struct {
     bool silent_mode;
     int cpu_usage;          // 0-100%
     int memory_usage;       // 0-100%
-} SystemStatus;
+};
 
 // Global system status
 static SystemStatus system_status = {
@@ -56,50 +63,154 @@ void render_status_bar() {
     // Future: Connect real battery and time modules
 }
 
-// Enhanced status bar with dynamic content
-void render_enhanced_status_bar() {
-    // Clear status bar area
-    draw_rect(0, 0, STATUS_BAR_WIDTH, STATUS_BAR_HEIGHT, STATUS_BAR_COLOR);
-    
-    // Left section: OS name and system info
-    draw_text(20, 35, "HASH OS", TEXT_COLOR);
-    
-    if (system_status.cpu_usage > 80) {
-        draw_text(20, 65, "CPU High", WARNING_COLOR);
-    }
-    
-    // Center section: Date
-    draw_text(STATUS_BAR_WIDTH/2 - 80, 50, system_status.date_string, TEXT_COLOR);
-    
-    // Right section: System status icons and info
+// Right-hand icons, laid out from the right edge; hidden ones take no room
+typedef struct {
+    int time_x;
+    int battery_x;
+    int wifi_x;
+    int bluetooth_x;
+    int volume_x;
+} status_layout_t;
+
+// Fields changed since the last render; setters only mark real changes
+static uint32_t dirty_fields = STATUS_FIELD_ALL;
+
+// Minute boundaries for status_bar_tick()
+static bool clock_started = false;
+static uint32_t minute_start_ms = 0;
+
+static void compute_layout(status_layout_t* layout) {
     int right_x = STATUS_BAR_WIDTH - 50;
     
-    // Time
-    char time_str[16];
-    snprintf(time_str, sizeof(time_str), "%02d:%02d", 
-             system_status.hour, system_status.minute);
     right_x -= 120;
-    draw_text(right_x, 35, time_str, TEXT_COLOR);
-    
-    // Battery
+    layout->time_x = right_x;
     right_x -= 150;
-    draw_battery_icon(right_x, 25);
-    
-    // WiFi
+    layout->battery_x = right_x;
     if (system_status.wifi_connected) {
         right_x -= 80;
-        draw_wifi_icon(right_x, 25);
     }
-    
-    // Bluetooth
+    layout->wifi_x = right_x;
     if (system_status.bluetooth_enabled) {
         right_x -= 60;
-        draw_bluetooth_icon(right_x, 30);
     }
-    
-    // Volume/Silent
+    layout->bluetooth_x = right_x;
     right_x -= 80;
-    draw_volume_icon(right_x, 30);
+    layout->volume_x = right_x;
+}
+
+static clip_rect_t make_rect(int x, int y, int width, int height) {
+    clip_rect_t r = { x, y, x + width, y + height };
+    return r;
+}
+
+// Everything a field can paint, so erasing it leaves nothing stale
+static clip_rect_t field_rect(status_field_t field, const status_layout_t* layout) {
+    switch (field) {
+        case STATUS_FIELD_DATE:
+            return make_rect(STATUS_BAR_WIDTH/2 - 80, 50,
+                             (int)(sizeof(system_status.date_string) - 1) * TEXT_ADVANCE, TEXT_HEIGHT);
+        case STATUS_FIELD_TIME:
+            return make_rect(layout->time_x, 35, 6 * TEXT_ADVANCE, TEXT_HEIGHT);
+        case STATUS_FIELD_BATTERY:
+            // Outline, then "CHG" and up to "100%" below it, from 20 px to the left
+            return make_rect(layout->battery_x - 20, 25, 10 + 4 * TEXT_ADVANCE, 25 + TEXT_HEIGHT);
+        case STATUS_FIELD_WIFI:
+            return make_rect(layout->wifi_x, 25, 30, 20);
+        case STATUS_FIELD_BLUETOOTH:
+            return make_rect(layout->bluetooth_x, 30, 2 * TEXT_ADVANCE, TEXT_HEIGHT);
+        default:
+            // Volume: "MUTE", or bars
+            return make_rect(layout->volume_x, 30, 4 * TEXT_ADVANCE, TEXT_HEIGHT);
+    }
+}
+
+static bool rects_overlap(const clip_rect_t* a, const clip_rect_t* b) {
+    return a->x0 < b->x1 && b->x0 < a->x1 && a->y0 < b->y1 && b->y0 < a->y1;
+}
+
+static void draw_field(status_field_t field, const status_layout_t* layout) {
+    switch (field) {
+        case STATUS_FIELD_DATE:
+            draw_text(STATUS_BAR_WIDTH/2 - 80, 50, system_status.date_string, TEXT_COLOR);
+            break;
+        case STATUS_FIELD_TIME: {
+            char time_str[16];
+            snprintf(time_str, sizeof(time_str), "%02d:%02d", 
+                     system_status.hour, system_status.minute);
+            draw_text(layout->time_x, 35, time_str, TEXT_COLOR);
+            break;
+        }
+        case STATUS_FIELD_BATTERY:
+            draw_battery_icon(layout->battery_x, 25);
+            break;
+        case STATUS_FIELD_WIFI:
+            if (system_status.wifi_connected) draw_wifi_icon(layout->wifi_x, 25);
+            break;
+        case STATUS_FIELD_BLUETOOTH:
+            if (system_status.bluetooth_enabled) draw_bluetooth_icon(layout->bluetooth_x, 30);
+            break;
+        default:
+            draw_volume_icon(layout->volume_x, 30);
+            break;
+    }
+}
+
+// Enhanced status bar with dynamic content
+void render_enhanced_status_bar() {
+    if (dirty_fields == 0) return;
+    
+    status_layout_t layout;
+    compute_layout(&layout);
+    bool full = dirty_fields == STATUS_FIELD_ALL;
+    
+    if (full) {
+        // Clear status bar area; fields erase back to this color
+        draw_filled_rect(0, 0, STATUS_BAR_WIDTH, STATUS_BAR_HEIGHT, STATUS_BAR_COLOR);
+        
+        // Left section: OS name and system info
+        draw_text(20, 35, "HASH OS", TEXT_COLOR);
+        
+        if (system_status.cpu_usage > 80) {
+            draw_text(20, 65, "CPU High", WARNING_COLOR);
+        }
+    }
+    
+    // Fields overlap their neighbours in places (MUTE runs into BT), and
+    // antialiased text can't be drawn twice over itself, so anything touching
+    // a field being erased is erased and repainted along with it
+    clip_rect_t rects[STATUS_FIELD_COUNT];
+    uint32_t repaint = dirty_fields;
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+        rects[i] = field_rect((status_field_t)(1u << i), &layout);
+    }
+    if (!full) {
+        bool grew = true;
+        while (grew) {
+            grew = false;
+            for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+                if (repaint & (1u << i)) continue;
+                for (int j = 0; j < STATUS_FIELD_COUNT; j++) {
+                    if ((repaint & (1u << j)) && rects_overlap(&rects[i], &rects[j])) {
+                        repaint |= 1u << i;
+                        grew = true;
+                        break;
+                    }
+                }
+            }
+        }
+        for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+            if (repaint & (1u << i)) {
+                draw_filled_rect(rects[i].x0, rects[i].y0, rects[i].x1 - rects[i].x0,
+                                 rects[i].y1 - rects[i].y0, STATUS_BAR_COLOR);
+            }
+        }
+    }
+    
+    // Center section: date; right section: time and icons
+    for (int i = 0; i < STATUS_FIELD_COUNT; i++) {
+        if (repaint & (1u << i)) draw_field((status_field_t)(1u << i), &layout);
+    }
+    dirty_fields = 0;
 }
 
 // Draw battery icon with level indicator
@@ -204,29 +315,72 @@ void draw_quick_toggle(int x, int y, const char* label, bool enabled) {
     draw_text(x + 10, y + 25, label, text_color);
 }
 
-// Update system status functions
+// Update system status functions; each marks its field only on a real change
 void update_battery_status(int level, bool charging) {
+    if (level == system_status.battery_level && charging == system_status.is_charging) return;
     system_status.battery_level = level;
     system_status.is_charging = charging;
+    dirty_fields |= STATUS_FIELD_BATTERY;
 }
 
 void update_time(int hour, int minute) {
+    if (hour == system_status.hour && minute == system_status.minute) return;
     system_status.hour = hour;
     system_status.minute = minute;
+    dirty_fields |= STATUS_FIELD_TIME;
 }
 
 void update_wifi_status(bool connected, int strength) {
+    if (connected == system_status.wifi_connected && strength == system_status.wifi_strength) return;
+    
+    // Showing or hiding the icon moves the ones to its left
+    dirty_fields |= connected != system_status.wifi_connected ? STATUS_FIELD_ALL : STATUS_FIELD_WIFI;
     system_status.wifi_connected = connected;
     system_status.wifi_strength = strength;
 }
 
 void update_volume(int level, bool silent) {
+    if (level == system_status.volume_level && silent == system_status.silent_mode) return;
     system_status.volume_level = level;
     system_status.silent_mode = silent;
+    dirty_fields |= STATUS_FIELD_VOLUME;
 }
 
 void set_date_string(const char* date) {
+    if (strcmp(date, system_status.date_string) == 0) return;
     snprintf(system_status.date_string, sizeof(system_status.date_string), "%s", date);
+    dirty_fields |= STATUS_FIELD_DATE;
+}
+
+void status_bar_tick(uint32_t now_ms) {
+    if (!clock_started) {
+        clock_started = true;
+        minute_start_ms = now_ms;
+        return;
+    }
+    
+    int minutes = 0;
+    while ((int32_t)(now_ms - minute_start_ms) >= 60000) {
+        minute_start_ms += 60000;
+        minutes++;
+    }
+    if (minutes == 0) return;
+    
+    int hour = system_status.hour;
+    int minute = system_status.minute + minutes;
+    while (minute >= 60) {
+        minute -= 60;
+        hour = hour == 23 ? 0 : hour + 1;
+    }
+    update_time(hour, minute);
+}
+
+uint32_t status_bar_dirty_fields() {
+    return dirty_fields;
+}
+
+void status_bar_invalidate() {
+    dirty_fields = STATUS_FIELD_ALL;
 }
 
 // Get current system status
@@ -244,5 +398,9 @@ void init_status_bar() {
     system_status.bluetooth_enabled = true;
     system_status.hour = 10;
     system_status.minute = 30;
+    system_status.volume_level = 70;
+    system_status.silent_mode = false;
     snprintf(system_status.date_string, sizeof(system_status.date_string), "Jan 1, 2025");
+    dirty_fields = STATUS_FIELD_ALL;
+    clock_started = false;
 }
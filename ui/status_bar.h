@@ -7,10 +7,22 @@
 // System status structure (forward declaration)
 typedef struct SystemStatus SystemStatus;
 
+// Parts of the enhanced bar that repaint on their own when their value changes
+typedef enum {
+    STATUS_FIELD_DATE      = 1 << 0,
+    STATUS_FIELD_TIME      = 1 << 1,
+    STATUS_FIELD_BATTERY   = 1 << 2,
+    STATUS_FIELD_WIFI      = 1 << 3,
+    STATUS_FIELD_BLUETOOTH = 1 << 4,
+    STATUS_FIELD_VOLUME    = 1 << 5,
+    STATUS_FIELD_ALL       = 0x3F       // Everything, background included
+} status_field_t;
+
 // Basic status bar functions
 void render_status_bar();
 
-// Enhanced status bar functions
+// Enhanced status bar functions. Only the fields changed since the last
+// render are repainted; the first render after init or invalidate draws all.
 void render_enhanced_status_bar();
 void render_notification_area();
 
@@ -28,8 +40,17 @@ void update_wifi_status(bool connected, int strength);
 void update_volume(int level, bool silent);
 void set_date_string(const char* date);
 
+// Advance the clock from a millisecond counter; the time field only
+// changes, and repaints, once a minute
+void status_bar_tick(uint32_t now_ms);
+
 // Status bar management
 void init_status_bar();
+uint32_t status_bar_dirty_fields();
+void status_bar_invalidate();           // Something else drew over the bar
+
+// Writes through this pointer don't mark anything dirty; call
+// status_bar_invalidate() after them
 SystemStatus* get_system_status();
 
 #endif // STATUS_BAR_H
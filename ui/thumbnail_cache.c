@@ -0,0 +1,425 @@
+#include "thumbnail_cache.h"
+#include "../kernel/timer.h"
+#include <string.h>
+
+#define THUMB_BUCKETS       128
+#define THUMB_CACHE_MAGIC   0x43485448  // "HTHC"
+#define THUMB_CACHE_VERSION 2         // 2: entries carry their path
+#define THUMB_BAND_ROWS     32        // Source rows decoded between budget checks
+
+enum {
+    THUMB_EMPTY = 0,
+    THUMB_QUEUED,
+    THUMB_READY,
+    THUMB_FAILED
+};
+
+typedef struct {
+    uint32_t hash;              // FNV-1a of the path, to find the bucket
+    uint64_t mtime;
+    uint32_t stamp;
+    uint8_t state;
+    int16_t prev, next;         // LRU list, most recently used at the head
+    int16_t chain;              // Next slot in the same hash bucket
+    char path[THUMB_PATH_MAX];  // The key: paths whose hashes collide stay apart
+} thumb_entry_t;
+
+static thumb_entry_t entries[THUMB_CACHE_SLOTS];
+static uint32_t thumb_pixels[THUMB_CACHE_SLOTS][THUMB_SIZE * THUMB_SIZE];
+static int16_t buckets[THUMB_BUCKETS];
+static int16_t lru_head = -1, lru_tail = -1;
+
+// FIFO of slots waiting for generation
+static int16_t queue[THUMB_QUEUE_SIZE];
+static int queue_head = 0, queue_count = 0;
+
+static uint32_t next_stamp = 1;
+static const thumbnail_source_t *source = NULL;
+static thumbnail_cache_stats_t stats;
+
+// Box-filter accumulator for the thumbnail being generated
+static struct {
+    uint32_t sum[THUMB_SIZE * THUMB_SIZE][4];   // Premultiplied R, G, B and alpha
+    uint16_t count[THUMB_SIZE * THUMB_SIZE];
+    int src_height;
+    int thumb_height;
+    int offset_x, offset_y;
+    uint8_t x_map[IMAGE_MAX_WIDTH];
+} acc;
+
+// The thumbnail being generated, kept across pumps. Its entry stays
+// THUMB_QUEUED (so it isn't evicted) but has left the queue.
+static struct {
+    int slot;                   // -1 when idle
+    bool open;                  // handle is open and the decode has begun
+    void *handle;
+} gen = { -1, false, NULL };
+
+static uint32_t hash_path(const char *path) {
+    uint32_t h = 2166136261u;
+    while (*path) {
+        h ^= (uint8_t)*path++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void lru_unlink(int i) {
+    thumb_entry_t *e = &entries[i];
+    if (e->prev >= 0) entries[e->prev].next = e->next; else lru_head = e->next;
+    if (e->next >= 0) entries[e->next].prev = e->prev; else lru_tail = e->prev;
+    e->prev = e->next = -1;
+}
+
+static void lru_push_head(int i) {
+    entries[i].prev = -1;
+    entries[i].next = lru_head;
+    if (lru_head >= 0) entries[lru_head].prev = (int16_t)i;
+    lru_head = (int16_t)i;
+    if (lru_tail < 0) lru_tail = (int16_t)i;
+}
+
+static void lru_touch(int i) {
+    if (lru_head == i) return;
+    lru_unlink(i);
+    lru_push_head(i);
+}
+
+static int bucket_find(uint32_t hash, const char *path) {
+    for (int i = buckets[hash % THUMB_BUCKETS]; i >= 0; i = entries[i].chain) {
+        thumb_entry_t *e = &entries[i];
+        if (e->hash == hash && e->state != THUMB_EMPTY && strcmp(e->path, path) == 0) return i;
+    }
+    return -1;
+}
+
+static void bucket_insert(int i) {
+    int b = entries[i].hash % THUMB_BUCKETS;
+    entries[i].chain = buckets[b];
+    buckets[b] = (int16_t)i;
+}
+
+static void bucket_remove(int i) {
+    int16_t *link = &buckets[entries[i].hash % THUMB_BUCKETS];
+    while (*link >= 0) {
+        if (*link == i) {
+            *link = entries[i].chain;
+            break;
+        }
+        link = &entries[*link].chain;
+    }
+    entries[i].chain = -1;
+}
+
+// Least recently used slot that isn't waiting in the queue, keyed to path
+// (shorter than THUMB_PATH_MAX)
+static int alloc_slot(uint32_t hash, const char *path) {
+    int i = lru_tail;
+    while (i >= 0 && entries[i].state == THUMB_QUEUED) {
+        i = entries[i].prev;
+    }
+    if (i < 0) return -1;
+
+    // An empty slot may still be chained from an aborted load
+    bucket_remove(i);
+    if (entries[i].state != THUMB_EMPTY) {
+        stats.evicted++;
+    }
+    entries[i].hash = hash;
+    entries[i].state = THUMB_EMPTY;
+    strcpy(entries[i].path, path);
+    bucket_insert(i);
+    return i;
+}
+
+// Drop the open file; the generation starts over on the next pump
+static void gen_close(void) {
+    if (gen.open) source->close(gen.handle);
+    gen.open = false;
+}
+
+void thumbnail_cache_init(void) {
+    gen_close();
+    gen.slot = -1;
+    memset(entries, 0, sizeof(entries));
+    memset(&stats, 0, sizeof(stats));
+    for (int b = 0; b < THUMB_BUCKETS; b++) buckets[b] = -1;
+
+    lru_head = lru_tail = -1;
+    for (int i = 0; i < THUMB_CACHE_SLOTS; i++) {
+        entries[i].chain = -1;
+        lru_push_head(i);
+    }
+    queue_head = queue_count = 0;
+}
+
+void thumbnail_cache_set_source(const thumbnail_source_t *src) {
+    gen_close();
+    source = src;
+}
+
+bool thumbnail_cache_get(const char *path, uint64_t mtime, thumbnail_t *out) {
+    // Too long to key an entry by: never cached
+    if (strlen(path) >= THUMB_PATH_MAX) {
+        stats.misses++;
+        return false;
+    }
+
+    uint32_t hash = hash_path(path);
+    int i = bucket_find(hash, path);
+
+    if (i >= 0 && entries[i].mtime == mtime) {
+        lru_touch(i);
+        if (entries[i].state != THUMB_READY) return false;
+        out->pixels = thumb_pixels[i];
+        out->stamp = entries[i].stamp;
+        stats.hits++;
+        return true;
+    }
+
+    stats.misses++;
+    if (i >= 0 && entries[i].state == THUMB_QUEUED) {
+        // Still waiting; it will read the file as it is now
+        if (i == gen.slot) gen_close();
+        entries[i].mtime = mtime;
+        lru_touch(i);
+        return false;
+    }
+
+    // Full queue: ask again next frame
+    if (queue_count >= THUMB_QUEUE_SIZE) return false;
+
+    if (i < 0) {
+        i = alloc_slot(hash, path);
+        if (i < 0) return false;
+    }
+
+    thumb_entry_t *e = &entries[i];
+    e->mtime = mtime;
+    e->state = THUMB_QUEUED;
+    lru_touch(i);
+
+    queue[(queue_head + queue_count) % THUMB_QUEUE_SIZE] = (int16_t)i;
+    queue_count++;
+    return false;
+}
+
+// Fit the image inside the thumbnail, preserving aspect ratio
+static int thumb_begin(void *ctx, int width, int height) {
+    (void)ctx;
+    int tw, th;
+    if (width >= height) {
+        tw = THUMB_SIZE;
+        th = height * THUMB_SIZE / width;
+        if (th < 1) th = 1;
+    } else {
+        th = THUMB_SIZE;
+        tw = width * THUMB_SIZE / height;
+        if (tw < 1) tw = 1;
+    }
+
+    memset(acc.sum, 0, sizeof(acc.sum));
+    memset(acc.count, 0, sizeof(acc.count));
+    acc.src_height = height;
+    acc.thumb_height = th;
+    acc.offset_x = (THUMB_SIZE - tw) / 2;
+    acc.offset_y = (THUMB_SIZE - th) / 2;
+    for (int x = 0; x < width; x++) {
+        acc.x_map[x] = (uint8_t)(x * tw / width);
+    }
+    return 0;
+}
+
+// Rows may arrive in any order; each is averaged into the cells it covers
+static void thumb_row(void *ctx, int y, const uint32_t *pixels, int width) {
+    (void)ctx;
+    int ty = y * acc.thumb_height / acc.src_height;
+    int base = (acc.offset_y + ty) * THUMB_SIZE + acc.offset_x;
+
+    for (int x = 0; x < width; x++) {
+        uint32_t p = pixels[x];
+        uint32_t a = p >> 24;
+        uint32_t *sum = acc.sum[base + acc.x_map[x]];
+        sum[0] += ((p >> 16) & 0xFF) * a;
+        sum[1] += ((p >> 8) & 0xFF) * a;
+        sum[2] += (p & 0xFF) * a;
+        sum[3] += a;
+        acc.count[base + acc.x_map[x]]++;
+    }
+}
+
+// Resolve the averages over the background into framebuffer format
+static void thumb_finish(uint32_t *dst) {
+    for (int i = 0; i < THUMB_SIZE * THUMB_SIZE; i++) {
+        uint32_t n = acc.count[i];
+        if (n == 0) {
+            dst[i] = THUMB_BACKGROUND;
+            continue;
+        }
+
+        uint32_t a = acc.sum[i][3] / n;
+        uint32_t out = 0;
+        for (int c = 0; c < 3; c++) {
+            uint32_t bg = (THUMB_BACKGROUND >> (16 - c * 8)) & 0xFF;
+            uint32_t v = (acc.sum[i][c] / n + bg * (255 - a)) / 255;
+            out |= v << (16 - c * 8);
+        }
+        dst[i] = out;
+    }
+}
+
+static const image_sink_t gen_sink = { thumb_begin, thumb_row, NULL };
+
+// Decode one band of the current generation; IMAGE_MORE until it's done
+static int generate_band(void) {
+    if (!gen.open) {
+        if (!source || source->open(entries[gen.slot].path, &gen.handle) != 0) {
+            return IMAGE_ERR_IO;
+        }
+        gen.open = true;
+        int result = image_decode_begin(source->read, gen.handle, &gen_sink);
+        return result == IMAGE_OK ? IMAGE_MORE : result;
+    }
+
+    int result = image_decode_rows(&gen_sink, THUMB_BAND_ROWS);
+    if (result == IMAGE_ERR_ABORTED) {
+        // Another decode (a wallpaper, say) reused the decoder in between
+        gen_close();
+        return IMAGE_MORE;
+    }
+    return result;
+}
+
+static void generate_finish(int result) {
+    thumb_entry_t *e = &entries[gen.slot];
+    gen_close();
+
+    if (result == IMAGE_OK) {
+        thumb_finish(thumb_pixels[gen.slot]);
+        e->state = THUMB_READY;
+        e->stamp = next_stamp++;
+        stats.generated++;
+    } else {
+        // Remembered so a broken file isn't retried every frame
+        e->state = THUMB_FAILED;
+        stats.failed++;
+    }
+    gen.slot = -1;
+}
+
+int thumbnail_cache_pump(uint32_t budget_us) {
+    if (budget_us == 0) return 0;
+
+    uint32_t start = timer_now_us();
+    int processed = 0;
+
+    while (timer_diff(timer_now_us(), start) < (int32_t)budget_us) {
+        if (gen.slot < 0) {
+            if (queue_count == 0) break;
+            gen.slot = queue[queue_head];
+            queue_head = (queue_head + 1) % THUMB_QUEUE_SIZE;
+            queue_count--;
+        }
+
+        int result = generate_band();
+        if (result != IMAGE_MORE) {
+            generate_finish(result);
+            processed++;
+        }
+    }
+    return processed;
+}
+
+static int write_u32(thumbnail_write_fn write, void *ctx, uint32_t v) {
+    return write(ctx, (const uint8_t *)&v, 4) == 4 ? 0 : -1;
+}
+
+// Ready thumbnails, least recently used first so a load restores the order
+int thumbnail_cache_save(thumbnail_write_fn write, void *ctx) {
+    uint32_t count = 0;
+    for (int i = lru_tail; i >= 0; i = entries[i].prev) {
+        if (entries[i].state == THUMB_READY) count++;
+    }
+
+    if (write_u32(write, ctx, THUMB_CACHE_MAGIC) || write_u32(write, ctx, THUMB_CACHE_VERSION) ||
+        write_u32(write, ctx, THUMB_SIZE) || write_u32(write, ctx, count)) {
+        return -1;
+    }
+
+    for (int i = lru_tail; i >= 0; i = entries[i].prev) {
+        thumb_entry_t *e = &entries[i];
+        if (e->state != THUMB_READY) continue;
+
+        int bytes = (int)sizeof(thumb_pixels[i]);
+        int path_len = (int)strlen(e->path);
+        if (write_u32(write, ctx, (uint32_t)path_len) ||
+            write_u32(write, ctx, (uint32_t)e->mtime) ||
+            write_u32(write, ctx, (uint32_t)(e->mtime >> 32)) ||
+            write(ctx, (const uint8_t *)e->path, path_len) != path_len ||
+            write(ctx, (const uint8_t *)thumb_pixels[i], bytes) != bytes) {
+            return -1;
+        }
+    }
+    return (int)count;
+}
+
+static int read_full(image_read_fn read, void *ctx, void *dst, int len) {
+    uint8_t *p = (uint8_t *)dst;
+    while (len > 0) {
+        int n = read(ctx, p, len);
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+int thumbnail_cache_load(image_read_fn read, void *ctx) {
+    uint32_t header[4];
+    if (read_full(read, ctx, header, sizeof(header)) != 0) return -1;
+    if (header[0] != THUMB_CACHE_MAGIC || header[1] != THUMB_CACHE_VERSION ||
+        header[2] != THUMB_SIZE) {
+        return -1;
+    }
+
+    int loaded = 0;
+    for (uint32_t n = 0; n < header[3]; n++) {
+        uint32_t key[3];
+        char path[THUMB_PATH_MAX];
+        if (read_full(read, ctx, key, sizeof(key)) != 0) break;
+        if (key[0] >= THUMB_PATH_MAX || read_full(read, ctx, path, (int)key[0]) != 0) break;
+        path[key[0]] = '\0';
+
+        uint64_t mtime = key[1] | ((uint64_t)key[2] << 32);
+        uint32_t hash = hash_path(path);
+        int i = bucket_find(hash, path);
+        if (i >= 0 && entries[i].state == THUMB_QUEUED) {
+            // Generation already pending; skip the stored copy
+            uint32_t discard[THUMB_SIZE];
+            int ok = 0;
+            for (int row = 0; row < THUMB_SIZE && ok == 0; row++) {
+                ok = read_full(read, ctx, discard, sizeof(discard));
+            }
+            if (ok != 0) break;
+            continue;
+        }
+        if (i < 0) i = alloc_slot(hash, path);
+        if (i < 0) break;
+
+        if (read_full(read, ctx, thumb_pixels[i], sizeof(thumb_pixels[i])) != 0) {
+            entries[i].state = THUMB_EMPTY;
+            break;
+        }
+        entries[i].mtime = mtime;
+        entries[i].state = THUMB_READY;
+        entries[i].stamp = next_stamp++;
+        lru_touch(i);
+        loaded++;
+    }
+    return loaded;
+}
+
+void thumbnail_cache_get_stats(thumbnail_cache_stats_t *out) {
+    *out = stats;
+    out->queued = (uint32_t)queue_count + (gen.slot >= 0 ? 1 : 0);
+}
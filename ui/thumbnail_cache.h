@@ -0,0 +1,61 @@
+#ifndef THUMBNAIL_CACHE_H
+#define THUMBNAIL_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../drivers/image_decoder.h"
+
+// Thumbnails are square, letterboxed onto THUMB_BACKGROUND
+#define THUMB_SIZE          60
+#define THUMB_CACHE_SLOTS   64
+#define THUMB_QUEUE_SIZE    32
+#define THUMB_PATH_MAX      256
+#define THUMB_BACKGROUND    0x555555
+
+// Hidden file the cache can be persisted to
+#define THUMB_CACHE_FILE    ".thumbcache"
+
+// A ready thumbnail; `stamp` changes whenever a slot gets new pixels
+typedef struct {
+    const uint32_t *pixels;     // THUMB_SIZE x THUMB_SIZE, framebuffer format
+    uint32_t stamp;
+} thumbnail_t;
+
+// Where image bytes come from
+typedef struct {
+    int (*open)(const char *path, void **handle);   // 0 on success
+    image_read_fn read;
+    void (*close)(void *handle);
+} thumbnail_source_t;
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t generated;
+    uint32_t failed;
+    uint32_t evicted;
+    uint32_t queued;            // Waiting for or in generation
+} thumbnail_cache_stats_t;
+
+// Persistence writer: returns bytes written or <0 on error
+typedef int (*thumbnail_write_fn)(void *ctx, const uint8_t *buf, int len);
+
+void thumbnail_cache_init(void);
+void thumbnail_cache_set_source(const thumbnail_source_t *source);
+
+// Look up the thumbnail for (path, mtime). A miss queues the file for
+// background generation and returns false; draw a placeholder meanwhile.
+bool thumbnail_cache_get(const char *path, uint64_t mtime, thumbnail_t *out);
+
+// Generate queued thumbnails while budget_us remains; returns how many were made.
+// Images are decoded a band of rows at a time, so a call overruns the budget
+// by at most one band; a half-done thumbnail carries on in the next call.
+int thumbnail_cache_pump(uint32_t budget_us);
+
+// Save ready thumbnails / load them back (e.g. from THUMB_CACHE_FILE)
+int thumbnail_cache_save(thumbnail_write_fn write, void *ctx);
+int thumbnail_cache_load(image_read_fn read, void *ctx);
+
+void thumbnail_cache_get_stats(thumbnail_cache_stats_t *stats);
+
+#endif // THUMBNAIL_CACHE_H
@@ -1,40 +1,9 @@
 #include "touch_feedback.h"
+#include "effect_pool.h"
 #include "../drivers/display4k.h"
-#include "../drivers/audio_output.h"
 #include <stdint.h>
 #include <stdbool.h>
-#include <string.h>
 
-// Touch feedback configuration
-#define MAX_TOUCH_EFFECTS 10
-#define RIPPLE_MAX_RADIUS 50
-#define RIPPLE_DURATION 30  // frames
-#define FADE_DURATION 20    // frames
-
-// Touch feedback types
-typedef enum {
-    TOUCH_NORMAL,
-    TOUCH_BUTTON,
-    TOUCH_LONG_PRESS,
-    TOUCH_DRAG,
-    TOUCH_ERROR,
-    TOUCH_SUCCESS
-} TouchFeedbackType;
-
-// Touch effect structure
-typedef struct {
-    int x, y;                    // Position
-    int current_radius;          // Current ripple radius
-    int max_radius;             // Maximum ripple radius
-    int duration;               // Frames remaining
-    uint32_t color;             // Effect color
-    TouchFeedbackType type;     // Type of feedback
-    bool active;                // Is effect active
-    int alpha;                  // Transparency (0-255)
-} TouchEffect;
-
-// Global touch effects array
-static TouchEffect touch_effects[MAX_TOUCH_EFFECTS];
 static bool feedback_enabled = true;
 static bool haptic_enabled = true;
 static bool sound_enabled = true;
@@ -53,66 +22,45 @@ void show_touch_feedback(int x, int y) {
     play_touch_sound();
 }
 
-// Enhanced touch feedback with different types
+// How each feedback type looks. Ripples grow from 5px to `radius` at the old
+// 2px-per-frame pace (60 Hz) and fade over the last two thirds of the effect.
+typedef struct {
+    effect_kind_t kind;
+    int radius;
+    int thickness;
+    uint32_t color;
+    uint32_t duration_ms;
+} touch_effect_style_t;
+
+static const touch_effect_style_t touch_styles[] = {
+    [TOUCH_NORMAL]     = { EFFECT_RING,         30, 3, COLOR_NORMAL,  220 },
+    [TOUCH_BUTTON]     = { EFFECT_RING,         25, 3, COLOR_BUTTON,  180 },
+    [TOUCH_LONG_PRESS] = { EFFECT_DOUBLE_RING,  40, 2, COLOR_LONG,    310 },
+    [TOUCH_DRAG]       = { EFFECT_DOT,          20, 0, COLOR_DRAG,    130 },
+    [TOUCH_ERROR]      = { EFFECT_JITTER_RING,  35, 4, COLOR_ERROR,   270 },
+    [TOUCH_SUCCESS]    = { EFFECT_SPARKLE_RING, 40, 3, COLOR_SUCCESS, 310 },
+};
+
+// Enhanced touch feedback with different types. The ripple lives in the
+// shared effect pool and is drawn with the animations, so a burst of taps
+// replaces the oldest ripple instead of being dropped.
 void show_enhanced_touch_feedback(int x, int y, TouchFeedbackType type) {
     if (!feedback_enabled) return;
+    if ((unsigned)type >= sizeof(touch_styles) / sizeof(touch_styles[0])) return;
     
-    // Find available effect slot
-    int slot = find_available_effect_slot();
-    if (slot == -1) return;
-    
-    // Initialize the effect
-    TouchEffect* effect = &touch_effects[slot];
-    effect->x = x;
-    effect->y = y;
-    effect->current_radius = 5;
-    effect->type = type;
-    effect->active = true;
-    effect->alpha = 255;
+    const touch_effect_style_t *style = &touch_styles[type];
+    effect_spawn(style->kind, x, y, style->radius, style->thickness,
+                 style->color, style->duration_ms, EFFECT_FADE_OUT);
     
-    // Set type-specific properties
-    switch (type) {
-        case TOUCH_NORMAL:
-            effect->max_radius = 30;
-            effect->duration = RIPPLE_DURATION;
-            effect->color = COLOR_NORMAL;
-            if (sound_enabled) play_touch_sound();
-            break;
-            
-        case TOUCH_BUTTON:
-            effect->max_radius = 25;
-            effect->duration = RIPPLE_DURATION - 10;
-            effect->color = COLOR_BUTTON;
-            if (sound_enabled) play_button_sound();
-            break;
-            
-        case TOUCH_LONG_PRESS:
-            effect->max_radius = 40;
-            effect->duration = RIPPLE_DURATION + 10;
-            effect->color = COLOR_LONG;
-            if (sound_enabled) play_long_press_sound();
-            break;
-            
-        case TOUCH_DRAG:
-            effect->max_radius = 20;
-            effect->duration = RIPPLE_DURATION - 15;
-            effect->color = COLOR_DRAG;
-            // No sound for drag to avoid continuous noise
-            break;
-            
-        case TOUCH_ERROR:
-            effect->max_radius = 35;
-            effect->duration = RIPPLE_DURATION + 5;
-            effect->color = COLOR_ERROR;
-            if (sound_enabled) play_error_sound();
-            break;
-            
-        case TOUCH_SUCCESS:
-            effect->max_radius = 40;
-            effect->duration = RIPPLE_DURATION + 10;
-            effect->color = COLOR_SUCCESS;
-            if (sound_enabled) play_success_sound();
-            break;
+    if (sound_enabled) {
+        switch (type) {
+            case TOUCH_NORMAL:     play_touch_sound(); break;
+            case TOUCH_BUTTON:     play_button_sound(); break;
+            case TOUCH_LONG_PRESS: play_long_press_sound(); break;
+            case TOUCH_ERROR:      play_error_sound(); break;
+            case TOUCH_SUCCESS:    play_success_sound(); break;
+            case TOUCH_DRAG:       break;   // No sound for drag to avoid continuous noise
+        }
     }
     
     // Trigger haptic feedback if enabled
@@ -121,152 +69,9 @@ void show_enhanced_touch_feedback(int x, int y, TouchFeedbackType type) {
     }
 }
 
-// Update and render all active touch effects
-void update_touch_effects() {
-    for (int i = 0; i < MAX_TOUCH_EFFECTS; i++) {
-        TouchEffect* effect = &touch_effects[i];
-        
-        if (!effect->active) continue;
-        
-        // Update effect animation
-        effect->duration--;
-        effect->current_radius += 2;
-        
-        // Fade out effect
-        if (effect->duration < FADE_DURATION) {
-            effect->alpha = (effect->duration * 255) / FADE_DURATION;
-        }
-        
-        // Render the effect
-        render_touch_effect(effect);
-        
-        // Deactivate finished effects
-        if (effect->duration <= 0 || effect->current_radius > effect->max_radius) {
-            effect->active = false;
-        }
-    }
-}
-
-// Render a single touch effect
-void render_touch_effect(TouchEffect* effect) {
-    if (!effect->active) return;
-    
-    // Calculate color with alpha
-    uint32_t render_color = apply_alpha(effect->color, effect->alpha);
-    
-    switch (effect->type) {
-        case TOUCH_NORMAL:
-        case TOUCH_BUTTON:
-            // Simple expanding circle
-            draw_circle_outline(effect->x, effect->y, effect->current_radius, render_color, 3);
-            break;
-            
-        case TOUCH_LONG_PRESS:
-            // Double circle for long press
-            draw_circle_outline(effect->x, effect->y, effect->current_radius, render_color, 2);
-            draw_circle_outline(effect->x, effect->y, effect->current_radius - 10, render_color, 2);
-            break;
-            
-        case TOUCH_DRAG:
-            // Small filled circle for drag
-            draw_circle(effect->x, effect->y, effect->current_radius / 2, render_color);
-            break;
-            
-        case TOUCH_ERROR:
-            // Pulsing red circle
-            int pulse_radius = effect->current_radius + (effect->duration % 6) - 3;
-            draw_circle_outline(effect->x, effect->y, pulse_radius, render_color, 4);
-            break;
-            
-        case TOUCH_SUCCESS:
-            // Expanding green circle with sparkle effect
-            draw_circle_outline(effect->x, effect->y, effect->current_radius, render_color, 3);
-            draw_sparkle_effect(effect->x, effect->y, effect->current_radius);
-            break;
-    }
-}
-
-// Find available effect slot
-int find_available_effect_slot() {
-    for (int i = 0; i < MAX_TOUCH_EFFECTS; i++) {
-        if (!touch_effects[i].active) {
-            return i;
-        }
-    }
-    return -1; // No available slots
-}
-
 // Apply alpha transparency to color
 uint32_t apply_alpha(uint32_t color, int alpha) {
-    // Simple alpha blending (you might want to implement proper alpha blending)
-    if (alpha < 128) {
-        // Fade to darker version
-        uint32_t r = ((color >> 16) & 0xFF) * alpha / 255;
-        uint32_t g = ((color >> 8) & 0xFF) * alpha / 255;
-        uint32_t b = (color & 0xFF) * alpha / 255;
-        return (r << 16) | (g << 8) | b;
-    }
-    return color;
-}
-
-// Draw circle outline with thickness
-void draw_circle_outline(int cx, int cy, int radius, uint32_t color, int thickness) {
-    for (int t = 0; t < thickness; t++) {
-        // Draw multiple circles for thickness
-        draw_circle_border(cx, cy, radius - t, color);
-    }
-}
-
-// Draw circle border (single pixel width)
-void draw_circle_border(int cx, int cy, int radius, uint32_t color) {
-    // Bresenham's circle algorithm for outline
-    int x = 0;
-    int y = radius;
-    int d = 3 - 2 * radius;
-    
-    while (y >= x) {
-        // Draw 8 points for each calculated point
-        draw_pixel(cx + x, cy + y, color);
-        draw_pixel(cx - x, cy + y, color);
-        draw_pixel(cx + x, cy - y, color);
-        draw_pixel(cx - x, cy - y, color);
-        draw_pixel(cx + y, cy + x, color);
-        draw_pixel(cx - y, cy + x, color);
-        draw_pixel(cx + y, cy - x, color);
-        draw_pixel(cx - y, cy - x, color);
-        
-        x++;
-        if (d > 0) {
-            y--;
-            d = d + 4 * (x - y) + 10;
-        } else {
-            d = d + 4 * x + 6;
-        }
-    }
-}
-
-// Draw sparkle effect for success feedback
-void draw_sparkle_effect(int cx, int cy, int radius) {
-    // Draw small sparkles around the circle
-    for (int i = 0; i < 8; i++) {
-        int angle = i * 45; // 8 sparkles, 45 degrees apart
-        int sparkle_x = cx + (radius * cos_lookup(angle)) / 256;
-        int sparkle_y = cy + (radius * sin_lookup(angle)) / 256;
-        draw_pixel(sparkle_x, sparkle_y, COLOR_SUCCESS);
-        draw_pixel(sparkle_x + 1, sparkle_y, COLOR_SUCCESS);
-        draw_pixel(sparkle_x, sparkle_y + 1, COLOR_SUCCESS);
-    }
-}
-
-// Simple lookup tables for cos/sin (you might want to implement proper trig functions)
-int cos_lookup(int angle) {
-    static const int cos_table[] = {256, 181, 0, -181, -256, -181, 0, 181};
-    return cos_table[(angle / 45) % 8];
-}
-
-int sin_lookup(int angle) {
-    static const int sin_table[] = {0, 181, 256, 181, 0, -181, -256, -181};
-    return sin_table[(angle / 45) % 8];
+    return effect_fade_color(color, alpha);
 }
 
 // Audio feedback functions (implement based on your audio system)
@@ -331,9 +136,6 @@ void set_sound_enabled(bool enabled) {
 
 // Initialize touch feedback system
 void init_touch_feedback() {
-    // Clear all effects
-    memset(touch_effects, 0, sizeof(touch_effects));
-    
     // Set default settings
     feedback_enabled = true;
     haptic_enabled = true;
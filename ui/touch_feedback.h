@@ -14,15 +14,13 @@ typedef enum {
     TOUCH_SUCCESS
 } TouchFeedbackType;
 
-// Touch effect structure (forward declaration)
-typedef struct TouchEffect TouchEffect;
-
 // Basic touch feedback (your original function)
 void show_touch_feedback(int x, int y);
+void play_touch_sound();
 
-// Enhanced touch feedback functions
+// Enhanced touch feedback functions. Effects are spawned into the shared
+// effect pool and drawn by update_animations()/draw_animations().
 void show_enhanced_touch_feedback(int x, int y, TouchFeedbackType type);
-void update_touch_effects();
 
 // Convenience functions for common feedback types
 void show_button_feedback(int x, int y);
@@ -30,12 +28,6 @@ void show_error_feedback(int x, int y);
 void show_success_feedback(int x, int y);
 void show_drag_feedback(int x, int y);
 
-// Effect rendering functions
-void render_touch_effect(TouchEffect* effect);
-void draw_circle_outline(int cx, int cy, int radius, uint32_t color, int thickness);
-void draw_circle_border(int cx, int cy, int radius, uint32_t color);
-void draw_sparkle_effect(int cx, int cy, int radius);
-
 // Audio feedback functions
 void play_button_sound();
 void play_long_press_sound();
@@ -50,10 +42,7 @@ void haptic_double_tap();
 void haptic_success_pattern();
 
 // Utility functions
-int find_available_effect_slot();
 uint32_t apply_alpha(uint32_t color, int alpha);
-int cos_lookup(int angle);
-int sin_lookup(int angle);
 
 // Settings functions
 void set_feedback_enabled(bool enabled);
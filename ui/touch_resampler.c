@@ -0,0 +1,73 @@
+// touch_resampler.c - touch positions resampled to frame present time
+#include "touch_resampler.h"
+#include "../kernel/timer.h"
+
+void touch_resampler_reset(touch_resampler_t *r) {
+    r->count = 0;
+    r->next = 0;
+}
+
+void touch_resampler_add(touch_resampler_t *r, const touch_sample_t *touch) {
+    r->x[r->next] = touch->x;
+    r->y[r->next] = touch->y;
+    r->time_us[r->next] = touch->time_us;
+    r->next = (r->next + 1) % RESAMPLE_HISTORY;
+    if (r->count < RESAMPLE_HISTORY) r->count++;
+}
+
+// Index of the k-th newest sample (0 = newest)
+static int nth_newest(const touch_resampler_t *r, int k) {
+    return (r->next + RESAMPLE_HISTORY - 1 - k) % RESAMPLE_HISTORY;
+}
+
+// Point on the line through samples a and b at time t
+static void lerp(const touch_resampler_t *r, int a, int b, int32_t t, int *x, int *y) {
+    int32_t span = timer_diff(r->time_us[b], r->time_us[a]);
+    if (span <= 0) {
+        *x = r->x[b];
+        *y = r->y[b];
+        return;
+    }
+    // Keep (x[b] - x[a]) * t within int32: a 16-bit delta leaves 15 bits for
+    // the time, so scale long gaps down to that (no 64-bit divide here)
+    while (t > 0x7FFF || span > 0x7FFF) {
+        t >>= 1;
+        span >>= 1;
+    }
+    *x = r->x[a] + (r->x[b] - r->x[a]) * t / span;
+    *y = r->y[a] + (r->y[b] - r->y[a]) * t / span;
+}
+
+bool touch_resampler_sample(const touch_resampler_t *r, uint32_t target_us, int *x, int *y) {
+    if (r->count == 0) return false;
+
+    int newest = nth_newest(r, 0);
+    *x = r->x[newest];
+    *y = r->y[newest];
+    if (r->count == 1) return true;
+
+    int32_t ahead = timer_diff(target_us, r->time_us[newest]);
+    if (ahead > 0) {
+        int prev = nth_newest(r, 1);
+        int32_t span = timer_diff(r->time_us[newest], r->time_us[prev]);
+        // No new samples for a while means the finger stopped, not that it's fast
+        if (ahead > RESAMPLE_STALE_US || span > RESAMPLE_STALE_US) return true;
+        if (ahead > RESAMPLE_MAX_PREDICT_US) ahead = RESAMPLE_MAX_PREDICT_US;
+        lerp(r, prev, newest, span + ahead, x, y);
+        return true;
+    }
+
+    // Between two samples we already have
+    for (int k = 1; k < r->count; k++) {
+        int older = nth_newest(r, k);
+        int32_t t = timer_diff(target_us, r->time_us[older]);
+        if (t >= 0) {
+            lerp(r, older, nth_newest(r, k - 1), t, x, y);
+            return true;
+        }
+    }
+    int oldest = nth_newest(r, r->count - 1);
+    *x = r->x[oldest];
+    *y = r->y[oldest];
+    return true;
+}
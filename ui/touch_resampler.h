@@ -0,0 +1,31 @@
+#ifndef TOUCH_RESAMPLER_H
+#define TOUCH_RESAMPLER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../input/touch.h"
+
+#define RESAMPLE_HISTORY          4
+#define RESAMPLE_MAX_PREDICT_US   16000     // Extrapolate at most one 60 Hz frame ahead
+#define RESAMPLE_STALE_US         50000     // Older motion than this means the finger is resting
+
+// Recent positions of one contact, for estimating where it is at another time
+typedef struct {
+    int16_t x[RESAMPLE_HISTORY];
+    int16_t y[RESAMPLE_HISTORY];
+    uint32_t time_us[RESAMPLE_HISTORY];
+    int count;
+    int next;
+} touch_resampler_t;
+
+void touch_resampler_reset(touch_resampler_t *r);
+
+// Add a sample of the tracked contact, in timestamp order
+void touch_resampler_add(touch_resampler_t *r, const touch_sample_t *touch);
+
+// Position at target_us (e.g. frame_pacer_next_present_us()). Times between
+// samples are interpolated; later times are extrapolated from the last two
+// samples, at most RESAMPLE_MAX_PREDICT_US ahead. False with no samples.
+bool touch_resampler_sample(const touch_resampler_t *r, uint32_t target_us, int *x, int *y);
+
+#endif // TOUCH_RESAMPLER_H
@@ -6,6 +6,9 @@
 #include "drivers/touch_input.h"
 #include "drivers/virtual_keyboard.h"
 #include "launcher.h"
+#include "frame_pacer.h"
+#include "latency.h"
+#include "drivers/serial.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -86,17 +89,16 @@ void render_home_screen(void) {
     draw_filled_rectangle(0, 0, SCREEN_WIDTH, 60, COLOR_BLACK);
     draw_string(20, 20, "Home Screen", COLOR_WHITE);
     
-    // Draw frame counter (for debugging)
-    char frame_str[32];
-    snprintf(frame_str, sizeof(frame_str), "Frame: %u", g_ui_context.frame_count);
-    draw_string(SCREEN_WIDTH - 200, 20, frame_str, COLOR_GREEN);
+    // Draw frame time overlay (for debugging)
+    draw_frame_stats_hud(SCREEN_WIDTH - 380, 6);
+    draw_latency_hud(SCREEN_WIDTH - 380, 60);
     
     // Draw launcher icons
     draw_launcher_icons();
     
     // Draw virtual keyboard if visible
     if (is_virtual_keyboard_visible()) {
-        render_virtual_keyboard();
+        draw_virtual_keyboard();
     }
     
     // Refresh display
@@ -105,13 +107,20 @@ void render_home_screen(void) {
 }
 
 // Handle touch inputs at UI level
-void handle_touch_event(int x, int y) {
+void handle_touch_event(const touch_sample_t *sample) {
     if (!g_ui_context.is_initialized) return;
     
-    // Validate coordinates
-    if (x < 0 || y < 0 || x >= SCREEN_WIDTH || y >= SCREEN_HEIGHT) {
-        return;
-    }
+    // Tag the frame being built with this input's arrival time
+    latency_input_dispatched(sample->time_us);
+    
+    // Clamp rather than drop: a finger lifted past the edge must still end
+    // its contact, or the launcher's gestures see it held down forever
+    touch_sample_t clamped = *sample;
+    const touch_sample_t *touch = &clamped;
+    int x = clamped.x, y = clamped.y;
+    touch_clamp_to_screen(&x, &y);
+    clamped.x = (int16_t)x;
+    clamped.y = (int16_t)y;
     
     // Store last touch position
     g_ui_context.last_touch_x = x;
@@ -122,14 +131,15 @@ void handle_touch_event(int x, int y) {
         case UI_STATE_HOME:
             // Check if virtual keyboard is visible first
             if (is_virtual_keyboard_visible()) {
-                // Handle virtual keyboard touch
-                char key = get_virtual_key();
+                // Keys fire once, when the finger lands; only the key under
+                // the finger is repainted for the highlight
+                char key = virtual_keyboard_touch(touch, NULL);
                 if (key != 0) {
                     handle_keypress_event(key);
                 }
             } else {
                 // Handle launcher touch
-                handle_launcher_touch(x, y);
+                handle_launcher_touch(touch);
             }
             break;
             
@@ -198,18 +208,16 @@ void ui_main_loop(void) {
     
     printf("Starting UI main loop...\n");
     
-    int touch_x = -1, touch_y = -1;
+    touch_sample_t touches[TOUCH_QUEUE_SIZE];
     
     while (g_ui_context.current_state != UI_STATE_SHUTDOWN) {
-        // Handle touch input
-        if (get_touch_input(&touch_x, &touch_y)) {
-            handle_touch_event(touch_x, touch_y);
-        }
+        frame_pacer_begin_frame();
         
-        // Handle keyboard input
-        char key = get_virtual_key();
-        if (key != 0) {
-            handle_keypress_event(key);
+        // Handle every touch queued since the last frame, not just where the
+        // finger is now; drags arrive already coalesced to one move
+        int touch_count = touch_input_drain(touches, TOUCH_QUEUE_SIZE);
+        for (int i = 0; i < touch_count; i++) {
+            handle_touch_event(&touches[i]);
         }
         
         // Render current screen based on state
@@ -230,9 +238,11 @@ void ui_main_loop(void) {
                 break;
         }
         
-        // Small delay to prevent excessive CPU usage
-        // In a real system, this would be replaced with proper event handling
-        usleep(16666); // ~60 FPS (16.67ms delay)
+        // Wait for the next retrace (or timer deadline) instead of spinning
+        frame_pacer_end_frame();
+        
+        // Trickle out queued debug output (latency reports) without stalling
+        serial_pump();
     }
     
     printf("UI main loop ended\n");
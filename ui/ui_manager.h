@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "../input/touch.h"
 
 // Screen dimensions (4K resolution)
 #define SCREEN_WIDTH 3840
@@ -40,7 +41,7 @@ typedef struct {
 bool init_ui(void);
 void cleanup_ui(void);
 void render_home_screen(void);
-void handle_touch_event(int x, int y);
+void handle_touch_event(const touch_sample_t *touch);
 void handle_keypress_event(char key);
 void ui_main_loop(void);
 void set_ui_state(ui_state_t new_state);
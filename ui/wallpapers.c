@@ -1,7 +1,116 @@
+#include <stdint.h>
+#include <stdbool.h>
 #include "wallpapers.h"
 #include "../drivers/display4k.h"
 
+// Wallpaper pre-scaled to the screen and pre-converted to framebuffer format
+static uint32_t wallpaper_pixels[SCREEN_WIDTH * SCREEN_HEIGHT];
+static bool wallpaper_valid = false;
+static uint32_t generation = 0;
+
+// Cover-fit mapping from the decoded image to the screen
+static struct {
+    int src_width, src_height;
+    int crop_x, crop_y;         // Top-left of the visible source area
+    int vis_width, vis_height;  // Size of the visible source area
+    uint16_t x_map[SCREEN_WIDTH];
+} scaler;
+
+// Blend a decoded ARGB pixel over the default color and drop alpha
+static inline uint32_t to_framebuffer(uint32_t argb) {
+    uint32_t a = argb >> 24;
+    if (a == 0xFF) return argb & 0x00FFFFFF;
+
+    uint32_t out = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        uint32_t s = (argb >> shift) & 0xFF;
+        uint32_t d = (WALLPAPER_DEFAULT_COLOR >> shift) & 0xFF;
+        out |= ((s * a + d * (255 - a) + 127) / 255) << shift;
+    }
+    return out;
+}
+
+static int scaler_begin(void *ctx, int width, int height) {
+    (void)ctx;
+    scaler.src_width = width;
+    scaler.src_height = height;
+
+    // Scale so the image covers the screen, cropping the excess evenly
+    if (width * SCREEN_HEIGHT > height * SCREEN_WIDTH) {
+        scaler.vis_height = height;
+        scaler.vis_width = height * SCREEN_WIDTH / SCREEN_HEIGHT;
+        if (scaler.vis_width < 1) scaler.vis_width = 1;
+    } else {
+        scaler.vis_width = width;
+        scaler.vis_height = width * SCREEN_HEIGHT / SCREEN_WIDTH;
+        if (scaler.vis_height < 1) scaler.vis_height = 1;
+    }
+    scaler.crop_x = (width - scaler.vis_width) / 2;
+    scaler.crop_y = (height - scaler.vis_height) / 2;
+
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        scaler.x_map[x] = (uint16_t)(scaler.crop_x + x * scaler.vis_width / SCREEN_WIDTH);
+    }
+    return 0;
+}
+
+// Rows may arrive in any order (BMP is bottom-up); each source row fills
+// the run of screen rows that map to it (nearest neighbour)
+static void scaler_row(void *ctx, int y, const uint32_t *pixels, int width) {
+    (void)ctx;
+    (void)width;
+    int sy = y - scaler.crop_y;
+    if (sy < 0 || sy >= scaler.vis_height) return;
+
+    int dy0 = (sy * SCREEN_HEIGHT + scaler.vis_height - 1) / scaler.vis_height;
+    int dy1 = ((sy + 1) * SCREEN_HEIGHT + scaler.vis_height - 1) / scaler.vis_height;
+    if (dy1 > SCREEN_HEIGHT) dy1 = SCREEN_HEIGHT;
+    if (dy0 >= dy1) return;
+
+    uint32_t *dst = &wallpaper_pixels[dy0 * SCREEN_WIDTH];
+    for (int x = 0; x < SCREEN_WIDTH; x++) {
+        dst[x] = to_framebuffer(pixels[scaler.x_map[x]]);
+    }
+    for (int dy = dy0 + 1; dy < dy1; dy++) {
+        memmove32(&wallpaper_pixels[dy * SCREEN_WIDTH], dst, SCREEN_WIDTH);
+    }
+}
+
+int wallpaper_load(image_read_fn read, void *read_ctx) {
+    image_sink_t sink = { scaler_begin, scaler_row, NULL };
+
+    wallpaper_valid = false;
+    int result = image_decode(read, read_ctx, &sink);
+    wallpaper_valid = (result == IMAGE_OK);
+    generation++;
+    return result;
+}
+
+int wallpaper_load_memory(const uint8_t *data, size_t size) {
+    image_memory_reader_t reader = { data, size, 0 };
+    return wallpaper_load(image_memory_read, &reader);
+}
+
+void wallpaper_clear(void) {
+    wallpaper_valid = false;
+    generation++;
+}
+
+const uint32_t *wallpaper_get_pixels(void) {
+    return wallpaper_valid ? wallpaper_pixels : NULL;
+}
+
+uint32_t wallpaper_generation(void) {
+    return generation;
+}
+
 void draw_wallpaper() {
-    clear_screen(0x001122);
-    // Future: Load image buffer for real wallpapers
+    if (!wallpaper_valid) {
+        const clip_rect_t *clip = get_clip_rect();
+        draw_filled_rect(clip->x0, clip->y0, clip->x1 - clip->x0, clip->y1 - clip->y0,
+                         WALLPAPER_DEFAULT_COLOR);
+        return;
+    }
+    // Already scaled and in framebuffer format: a straight copy
+    copy_from_buffer(wallpaper_pixels, get_clip_rect());
 }
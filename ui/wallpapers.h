@@ -1,6 +1,29 @@
 #ifndef WALLPAPERS_H
 #define WALLPAPERS_H
 
+#include <stdint.h>
+#include <stddef.h>
+#include "../drivers/image_decoder.h"
+
+// Shown when no wallpaper image is loaded; also the backdrop for transparent pixels
+#define WALLPAPER_DEFAULT_COLOR 0x001122
+
+// Copy the wallpaper into the active clip rect (flat default color if none)
 void draw_wallpaper();
 
+// Decode an image, scale it to cover the screen and convert it to the
+// framebuffer format once. Returns IMAGE_OK or an IMAGE_ERR_* code; on
+// failure the wallpaper falls back to the default color.
+int wallpaper_load(image_read_fn read, void *read_ctx);
+int wallpaper_load_memory(const uint8_t *data, size_t size);
+void wallpaper_clear(void);
+
+// Screen-sized pixels ready to copy, or NULL when no image is loaded. The
+// buffer is always the same one, so compare generations to notice a change.
+const uint32_t *wallpaper_get_pixels(void);
+
+// Goes up whenever the wallpaper changes: every load (even a failed one,
+// which may leave the buffer half written) and every clear
+uint32_t wallpaper_generation(void);
+
 #endif